@@ -5,13 +5,27 @@
 #ifndef LIBOPENRAZER_H
 #define LIBOPENRAZER_H
 
+#include "libopenrazer/batch.h"
 #include "libopenrazer/capability.h"
+#include "libopenrazer/customframe.h"
 #include "libopenrazer/dbusexception.h"
 #include "libopenrazer/device.h"
+#include "libopenrazer/devicedescriptor.h"
+#include "libopenrazer/devicesnapshot.h"
+#include "libopenrazer/effects.h"
+#include "libopenrazer/framestats.h"
+#include "libopenrazer/geometry.h"
+#include "libopenrazer/iothread.h"
+#include "libopenrazer/keyeventsource.h"
 #include "libopenrazer/led.h"
 #include "libopenrazer/manager.h"
 #include "libopenrazer/misc.h"
 #include "libopenrazer/openrazer.h"
+#include "libopenrazer/pollscheduler.h"
+#include "libopenrazer/reactiveengine.h"
+#include "libopenrazer/scrollingtext.h"
+#include "libopenrazer/systemmetrics.h"
+#include "libopenrazer/tickscheduler.h"
 
 #include <QTranslator>
 #include <QtGlobal>
@@ -0,0 +1,182 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+namespace libopenrazer {
+
+class Device;
+class Led;
+
+/*!
+ * \brief Operation of a Batch that failed.
+ */
+struct BatchFailure {
+    /*!
+     * Device the operation was applied to.
+     */
+    Device *device = nullptr;
+
+    /*!
+     * Led the operation was applied to, \c nullptr for operations on the device itself.
+     */
+    Led *led = nullptr;
+
+    /*!
+     * Name of the operation, as passed to Batch::add().
+     */
+    QString operation;
+
+    /*!
+     * \sa DBusException::name()
+     *
+     * \c org.freedesktop.DBus.Error.Failed if the operation failed with another QException.
+     */
+    QString errorName;
+
+    /*!
+     * \sa DBusException::message()
+     *
+     * QException::what() if the operation failed with another QException.
+     */
+    QString errorMessage;
+};
+
+/*!
+ * \brief Outcome of Batch::exec().
+ */
+struct BatchResult {
+    /*!
+     * Number of operations that succeeded.
+     */
+    int succeeded = 0;
+
+    /*!
+     * Operations that failed, in the order they were added to the Batch.
+     */
+    QList<BatchFailure> failures;
+
+    /*!
+     * Returns if all operations succeeded.
+     */
+    bool ok() const
+    {
+        return failures.isEmpty();
+    }
+};
+
+/*!
+ * \brief Applies many setters on several devices at once.
+ *
+ * The operations of different devices are sent concurrently, the operations of one device (including its LEDs) are run one after another in the order they were added. A failing operation doesn't stop the others, all failures are collected in the BatchResult instead.
+ *
+ * \code
+ * libopenrazer::Batch batch;
+ * for (libopenrazer::Device *device : devices) {
+ *     for (libopenrazer::Led *led : device->getLeds())
+ *         batch.setStatic(led, { 255, 0, 0 });
+ * }
+ * QFutureWatcher<libopenrazer::BatchResult> *watcher = ...;
+ * watcher->setFuture(batch.exec());
+ * \endcode
+ *
+ * The operations are chained through the event loop of the calling thread, which has to be running until the result is reported.
+ */
+class Batch
+{
+public:
+    /*!
+     * Adds the operation \a start on \a device. \a start has to begin the operation and return its future, usually by calling one of the \c Async setters.
+     *
+     * \a name is used to identify the operation in a BatchFailure.
+     */
+    void add(Device *device, const QString &name, const std::function<QFuture<void>()> &start);
+
+    /*!
+     * Same as above, for an operation on \a led. The operation is ordered with the other operations of the device of \a led.
+     */
+    void add(Led *led, const QString &name, const std::function<QFuture<void>()> &start);
+
+    /*!
+     * Adds Led::setOffAsync() on \a led.
+     */
+    void setOff(Led *led);
+
+    /*!
+     * Adds Led::setStaticAsync() on \a led.
+     */
+    void setStatic(Led *led, ::openrazer::RGB color);
+
+    /*!
+     * Adds Led::setSpectrumAsync() on \a led.
+     */
+    void setSpectrum(Led *led);
+
+    /*!
+     * Adds Led::setBrightnessAsync() on \a led.
+     */
+    void setBrightness(Led *led, uchar brightness);
+
+    /*!
+     * Adds Device::setDPIAsync() on \a device.
+     */
+    void setDPI(Device *device, ::openrazer::DPI dpi);
+
+    /*!
+     * Adds Device::setPollRateAsync() on \a device.
+     */
+    void setPollRate(Device *device, ushort pollRate);
+
+    /*!
+     * Returns the number of added operations.
+     */
+    int size() const;
+
+    /*!
+     * Removes all added operations.
+     */
+    void clear();
+
+    /*!
+     * Starts all added operations. The returned future finishes once every operation has finished.
+     *
+     * The Batch can be changed or destroyed afterwards, this doesn't affect the running operations. The devices and LEDs have to stay alive until the future has finished.
+     */
+    QFuture<BatchResult> exec() const;
+
+private:
+    struct Operation {
+        // Position in the order the operations were added
+        int index;
+        Device *device;
+        Led *led;
+        QString name;
+        std::function<QFuture<void>()> start;
+    };
+
+    void append(Device *device, Led *led, const QString &name, const std::function<QFuture<void>()> &start);
+
+    struct Run;
+    static void runNext(const QSharedPointer<Run> &run, int queue, int position);
+
+    QVector<QVector<Operation>> m_queues;
+    // Index of the queue of each device, queues are in the order the devices were first used
+    QHash<Device *, int> m_queueIndex;
+    int m_size = 0;
+};
+
+}
+
+#endif // BATCH_H
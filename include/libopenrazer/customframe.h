@@ -0,0 +1,88 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CUSTOMFRAME_H
+#define CUSTOMFRAME_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QVector>
+
+namespace libopenrazer {
+
+class Device;
+
+/*!
+ * \brief Shadow copy of the custom frame of a matrix device.
+ *
+ * Frame sources draw into the CustomFrame, which remembers which rows have changed. upload() then only sends the changed rows to the device.
+ */
+class CustomFrame
+{
+public:
+    /*!
+     * Creates a black frame with the given \a dimensions (as returned by Device::getMatrixDimensions()).
+     */
+    explicit CustomFrame(::openrazer::MatrixDimensions dimensions);
+
+    /*!
+     * Returns the number of rows.
+     */
+    uchar rows() const;
+
+    /*!
+     * Returns the number of columns.
+     */
+    uchar columns() const;
+
+    /*!
+     * Returns the color of the cell in \a row and \a column.
+     */
+    ::openrazer::RGB pixel(uchar row, uchar column) const;
+
+    /*!
+     * Sets the cell in \a row and \a column to \a color. The row is only marked as changed if the color differs.
+     */
+    void setPixel(uchar row, uchar column, ::openrazer::RGB color);
+
+    /*!
+     * Sets all cells to \a color.
+     */
+    void fill(::openrazer::RGB color);
+
+    /*!
+     * Returns if \a row has changed since the last upload().
+     */
+    bool isRowDirty(uchar row) const;
+
+    /*!
+     * Returns if any row has changed since the last upload().
+     */
+    bool isDirty() const;
+
+    /*!
+     * Marks all rows as changed, e.g. after another application changed the lighting.
+     */
+    void markDirty();
+
+    /*!
+     * Sends the changed rows to \a device and displays the frame.
+     *
+     * Returns the number of rows that were sent.
+     *
+     * \sa Device::defineCustomFrame(), Device::displayCustomFrame()
+     */
+    int upload(Device *device);
+
+private:
+    uchar m_rows;
+    uchar m_columns;
+    QVector<::openrazer::RGB> m_pixels;
+    QVector<bool> m_dirtyRows;
+    int m_dirtyCount;
+};
+
+}
+
+#endif // CUSTOMFRAME_H
@@ -5,9 +5,13 @@
 #ifndef DEVICE_H
 #define DEVICE_H
 
+#include "libopenrazer/devicedescriptor.h"
+#include "libopenrazer/devicesnapshot.h"
+#include "libopenrazer/framestats.h"
 #include "libopenrazer/openrazer.h"
 
-#include <QDBusInterface>
+#include <QDBusObjectPath>
+#include <QFuture>
 #include <QObject>
 
 namespace libopenrazer {
@@ -16,11 +20,33 @@ class Led;
 
 /*!
  * \brief Abstraction for accessing Device objects via D-Bus.
+ *
+ * Calls talking to the daemon also have an \c Async variant, which returns a QFuture instead of blocking until the reply has arrived. Errors are reported by the future as DBusException. The reply is delivered through the event loop of the calling thread. If the IoThread is enabled, replies to calls made outside of a running event loop are delivered on the I/O thread instead (see IoThread).
+ *
+ * The data a Device caches (its descriptor, see getDescriptor(), and its frameStats()) is guarded by locks, and the Manager hands out the same Device to all threads. Calls from different threads are not ordered against each other. \c Async calls from threads without an event loop need the IoThread.
  */
 class Device : public QObject
 {
     Q_OBJECT
 public:
+    /*!
+     * Features a device can have.
+     *
+     * \sa features(), featureName()
+     */
+    enum Feature {
+        KeyboardLayout = 0x001, ///< \c "keyboard_layout"
+        Dpi = 0x002, ///< \c "dpi"
+        RestrictedDpi = 0x004, ///< \c "restricted_dpi"
+        DpiStages = 0x008, ///< \c "dpi_stages"
+        PollRate = 0x010, ///< \c "poll_rate"
+        CustomFrame = 0x020, ///< \c "custom_frame"
+        Battery = 0x040, ///< \c "battery"
+        LowBatteryThreshold = 0x080, ///< \c "low_battery_threshold"
+        IdleTime = 0x100, ///< \c "idle_time"
+    };
+    Q_DECLARE_FLAGS(Features, Feature)
+
     /*!
      * Returns the DBus object path.
      */
@@ -28,9 +54,36 @@ public:
 
     /*!
      * Returns if the device has the specified \a featureStr
+     *
+     * \sa hasFeature(Feature)
      */
     virtual bool hasFeature(const QString &featureStr) = 0;
 
+    /*!
+     * Returns the features of the device. They are determined once when the device is set up, so this doesn't talk to the daemon.
+     */
+    virtual Features features() = 0;
+
+    /*!
+     * Returns if the device has the specified \a feature.
+     *
+     * Unlike hasFeature(const QString &) this doesn't need any string comparisons.
+     */
+    bool hasFeature(Feature feature)
+    {
+        return features().testFlag(feature);
+    }
+
+    /*!
+     * Returns the string of \a feature as used by hasFeature(const QString &), e.g. \c "dpi" for Dpi.
+     */
+    static const char *featureName(Feature feature);
+
+    /*!
+     * Returns the features named in \a featureStrs, unknown names are ignored.
+     */
+    static Features featuresFromNames(const QStringList &featureStrs);
+
     /*!
      * Returns the URL of an image that shows this device. Could return an empty string if no image was found.
      */
@@ -205,13 +258,164 @@ public:
      * \sa defineCustomFrame()
      */
     virtual ::openrazer::MatrixDimensions getMatrixDimensions() = 0;
+
+    /*!
+     * Returns the time accounting of the frames sent with defineCustomFrame() and displayCustomFrame().
+     */
+    virtual FrameStats *frameStats() = 0;
+
+    /*!
+     * Returns the information about the device that doesn't change while it is connected.
+     *
+     * Every field is cached by the Device on its own. This fetches all fields that aren't cached yet with concurrent calls, the matching getters (e.g. getSerial() or maxDPI()) fetch and cache only their own field. If one of the calls fails, the other fields are still cached and the error is thrown.
+     */
+    virtual DeviceDescriptor getDescriptor() = 0;
+
+    /*!
+     * Returns the current state of the device and all of its LEDs.
+     *
+     * All calls needed for it are sent to the daemon before waiting for the first reply, so this takes about one round trip instead of one per value.
+     *
+     * \sa Manager::snapshotAll()
+     */
+    virtual DeviceSnapshot snapshot() = 0;
+
+    /*!
+     * Asynchronous variant of getDeviceImageUrl().
+     */
+    virtual QFuture<QString> getDeviceImageUrlAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getDeviceMode().
+     */
+    virtual QFuture<QString> getDeviceModeAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getSerial().
+     */
+    virtual QFuture<QString> getSerialAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getDeviceName().
+     */
+    virtual QFuture<QString> getDeviceNameAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getDeviceType().
+     */
+    virtual QFuture<QString> getDeviceTypeAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getFirmwareVersion().
+     */
+    virtual QFuture<QString> getFirmwareVersionAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getKeyboardLayout().
+     */
+    virtual QFuture<QString> getKeyboardLayoutAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getPollRate().
+     */
+    virtual QFuture<ushort> getPollRateAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setPollRate().
+     */
+    virtual QFuture<void> setPollRateAsync(ushort pollrate) = 0;
+
+    /*!
+     * Asynchronous variant of getSupportedPollRates().
+     */
+    virtual QFuture<QVector<ushort>> getSupportedPollRatesAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setDPI().
+     */
+    virtual QFuture<void> setDPIAsync(::openrazer::DPI dpi) = 0;
+
+    /*!
+     * Asynchronous variant of getDPI().
+     */
+    virtual QFuture<::openrazer::DPI> getDPIAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setDPIStages().
+     */
+    virtual QFuture<void> setDPIStagesAsync(uchar activeStage, QVector<::openrazer::DPI> dpiStages) = 0;
+
+    /*!
+     * Asynchronous variant of getDPIStages().
+     */
+    virtual QFuture<QPair<uchar, QVector<::openrazer::DPI>>> getDPIStagesAsync() = 0;
+
+    /*!
+     * Asynchronous variant of maxDPI().
+     */
+    virtual QFuture<ushort> maxDPIAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getAllowedDPI().
+     */
+    virtual QFuture<QVector<ushort>> getAllowedDPIAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getBatteryPercent().
+     */
+    virtual QFuture<double> getBatteryPercentAsync() = 0;
+
+    /*!
+     * Asynchronous variant of isCharging().
+     */
+    virtual QFuture<bool> isChargingAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getIdleTime().
+     */
+    virtual QFuture<ushort> getIdleTimeAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setIdleTime().
+     */
+    virtual QFuture<void> setIdleTimeAsync(ushort idleTime) = 0;
+
+    /*!
+     * Asynchronous variant of getLowBatteryThreshold().
+     */
+    virtual QFuture<double> getLowBatteryThresholdAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setLowBatteryThreshold().
+     */
+    virtual QFuture<void> setLowBatteryThresholdAsync(double threshold) = 0;
+
+    /*!
+     * Asynchronous variant of displayCustomFrame().
+     */
+    virtual QFuture<void> displayCustomFrameAsync() = 0;
+
+    /*!
+     * Asynchronous variant of defineCustomFrame().
+     */
+    virtual QFuture<void> defineCustomFrameAsync(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData) = 0;
+
+    /*!
+     * Asynchronous variant of getMatrixDimensions().
+     */
+    virtual QFuture<::openrazer::MatrixDimensions> getMatrixDimensionsAsync() = 0;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Device::Features)
+
 namespace openrazer {
 
+class DeviceIntrospection;
 class DevicePrivate;
 class Led;
 class LedPrivate;
+class Manager;
+class ManagerPrivate;
 
 class Device : public ::libopenrazer::Device
 {
@@ -220,7 +424,9 @@ public:
     ~Device() override;
 
     QDBusObjectPath objectPath() override;
+    using ::libopenrazer::Device::hasFeature;
     bool hasFeature(const QString &featureStr) override;
+    Features features() override;
     QString getDeviceImageUrl() override;
     QList<::libopenrazer::Led *> getLeds() override;
     QString getDeviceMode() override;
@@ -247,12 +453,45 @@ public:
     void displayCustomFrame() override;
     void defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData) override;
     ::openrazer::MatrixDimensions getMatrixDimensions() override;
+    FrameStats *frameStats() override;
+    DeviceDescriptor getDescriptor() override;
+    DeviceSnapshot snapshot() override;
+    QFuture<QString> getDeviceImageUrlAsync() override;
+    QFuture<QString> getDeviceModeAsync() override;
+    QFuture<QString> getSerialAsync() override;
+    QFuture<QString> getDeviceNameAsync() override;
+    QFuture<QString> getDeviceTypeAsync() override;
+    QFuture<QString> getFirmwareVersionAsync() override;
+    QFuture<QString> getKeyboardLayoutAsync() override;
+    QFuture<ushort> getPollRateAsync() override;
+    QFuture<void> setPollRateAsync(ushort pollrate) override;
+    QFuture<QVector<ushort>> getSupportedPollRatesAsync() override;
+    QFuture<void> setDPIAsync(::openrazer::DPI dpi) override;
+    QFuture<::openrazer::DPI> getDPIAsync() override;
+    QFuture<void> setDPIStagesAsync(uchar activeStage, QVector<::openrazer::DPI> dpiStages) override;
+    QFuture<QPair<uchar, QVector<::openrazer::DPI>>> getDPIStagesAsync() override;
+    QFuture<ushort> maxDPIAsync() override;
+    QFuture<QVector<ushort>> getAllowedDPIAsync() override;
+    QFuture<double> getBatteryPercentAsync() override;
+    QFuture<bool> isChargingAsync() override;
+    QFuture<ushort> getIdleTimeAsync() override;
+    QFuture<void> setIdleTimeAsync(ushort idleTime) override;
+    QFuture<double> getLowBatteryThresholdAsync() override;
+    QFuture<void> setLowBatteryThresholdAsync(double threshold) override;
+    QFuture<void> displayCustomFrameAsync() override;
+    QFuture<void> defineCustomFrameAsync(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData) override;
+    QFuture<::openrazer::MatrixDimensions> getMatrixDimensionsAsync() override;
 
 private:
+    // Used by Manager with the already fetched or cached introspection data
+    Device(QDBusObjectPath objectPath, const DeviceIntrospection &introspection);
+
     DevicePrivate *d;
 
     friend class Led;
     friend class LedPrivate;
+    friend class Manager;
+    friend class ManagerPrivate;
 };
 
 }
@@ -260,8 +499,11 @@ private:
 namespace razer_test {
 
 class DevicePrivate;
+struct DeviceSetup;
 class Led;
 class LedPrivate;
+class Manager;
+class ManagerPrivate;
 
 class Device : public ::libopenrazer::Device
 {
@@ -270,7 +512,9 @@ public:
     ~Device() override;
 
     QDBusObjectPath objectPath() override;
+    using ::libopenrazer::Device::hasFeature;
     bool hasFeature(const QString &featureStr) override;
+    Features features() override;
     QString getDeviceImageUrl() override;
     QList<::libopenrazer::Led *> getLeds() override;
     QString getDeviceMode() override;
@@ -297,12 +541,45 @@ public:
     void displayCustomFrame() override;
     void defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData) override;
     ::openrazer::MatrixDimensions getMatrixDimensions() override;
+    FrameStats *frameStats() override;
+    DeviceDescriptor getDescriptor() override;
+    DeviceSnapshot snapshot() override;
+    QFuture<QString> getDeviceImageUrlAsync() override;
+    QFuture<QString> getDeviceModeAsync() override;
+    QFuture<QString> getSerialAsync() override;
+    QFuture<QString> getDeviceNameAsync() override;
+    QFuture<QString> getDeviceTypeAsync() override;
+    QFuture<QString> getFirmwareVersionAsync() override;
+    QFuture<QString> getKeyboardLayoutAsync() override;
+    QFuture<ushort> getPollRateAsync() override;
+    QFuture<void> setPollRateAsync(ushort pollrate) override;
+    QFuture<QVector<ushort>> getSupportedPollRatesAsync() override;
+    QFuture<void> setDPIAsync(::openrazer::DPI dpi) override;
+    QFuture<::openrazer::DPI> getDPIAsync() override;
+    QFuture<void> setDPIStagesAsync(uchar activeStage, QVector<::openrazer::DPI> dpiStages) override;
+    QFuture<QPair<uchar, QVector<::openrazer::DPI>>> getDPIStagesAsync() override;
+    QFuture<ushort> maxDPIAsync() override;
+    QFuture<QVector<ushort>> getAllowedDPIAsync() override;
+    QFuture<double> getBatteryPercentAsync() override;
+    QFuture<bool> isChargingAsync() override;
+    QFuture<ushort> getIdleTimeAsync() override;
+    QFuture<void> setIdleTimeAsync(ushort idleTime) override;
+    QFuture<double> getLowBatteryThresholdAsync() override;
+    QFuture<void> setLowBatteryThresholdAsync(double threshold) override;
+    QFuture<void> displayCustomFrameAsync() override;
+    QFuture<void> defineCustomFrameAsync(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData) override;
+    QFuture<::openrazer::MatrixDimensions> getMatrixDimensionsAsync() override;
 
 private:
+    // Used by the Manager with the already requested properties
+    Device(QDBusObjectPath objectPath, const DeviceSetup &setup);
+
     DevicePrivate *d;
 
     friend class Led;
     friend class LedPrivate;
+    friend class Manager;
+    friend class ManagerPrivate;
 };
 
 }
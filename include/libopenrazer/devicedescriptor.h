@@ -0,0 +1,76 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICEDESCRIPTOR_H
+#define DEVICEDESCRIPTOR_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QString>
+#include <QVector>
+
+namespace libopenrazer {
+
+/*!
+ * \brief Information about a device that doesn't change while it is connected.
+ *
+ * Fields of features the device doesn't have are left empty (or `0`).
+ *
+ * \sa Device::getDescriptor()
+ */
+struct DeviceDescriptor {
+    /*!
+     * \sa Device::getSerial()
+     */
+    QString serial;
+
+    /*!
+     * \sa Device::getDeviceName()
+     */
+    QString deviceName;
+
+    /*!
+     * \sa Device::getDeviceType()
+     */
+    QString deviceType;
+
+    /*!
+     * \sa Device::getFirmwareVersion()
+     */
+    QString firmwareVersion;
+
+    /*!
+     * \sa Device::getKeyboardLayout()
+     */
+    QString keyboardLayout;
+
+    /*!
+     * \sa Device::getDeviceImageUrl()
+     */
+    QString deviceImageUrl;
+
+    /*!
+     * \sa Device::getMatrixDimensions()
+     */
+    ::openrazer::MatrixDimensions matrixDimensions { 0, 0 };
+
+    /*!
+     * \sa Device::maxDPI()
+     */
+    ushort maxDPI = 0;
+
+    /*!
+     * \sa Device::getSupportedPollRates()
+     */
+    QVector<ushort> supportedPollRates;
+
+    /*!
+     * \sa Device::getAllowedDPI()
+     */
+    QVector<ushort> allowedDPI;
+};
+
+}
+
+#endif // DEVICEDESCRIPTOR_H
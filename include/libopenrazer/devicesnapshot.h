@@ -0,0 +1,102 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICESNAPSHOT_H
+#define DEVICESNAPSHOT_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QVector>
+
+namespace libopenrazer {
+
+/*!
+ * \brief Current state of a Led.
+ *
+ * \sa DeviceSnapshot
+ */
+struct LedSnapshot {
+    /*!
+     * \sa Led::getLedId()
+     */
+    ::openrazer::LedId ledId = ::openrazer::LedId::Unspecified;
+
+    /*!
+     * \sa Led::getCurrentEffect()
+     */
+    ::openrazer::Effect effect = ::openrazer::Effect::Off;
+
+    /*!
+     * \sa Led::getCurrentColors()
+     */
+    QVector<::openrazer::RGB> colors;
+
+    /*!
+     * \sa Led::getWaveDirection()
+     */
+    ::openrazer::WaveDirection waveDirection = ::openrazer::WaveDirection::LEFT_TO_RIGHT;
+
+    /*!
+     * Only set if Led::hasBrightness().
+     *
+     * \sa Led::getBrightness()
+     */
+    uchar brightness = 0;
+};
+
+/*!
+ * \brief Current state of a device and its LEDs, as returned by Device::snapshot().
+ *
+ * Fields of features the device doesn't have are left at their default values.
+ */
+struct DeviceSnapshot {
+    /*!
+     * \sa Device::getDPI()
+     */
+    ::openrazer::DPI dpi { 0, 0 };
+
+    /*!
+     * \sa Device::getDPIStages()
+     */
+    uchar activeDPIStage = 0;
+
+    /*!
+     * \sa Device::getDPIStages()
+     */
+    QVector<::openrazer::DPI> dpiStages;
+
+    /*!
+     * \sa Device::getPollRate()
+     */
+    ushort pollRate = 0;
+
+    /*!
+     * \sa Device::getBatteryPercent()
+     */
+    double batteryPercent = 0;
+
+    /*!
+     * \sa Device::isCharging()
+     */
+    bool charging = false;
+
+    /*!
+     * \sa Device::getIdleTime()
+     */
+    ushort idleTime = 0;
+
+    /*!
+     * \sa Device::getLowBatteryThreshold()
+     */
+    double lowBatteryThreshold = 0;
+
+    /*!
+     * The LEDs in the same order as Device::getLeds().
+     */
+    QVector<LedSnapshot> leds;
+};
+
+}
+
+#endif // DEVICESNAPSHOT_H
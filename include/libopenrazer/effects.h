@@ -0,0 +1,48 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include "libopenrazer/openrazer.h"
+
+namespace libopenrazer {
+
+/*!
+ * Returns if the effect kernels were built with fixed-point arithmetic (meson option \c fixed_point) instead of floating point.
+ */
+bool effectsUseFixedPoint();
+
+/*!
+ * Returns the intensity (`0` - `255`) of a breathing effect with a period of \a periodMs milliseconds at \a timeMs milliseconds.
+ */
+uchar breathingIntensity(uint timeMs, uint periodMs);
+
+/*!
+ * Converts the color with the \a hue (`0` - `359`), \a saturation (`0` - `255`) and \a value (`0` - `255`) to RGB.
+ *
+ * Rotating \a hue over time results in a spectrum effect.
+ */
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value);
+
+/*!
+ * Returns \a color with its brightness scaled by \a factor (`0` - `255`).
+ */
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor);
+
+/*!
+ * Returns the blend of \a a and \a b, where an \a alpha of `0` returns \a a and `255` returns \a b.
+ */
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha);
+
+/*!
+ * Blends the \a count colors in \a src over the colors in \a dst with the given \a alpha.
+ *
+ * \sa blendColors()
+ */
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha);
+
+}
+
+#endif // EFFECTS_H
@@ -0,0 +1,188 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <QMutex>
+#include <QtGlobal>
+#include <functional>
+
+namespace libopenrazer {
+
+/*!
+ * \brief Fixed-size histogram of durations.
+ *
+ * Durations are sorted into power-of-two buckets of microseconds, bucket \c i counts durations below bucketUpperBound() \c i. Recording never allocates.
+ */
+class Histogram
+{
+public:
+    /*!
+     * Number of buckets, the last bucket also counts everything above its bound.
+     */
+    static const int BucketCount = 24;
+
+    Histogram();
+
+    /*!
+     * Adds a duration of \a nsecs nanoseconds to the histogram.
+     */
+    void record(qint64 nsecs);
+
+    /*!
+     * Removes all recorded durations.
+     */
+    void reset();
+
+    /*!
+     * Returns the number of recorded durations.
+     */
+    quint64 count() const;
+
+    /*!
+     * Returns the sum of all recorded durations in nanoseconds.
+     */
+    qint64 total() const;
+
+    /*!
+     * Returns the longest recorded duration in nanoseconds.
+     */
+    qint64 max() const;
+
+    /*!
+     * Returns the number of durations recorded in bucket \a index.
+     */
+    quint64 bucket(int index) const;
+
+    /*!
+     * Returns the (exclusive) upper bound of bucket \a index in nanoseconds.
+     */
+    static qint64 bucketUpperBound(int index);
+
+private:
+    quint64 m_buckets[BucketCount];
+    quint64 m_count;
+    qint64 m_total;
+    qint64 m_max;
+};
+
+/*!
+ * \brief Per-stage CPU budget accounting for custom frame animations.
+ *
+ * Every Device keeps one FrameStats object. It can be recorded to and read from several threads at the same time. The library records the \c Pack, \c Marshal and \c DBusWait stages in Device::defineCustomFrame() and Device::displayCustomFrame() (and their async variants), the application can record its own \c Render and \c Composite stages with ScopedStage. Device::displayCustomFrame() ends a frame, Device::displayCustomFrameAsync() ends it once the reply of the daemon has arrived; a frame that took longer than budget() counts as an overrun.
+ *
+ * \sa Device::frameStats()
+ */
+class FrameStats
+{
+public:
+    /*!
+     * The stages of a frame.
+     */
+    enum Stage {
+        /** Rendering the effect (application). */
+        Render,
+        /** Compositing layers into the final frame (application). */
+        Composite,
+        /** Packing the colors into the format the daemon expects. */
+        Pack,
+        /** Building and marshalling the D-Bus message until it has been handed to the connection. With the IoThread enabled, this includes the time the call waits to be sent on the I/O thread. */
+        Marshal,
+        /** Waiting for the reply of the daemon once the message has been sent. */
+        DBusWait,
+    };
+    static const int StageCount = DBusWait + 1;
+
+    /*!
+     * \brief Records the time from its construction to its destruction as a stage.
+     */
+    class ScopedStage
+    {
+    public:
+        ScopedStage(FrameStats *stats, Stage stage);
+        ~ScopedStage();
+
+    private:
+        FrameStats *m_stats;
+        Stage m_stage;
+        qint64 m_start;
+    };
+
+    FrameStats();
+
+    /*!
+     * Copies the histograms, counters, budget and overrun callback of \a other. It is read under its lock, so it can be copied while another thread records to it.
+     */
+    FrameStats(const FrameStats &other);
+
+    /*!
+     * Replaces the histograms, counters, budget and overrun callback with the ones of \a other, see FrameStats(const FrameStats &).
+     */
+    FrameStats &operator=(const FrameStats &other);
+
+    /*!
+     * Returns the current time of the monotonic clock in nanoseconds.
+     */
+    static qint64 now();
+
+    /*!
+     * Records that \a stage ran from \a start to \a end (timestamps from now()).
+     */
+    void record(Stage stage, qint64 start, qint64 end);
+
+    /*!
+     * Ends the current frame. Called by Device::displayCustomFrame() and on the reply of Device::displayCustomFrameAsync().
+     */
+    void endFrame();
+
+    /*!
+     * Returns a copy of the histogram of the durations of \a stage.
+     */
+    Histogram stage(Stage stage) const;
+
+    /*!
+     * Returns a copy of the histogram of the durations of whole frames, from the start of the first stage until endFrame().
+     */
+    Histogram frames() const;
+
+    /*!
+     * Sets the time budget of a frame to \a nsecs nanoseconds. `0` disables overrun detection.
+     */
+    void setBudget(qint64 nsecs);
+
+    /*!
+     * Returns the time budget of a frame in nanoseconds.
+     */
+    qint64 budget() const;
+
+    /*!
+     * Returns the number of frames that took longer than budget().
+     */
+    quint64 overruns() const;
+
+    /*!
+     * Sets a \a callback that gets called with the duration of every frame that took longer than budget(). It is called in the thread that ended the frame, for Device::displayCustomFrameAsync() that's the thread the reply is delivered to.
+     */
+    void setOverrunCallback(const std::function<void(qint64)> &callback);
+
+    /*!
+     * Clears all histograms and counters.
+     */
+    void reset();
+
+private:
+    mutable QMutex m_mutex;
+    Histogram m_stages[StageCount];
+    Histogram m_frames;
+    qint64 m_frameStart;
+    bool m_inFrame;
+    qint64 m_budget;
+    quint64 m_overruns;
+    std::function<void(qint64)> m_overrunCallback;
+};
+
+}
+
+#endif // FRAMESTATS_H
@@ -0,0 +1,96 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "libopenrazer/openrazer.h"
+
+namespace libopenrazer {
+
+/*!
+ * \brief Physical position of a single LED.
+ *
+ * Coordinates are in tenths of a millimetre, measured from the top left corner of the device (as seen from above).
+ */
+struct LedPosition {
+    ushort x;
+    ushort y;
+
+    /*!
+     * Returns if there is an LED at this position. Matrix cells without a physical LED are marked with `0xFFFF`.
+     */
+    constexpr bool isValid() const
+    {
+        return x != 0xFFFF && y != 0xFFFF;
+    }
+};
+
+/*!
+ * \brief Physical position of a zone LED (e.g. the logo or the scroll wheel).
+ */
+struct ZoneGeometry {
+    ::openrazer::LedId ledId;
+    LedPosition position;
+};
+
+/*!
+ * \brief Static description of the physical LED layout of a device model.
+ *
+ * The tables are compiled into the library, so looking up a position is a plain array access.
+ *
+ * \sa findDeviceGeometry()
+ */
+struct DeviceGeometry {
+    /*!
+     * Size of the matrix described by \c matrix, matching Device::getMatrixDimensions().
+     */
+    ::openrazer::MatrixDimensions dimensions;
+
+    /*!
+     * Size of the device in tenths of a millimetre.
+     */
+    ushort width;
+    ushort height;
+
+    /*!
+     * Row-major array of `dimensions.x * dimensions.y` positions, or \c nullptr if the device has no matrix.
+     */
+    const LedPosition *matrix;
+
+    /*!
+     * Row-major array of the Linux input event codes (e.g. \c KEY_ESC) of the keys in the matrix, `0` for cells without a key. \c nullptr if the device has no keys.
+     */
+    const ushort *keyCodes;
+
+    /*!
+     * Array of \c zoneCount zone LED positions.
+     */
+    const ZoneGeometry *zones;
+    uchar zoneCount;
+
+    /*!
+     * Returns the position of the matrix cell in \a row and \a column, or an invalid position if the device has no matrix or the cell is outside of it.
+     */
+    constexpr LedPosition cellPosition(uchar row, uchar column) const
+    {
+        return matrix != nullptr && row < dimensions.x && column < dimensions.y
+                ? matrix[row * dimensions.y + column]
+                : LedPosition { 0xFFFF, 0xFFFF };
+    }
+
+    /*!
+     * Returns the position of the zone LED \a ledId, or an invalid position if the device has no such LED.
+     */
+    LedPosition zonePosition(::openrazer::LedId ledId) const;
+};
+
+/*!
+ * Returns the physical LED layout of the device model with the name \a deviceName (as returned by Device::getDeviceName()), or \c nullptr if the model is not known.
+ */
+const DeviceGeometry *findDeviceGeometry(const QString &deviceName);
+
+}
+
+#endif // GEOMETRY_H
@@ -0,0 +1,45 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IOTHREAD_H
+#define IOTHREAD_H
+
+namespace libopenrazer {
+
+/*!
+ * \brief Opt-in thread handling the D-Bus traffic of libopenrazer.
+ *
+ * By default libopenrazer talks to the daemons over the shared session (or system) bus connection of the application, and the replies of the \c Async calls are processed in the event loop of the calling thread.
+ *
+ * After enable(), libopenrazer uses its own private bus connections, and the calls of all \c Async methods are sent and waited for on a dedicated thread. Heavy lighting traffic then doesn't block the calling thread with sending the messages. Once a reply has arrived, it is handed back to the event loop of the thread that made the call, so the state libopenrazer keeps for a Device or Led is only updated there. Replies to calls made outside of a running event loop, e.g. from QThreadPool or QtConcurrent workers or before QCoreApplication::exec(), are handled on the I/O thread, so waiting for them doesn't block.
+ *
+ * The messages of \c Async calls are queued for the I/O thread, so a blocking call made right after an \c Async one can reach the daemon first.
+ *
+ * \code
+ * int main(int argc, char *argv[])
+ * {
+ *     QApplication app(argc, argv);
+ *     libopenrazer::IoThread::enable();
+ *     libopenrazer::Manager *manager = new libopenrazer::openrazer::Manager();
+ *     ...
+ * }
+ * \endcode
+ */
+class IoThread
+{
+public:
+    /*!
+     * Starts the thread and switches to private bus connections. Has to be called once before the first Manager is created, it can't be disabled afterwards. The bus connections are chosen when libopenrazer first talks to a daemon and never change afterwards, so enabling it later keeps the shared connection of the application.
+     */
+    static void enable();
+
+    /*!
+     * Returns if enable() has been called.
+     */
+    static bool isEnabled();
+};
+
+}
+
+#endif // IOTHREAD_H
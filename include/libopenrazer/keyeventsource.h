@@ -0,0 +1,80 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYEVENTSOURCE_H
+#define KEYEVENTSOURCE_H
+
+#include <QObject>
+
+class QSocketNotifier;
+
+namespace libopenrazer {
+
+/*!
+ * \brief Source of key press events for software lighting effects.
+ *
+ * Key codes are Linux input event codes (e.g. \c KEY_ESC), timestamps are on the clock of FrameStats::now().
+ *
+ * \sa EvdevKeyEventSource, FakeKeyEventSource, ReactiveEngine
+ */
+class KeyEventSource : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KeyEventSource(QObject *parent = nullptr);
+
+signals:
+    /*!
+     * Emitted when the key with the given \a code was pressed at \a timestamp.
+     */
+    void keyPressed(ushort code, qint64 timestamp);
+};
+
+/*!
+ * \brief Reads key presses from a Linux evdev device like `/dev/input/event3`.
+ *
+ * The device is read without grabbing it, so other applications still get the events. Only available on Linux.
+ */
+class EvdevKeyEventSource : public KeyEventSource
+{
+    Q_OBJECT
+public:
+    explicit EvdevKeyEventSource(const QString &devicePath, QObject *parent = nullptr);
+    ~EvdevKeyEventSource() override;
+
+    /*!
+     * Returns if the device could be opened.
+     */
+    bool isOpen() const;
+
+private slots:
+    void readEvents();
+
+private:
+    int m_fd = -1;
+    // The kernel couldn't switch the device to CLOCK_MONOTONIC, e.g. before Linux 3.4
+    bool m_realtimeClock = false;
+    QSocketNotifier *m_notifier = nullptr;
+};
+
+/*!
+ * \brief Key event source that only emits the events passed to press().
+ *
+ * Useful for testing and for feeding events from other sources (e.g. a compositor).
+ */
+class FakeKeyEventSource : public KeyEventSource
+{
+    Q_OBJECT
+public:
+    explicit FakeKeyEventSource(QObject *parent = nullptr);
+
+    /*!
+     * Emits keyPressed() for the key with the given \a code at \a timestamp (or now if it's `0`).
+     */
+    void press(ushort code, qint64 timestamp = 0);
+};
+
+}
+
+#endif // KEYEVENTSOURCE_H
@@ -7,12 +7,19 @@
 
 #include "libopenrazer/openrazer.h"
 
-#include <QDBusInterface>
+#include <QDBusObjectPath>
+#include <QFuture>
 
 namespace libopenrazer {
 
+class Device;
+
 /*!
  * \brief Abstraction for accessing Led objects via D-Bus.
+ *
+ * Calls talking to the daemon also have an \c Async variant, which returns a QFuture instead of blocking until the reply has arrived. Errors are reported by the future as DBusException. The reply is delivered through the event loop of the calling thread. If the IoThread is enabled, replies to calls made outside of a running event loop are delivered on the I/O thread instead (see IoThread).
+ *
+ * The last known state of the Led is cached and guarded by a lock, so it can be read while another thread writes an effect. Calls from different threads are not ordered against each other. \c Async calls from threads without an event loop need the IoThread.
  */
 class Led : public QObject
 {
@@ -23,6 +30,11 @@ public:
      */
     virtual QDBusObjectPath getObjectPath() = 0;
 
+    /*!
+     * Returns the Device this Led belongs to
+     */
+    virtual Device *getDevice() = 0;
+
     /*!
      * Returns if the device has brightness functionality
      */
@@ -132,11 +144,152 @@ public:
      * Returns the current brightness (`0` - `255`).
      */
     virtual uchar getBrightness() = 0;
+
+    /*!
+     * Asynchronous variant of getCurrentEffect().
+     */
+    virtual QFuture<::openrazer::Effect> getCurrentEffectAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getCurrentColors().
+     */
+    virtual QFuture<QVector<::openrazer::RGB>> getCurrentColorsAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getWaveDirection().
+     */
+    virtual QFuture<::openrazer::WaveDirection> getWaveDirectionAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getLedId().
+     */
+    virtual QFuture<::openrazer::LedId> getLedIdAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setOff().
+     */
+    virtual QFuture<void> setOffAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setOn().
+     */
+    virtual QFuture<void> setOnAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setStatic().
+     */
+    virtual QFuture<void> setStaticAsync(::openrazer::RGB color) = 0;
+
+    /*!
+     * Asynchronous variant of setBreathing().
+     */
+    virtual QFuture<void> setBreathingAsync(::openrazer::RGB color) = 0;
+
+    /*!
+     * Asynchronous variant of setBreathingDual().
+     */
+    virtual QFuture<void> setBreathingDualAsync(::openrazer::RGB color, ::openrazer::RGB color2) = 0;
+
+    /*!
+     * Asynchronous variant of setBreathingRandom().
+     */
+    virtual QFuture<void> setBreathingRandomAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setBreathingMono().
+     */
+    virtual QFuture<void> setBreathingMonoAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setBlinking().
+     */
+    virtual QFuture<void> setBlinkingAsync(::openrazer::RGB color) = 0;
+
+    /*!
+     * Asynchronous variant of setSpectrum().
+     */
+    virtual QFuture<void> setSpectrumAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setWave().
+     */
+    virtual QFuture<void> setWaveAsync(::openrazer::WaveDirection direction) = 0;
+
+    /*!
+     * Asynchronous variant of setWheel().
+     */
+    virtual QFuture<void> setWheelAsync(::openrazer::WheelDirection direction) = 0;
+
+    /*!
+     * Asynchronous variant of setReactive().
+     */
+    virtual QFuture<void> setReactiveAsync(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed) = 0;
+
+    /*!
+     * Asynchronous variant of setRipple().
+     */
+    virtual QFuture<void> setRippleAsync(::openrazer::RGB color) = 0;
+
+    /*!
+     * Asynchronous variant of setRippleRandom().
+     */
+    virtual QFuture<void> setRippleRandomAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setBrightness().
+     */
+    virtual QFuture<void> setBrightnessAsync(uchar brightness) = 0;
+
+    /*!
+     * Asynchronous variant of getBrightness().
+     */
+    virtual QFuture<uchar> getBrightnessAsync() = 0;
+
+    /*!
+     * Enables or disables the state cache. Enabled by default.
+     *
+     * The Led remembers the effect, colors, wave direction and brightness it has successfully written or read. getCurrentEffect(), getCurrentColors(), getWaveDirection() and getBrightness() (and their \c Async variants) are answered from the cache while it is fresh, and setters that would write the state the LED already has are skipped without talking to the daemon. getCurrentColors() is only answered from a write if the effect uses all colors the daemon reports, otherwise they are read from the daemon once.
+     *
+     * Other applications can change the LED without the library noticing, so cached values are only used for a minute. Disable the cache if the LED is also controlled elsewhere and every write has to reach the device.
+     *
+     * \sa suppressedWrites()
+     */
+    virtual void setStateCacheEnabled(bool enabled) = 0;
+
+    /*!
+     * Returns if the state cache is enabled.
+     *
+     * \sa setStateCacheEnabled()
+     */
+    virtual bool isStateCacheEnabled() = 0;
+
+    /*!
+     * Returns the number of writes that were skipped because the LED already had the state.
+     *
+     * \sa setStateCacheEnabled()
+     */
+    virtual quint64 suppressedWrites() = 0;
+
+signals:
+    /*!
+     * Emitted when the daemon reports that the active \a effect has changed, also if it was changed by another application.
+     *
+     * Only the razer_test backend gets notified about changes, the openrazer daemon doesn't send them. razer_test only reports the changes its D-Bus adaptor emits \c PropertiesChanged for, which QtDBus doesn't do on its own, so some changes never arrive here. Values the state cache got from these notifications therefore expire after a minute like all cached values (see setStateCacheEnabled()), getCurrentEffect() then asks the daemon again.
+     */
+    void currentEffectChanged(::openrazer::Effect effect);
+
+    /*!
+     * Emitted when the daemon reports that the active \a colors have changed.
+     *
+     * \sa currentEffectChanged()
+     */
+    void currentColorsChanged(QVector<::openrazer::RGB> colors);
 };
 
 namespace openrazer {
 
 class Device;
+class DevicePrivate;
 class LedPrivate;
 class Led : public ::libopenrazer::Led
 {
@@ -145,6 +298,7 @@ public:
     ~Led() override;
 
     QDBusObjectPath getObjectPath() override;
+    ::libopenrazer::Device *getDevice() override;
     bool hasBrightness() override;
     bool hasFx(::openrazer::Effect fx) override;
     ::openrazer::Effect getCurrentEffect() override;
@@ -167,9 +321,34 @@ public:
     void setRippleRandom() override;
     void setBrightness(uchar brightness) override;
     uchar getBrightness() override;
+    QFuture<::openrazer::Effect> getCurrentEffectAsync() override;
+    QFuture<QVector<::openrazer::RGB>> getCurrentColorsAsync() override;
+    QFuture<::openrazer::WaveDirection> getWaveDirectionAsync() override;
+    QFuture<::openrazer::LedId> getLedIdAsync() override;
+    QFuture<void> setOffAsync() override;
+    QFuture<void> setOnAsync() override;
+    QFuture<void> setStaticAsync(::openrazer::RGB color) override;
+    QFuture<void> setBreathingAsync(::openrazer::RGB color) override;
+    QFuture<void> setBreathingDualAsync(::openrazer::RGB color, ::openrazer::RGB color2) override;
+    QFuture<void> setBreathingRandomAsync() override;
+    QFuture<void> setBreathingMonoAsync() override;
+    QFuture<void> setBlinkingAsync(::openrazer::RGB color) override;
+    QFuture<void> setSpectrumAsync() override;
+    QFuture<void> setWaveAsync(::openrazer::WaveDirection direction) override;
+    QFuture<void> setWheelAsync(::openrazer::WheelDirection direction) override;
+    QFuture<void> setReactiveAsync(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed) override;
+    QFuture<void> setRippleAsync(::openrazer::RGB color) override;
+    QFuture<void> setRippleRandomAsync() override;
+    QFuture<void> setBrightnessAsync(uchar brightness) override;
+    QFuture<uchar> getBrightnessAsync() override;
+    void setStateCacheEnabled(bool enabled) override;
+    bool isStateCacheEnabled() override;
+    quint64 suppressedWrites() override;
 
 private:
     LedPrivate *d;
+
+    friend class DevicePrivate;
 };
 
 }
@@ -177,6 +356,7 @@ private:
 namespace razer_test {
 
 class Device;
+class DevicePrivate;
 class LedPrivate;
 class Led : public ::libopenrazer::Led
 {
@@ -185,6 +365,7 @@ public:
     ~Led() override;
 
     QDBusObjectPath getObjectPath() override;
+    ::libopenrazer::Device *getDevice() override;
     bool hasBrightness() override;
     bool hasFx(::openrazer::Effect fx) override;
     ::openrazer::Effect getCurrentEffect() override;
@@ -207,9 +388,35 @@ public:
     void setRippleRandom() override;
     void setBrightness(uchar brightness) override;
     uchar getBrightness() override;
+    QFuture<::openrazer::Effect> getCurrentEffectAsync() override;
+    QFuture<QVector<::openrazer::RGB>> getCurrentColorsAsync() override;
+    QFuture<::openrazer::WaveDirection> getWaveDirectionAsync() override;
+    QFuture<::openrazer::LedId> getLedIdAsync() override;
+    QFuture<void> setOffAsync() override;
+    QFuture<void> setOnAsync() override;
+    QFuture<void> setStaticAsync(::openrazer::RGB color) override;
+    QFuture<void> setBreathingAsync(::openrazer::RGB color) override;
+    QFuture<void> setBreathingDualAsync(::openrazer::RGB color, ::openrazer::RGB color2) override;
+    QFuture<void> setBreathingRandomAsync() override;
+    QFuture<void> setBreathingMonoAsync() override;
+    QFuture<void> setBlinkingAsync(::openrazer::RGB color) override;
+    QFuture<void> setSpectrumAsync() override;
+    QFuture<void> setWaveAsync(::openrazer::WaveDirection direction) override;
+    QFuture<void> setWheelAsync(::openrazer::WheelDirection direction) override;
+    QFuture<void> setReactiveAsync(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed) override;
+    QFuture<void> setRippleAsync(::openrazer::RGB color) override;
+    QFuture<void> setRippleRandomAsync() override;
+    QFuture<void> setBrightnessAsync(uchar brightness) override;
+    QFuture<uchar> getBrightnessAsync() override;
+    void setStateCacheEnabled(bool enabled) override;
+    bool isStateCacheEnabled() override;
+    quint64 suppressedWrites() override;
 
 private:
     LedPrivate *d;
+
+    friend class Device;
+    friend class DevicePrivate;
 };
 
 }
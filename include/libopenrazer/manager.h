@@ -5,10 +5,14 @@
 #ifndef MANAGER_H
 #define MANAGER_H
 
+#include "libopenrazer/device.h"
+#include "libopenrazer/devicesnapshot.h"
 #include "libopenrazer/misc.h"
 
-#include <QDBusInterface>
+#include <QDBusObjectPath>
 #include <QDBusServiceWatcher>
+#include <QFuture>
+#include <QSharedPointer>
 
 namespace libopenrazer {
 
@@ -16,6 +20,8 @@ class Device;
 
 /*!
  * \brief Abstraction for accessing Manager objects via D-Bus.
+ *
+ * Calls talking to the daemon also have an \c Async variant, which returns a QFuture instead of blocking until the reply has arrived. Errors are reported by the future as DBusException. The reply is delivered through the event loop of the calling thread. If the IoThread is enabled, replies to calls made outside of a running event loop are delivered on the I/O thread instead (see IoThread).
  */
 class Manager : public QObject
 {
@@ -29,9 +35,25 @@ public:
     virtual QList<QDBusObjectPath> getDevices() = 0;
 
     /*!
-     * Returns a Device object with the given DBus object path.
+     * Returns the Device object with the given DBus object path.
+     *
+     * Device objects are shared: the Manager keeps every Device it has handed out, so later calls for the same path return the same object without talking to the daemon. The Manager drops its reference once the daemon reports the device as removed or stops.
+     */
+    virtual QSharedPointer<Device> getDevice(QDBusObjectPath objectPath) = 0;
+
+    /*!
+     * Returns Device objects for all connected devices. Like getDevice(), they are shared.
+     *
+     * Unlike calling getDevice() for every path from getDevices(), the data needed to set up the devices and their metadata (see Device::getDescriptor()) are requested for all devices at once, so this takes about as long as a single device.
      */
-    virtual Device *getDevice(QDBusObjectPath objectPath) = 0;
+    virtual QList<QSharedPointer<Device>> getAllDevices() = 0;
+
+    /*!
+     * Returns the snapshots of all \a devices, in the same order.
+     *
+     * Same as calling Device::snapshot() for every device, but the calls of all devices are sent before waiting for the first reply. The \a devices have to be created by this Manager.
+     */
+    virtual QVector<DeviceSnapshot> snapshotAll(const QList<QSharedPointer<Device>> &devices) = 0;
 
     /*!
      * Returns the daemon version currently running (e.g. `2.3.0`).
@@ -108,6 +130,8 @@ public:
      *
      * Returns if the connection was successful.
      *
+     * The signals of the daemon carry no details about the device, deviceAdded() and deviceRemoved() are usually more useful.
+     *
      * \sa connectDeviceRemoved()
      */
     virtual bool connectDevicesChanged(QObject *receiver, const char *slot) = 0;
@@ -118,6 +142,59 @@ public:
      * The \c serviceRegistered and \c serviceUnregistered signals are probably the most interesting ones.
      */
     virtual QDBusServiceWatcher *getServiceWatcher() = 0;
+
+    /*!
+     * Asynchronous variant of getDevices().
+     */
+    virtual QFuture<QList<QDBusObjectPath>> getDevicesAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getDaemonVersion().
+     */
+    virtual QFuture<QString> getDaemonVersionAsync() = 0;
+
+    /*!
+     * Asynchronous variant of isDaemonRunning().
+     */
+    virtual QFuture<bool> isDaemonRunningAsync() = 0;
+
+    /*!
+     * Asynchronous variant of getSupportedDevices().
+     */
+    virtual QFuture<QVariantHash> getSupportedDevicesAsync() = 0;
+
+    /*!
+     * Asynchronous variant of syncEffects().
+     */
+    virtual QFuture<void> syncEffectsAsync(bool yes) = 0;
+
+    /*!
+     * Asynchronous variant of getSyncEffects().
+     */
+    virtual QFuture<bool> getSyncEffectsAsync() = 0;
+
+    /*!
+     * Asynchronous variant of setTurnOffOnScreensaver().
+     */
+    virtual QFuture<void> setTurnOffOnScreensaverAsync(bool turnOffOnScreensaver) = 0;
+
+    /*!
+     * Asynchronous variant of getTurnOffOnScreensaver().
+     */
+    virtual QFuture<bool> getTurnOffOnScreensaverAsync() = 0;
+
+signals:
+    /*!
+     * Emitted when a \a device has been connected. The device is set up in the background before this is emitted, only the new device talks to the daemon. It is shared like the devices from getDevice().
+     *
+     * The Manager starts tracking the connected devices when it is created, devices that are already connected then aren't reported.
+     */
+    void deviceAdded(QSharedPointer<::libopenrazer::Device> device);
+
+    /*!
+     * Emitted when the device at \a objectPath has been disconnected, or the daemon has stopped.
+     */
+    void deviceRemoved(QDBusObjectPath objectPath);
 };
 
 namespace openrazer {
@@ -128,7 +205,9 @@ class Manager : public ::libopenrazer::Manager
 public:
     Manager();
     QList<QDBusObjectPath> getDevices() override;
-    Device *getDevice(QDBusObjectPath objectPath) override;
+    QSharedPointer<::libopenrazer::Device> getDevice(QDBusObjectPath objectPath) override;
+    QList<QSharedPointer<::libopenrazer::Device>> getAllDevices() override;
+    QVector<DeviceSnapshot> snapshotAll(const QList<QSharedPointer<::libopenrazer::Device>> &devices) override;
     QString getDaemonVersion() override;
     bool isDaemonRunning() override;
     QVariantHash getSupportedDevices() override;
@@ -141,6 +220,14 @@ public:
     bool enableDaemon() override;
     bool connectDevicesChanged(QObject *receiver, const char *slot) override;
     QDBusServiceWatcher *getServiceWatcher() override;
+    QFuture<QList<QDBusObjectPath>> getDevicesAsync() override;
+    QFuture<QString> getDaemonVersionAsync() override;
+    QFuture<bool> isDaemonRunningAsync() override;
+    QFuture<QVariantHash> getSupportedDevicesAsync() override;
+    QFuture<void> syncEffectsAsync(bool yes) override;
+    QFuture<bool> getSyncEffectsAsync() override;
+    QFuture<void> setTurnOffOnScreensaverAsync(bool turnOffOnScreensaver) override;
+    QFuture<bool> getTurnOffOnScreensaverAsync() override;
 
 private:
     ManagerPrivate *d;
@@ -156,7 +243,9 @@ class Manager : public ::libopenrazer::Manager
 public:
     Manager();
     QList<QDBusObjectPath> getDevices() override;
-    Device *getDevice(QDBusObjectPath objectPath) override;
+    QSharedPointer<::libopenrazer::Device> getDevice(QDBusObjectPath objectPath) override;
+    QList<QSharedPointer<::libopenrazer::Device>> getAllDevices() override;
+    QVector<DeviceSnapshot> snapshotAll(const QList<QSharedPointer<::libopenrazer::Device>> &devices) override;
     QString getDaemonVersion() override;
     bool isDaemonRunning() override;
     QVariantHash getSupportedDevices() override;
@@ -169,6 +258,14 @@ public:
     bool enableDaemon() override;
     bool connectDevicesChanged(QObject *receiver, const char *slot) override;
     QDBusServiceWatcher *getServiceWatcher() override;
+    QFuture<QList<QDBusObjectPath>> getDevicesAsync() override;
+    QFuture<QString> getDaemonVersionAsync() override;
+    QFuture<bool> isDaemonRunningAsync() override;
+    QFuture<QVariantHash> getSupportedDevicesAsync() override;
+    QFuture<void> syncEffectsAsync(bool yes) override;
+    QFuture<bool> getSyncEffectsAsync() override;
+    QFuture<void> setTurnOffOnScreensaverAsync(bool turnOffOnScreensaver) override;
+    QFuture<bool> getTurnOffOnScreensaverAsync() override;
 
 private:
     ManagerPrivate *d;
@@ -259,6 +259,16 @@ inline const QDBusArgument &operator>>(const QDBusArgument &argument, RGB &value
     return argument;
 }
 
+inline bool operator==(const RGB &a, const RGB &b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+inline bool operator!=(const RGB &a, const RGB &b)
+{
+    return !(a == b);
+}
+
 inline QDebug operator<<(QDebug dbg, const RGB &value)
 {
     dbg.nospace() << "RGB(" << value.r << ", " << value.g << ", " << value.b << ")";
@@ -0,0 +1,113 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+namespace libopenrazer {
+
+class Device;
+
+/*!
+ * \brief Polls the battery state of many devices with as few D-Bus calls as possible.
+ *
+ * The daemons don't notify about battery changes, so the values have to be polled. Instead of one timer per device, all devices share the scheduler: polls that are due at about the same time (see setBatchWindow()) are sent together as concurrent async calls.
+ *
+ * The interval of every device adapts to how much its values change. While the device is charging or its battery is near the low battery threshold, it is polled at minimumInterval(). Otherwise a poll with changed values halves the interval and a poll without changes doubles it, up to maximumInterval().
+ *
+ * The signals are only emitted when a value has changed, the first poll of a device always reports its values.
+ *
+ * \code
+ * auto *scheduler = new libopenrazer::PollScheduler(this);
+ * connect(scheduler, &libopenrazer::PollScheduler::batteryPercentChanged, this, &Monitor::updateBattery);
+ * for (const QSharedPointer<libopenrazer::Device> &device : manager->getAllDevices())
+ *     scheduler->addDevice(device.data());
+ * \endcode
+ *
+ * The scheduler needs a running event loop in its thread.
+ */
+class PollScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PollScheduler(QObject *parent = nullptr);
+
+    /*!
+     * Starts polling \a device, until removeDevice() is called or the device is destroyed. Devices without the Device::Battery feature are ignored.
+     *
+     * The low battery threshold is read once with the first poll if the device has the Device::LowBatteryThreshold feature, otherwise 20 % is used.
+     */
+    void addDevice(Device *device);
+
+    /*!
+     * Stops polling \a device. Calls that are already sent are ignored.
+     */
+    void removeDevice(Device *device);
+
+    /*!
+     * Sets the shortest and the longest interval between two polls of a device in milliseconds. Defaults to 10 seconds and 5 minutes.
+     */
+    void setIntervals(int minimum, int maximum);
+    int minimumInterval() const;
+    int maximumInterval() const;
+
+    /*!
+     * Polls that are due within \a msec milliseconds are sent together with the poll that is due now. Defaults to 2 seconds.
+     */
+    void setBatchWindow(int msec);
+    int batchWindow() const;
+
+    /*!
+     * Returns the current polling interval of \a device in milliseconds, or \c 0 if it isn't polled.
+     */
+    int interval(Device *device) const;
+
+signals:
+    /*!
+     * Emitted when the battery of \a device is charged to \a percent, which differs from the last poll.
+     */
+    void batteryPercentChanged(libopenrazer::Device *device, double percent);
+
+    /*!
+     * Emitted when \a device has started or stopped \a charging.
+     */
+    void chargingChanged(libopenrazer::Device *device, bool charging);
+
+private:
+    struct Entry {
+        // Identifies the entry in replies, the device could be removed and added again while a poll is running
+        int id;
+        qint64 due;
+        int interval;
+        bool polling;
+        bool hasValues;
+        double percent;
+        bool charging;
+        bool thresholdKnown;
+        double threshold;
+        QMetaObject::Connection destroyedConnection;
+    };
+    struct Poll;
+
+    void schedule();
+    void poll();
+    void pollFinished(Device *device, const Poll &poll);
+
+    QHash<Device *, Entry> m_entries;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    int m_nextId = 1;
+    int m_minimumInterval = 10000;
+    int m_maximumInterval = 300000;
+    int m_batchWindow = 2000;
+};
+
+}
+
+#endif // POLLSCHEDULER_H
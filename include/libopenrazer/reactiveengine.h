@@ -0,0 +1,85 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef REACTIVEENGINE_H
+#define REACTIVEENGINE_H
+
+#include "libopenrazer/customframe.h"
+#include "libopenrazer/framestats.h"
+
+#include <QObject>
+#include <QVector>
+
+namespace libopenrazer {
+
+class Device;
+class KeyEventSource;
+struct DeviceGeometry;
+
+/*!
+ * \brief Software reactive effect driven by key events.
+ *
+ * Every key press from the KeyEventSource is mapped through the key codes of the DeviceGeometry to a matrix cell, which then lights up and fades back to the background color. Only the rows that changed are sent to the device, the fading runs on the shared TickScheduler while any key is still lit.
+ *
+ * Unlike Led::setReactive(), any color and fade duration can be used.
+ */
+class ReactiveEngine : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * Creates an engine lighting up the keys of \a device, which has the layout \a geometry, for the key presses from \a source.
+     */
+    ReactiveEngine(Device *device, const DeviceGeometry *geometry, KeyEventSource *source, QObject *parent = nullptr);
+    ~ReactiveEngine() override;
+
+    /*!
+     * Sets the \a color of pressed keys and the \a background color.
+     */
+    void setColors(::openrazer::RGB color, ::openrazer::RGB background);
+
+    /*!
+     * Sets the time in milliseconds until a pressed key has faded out completely. Defaults to 500 ms.
+     */
+    void setFadeDuration(int msec);
+
+    /*!
+     * Starts reacting to key presses and shows the background.
+     */
+    void start();
+
+    /*!
+     * Stops reacting to key presses.
+     */
+    void stop();
+
+    /*!
+     * Returns the latencies from a key press to the start of sending the frame to the daemon.
+     */
+    const Histogram &latency() const;
+
+private:
+    void keyPressed(ushort code, qint64 timestamp);
+    void tick();
+    void render();
+    void upload();
+
+    Device *m_device;
+    KeyEventSource *m_source;
+    CustomFrame m_frame;
+    // Key code -> index of the matrix cell, -1 for unknown keys
+    QVector<short> m_keyIndex;
+    QVector<uchar> m_intensity;
+    int m_litCells = 0;
+    ::openrazer::RGB m_color { 0, 255, 0 };
+    ::openrazer::RGB m_background { 0, 0, 0 };
+    int m_fadeDuration = 500;
+    int m_subscription = 0;
+    QMetaObject::Connection m_connection;
+    Histogram m_latency;
+};
+
+}
+
+#endif // REACTIVEENGINE_H
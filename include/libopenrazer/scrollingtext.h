@@ -0,0 +1,125 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SCROLLINGTEXT_H
+#define SCROLLINGTEXT_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QString>
+#include <QVector>
+
+namespace libopenrazer {
+
+class CustomFrame;
+
+/*!
+ * \brief Bitmap font rasterized at matrix resolution.
+ *
+ * Every printable ASCII character is rasterized once into columns of bits (bit \c n set means the pixel in row \c n is lit). Other characters are drawn as `?`.
+ *
+ * Rasterizing needs a QGuiApplication.
+ */
+class GlyphAtlas
+{
+public:
+    /*!
+     * Returns the shared atlas for glyphs that are \a height pixels high (`1` - `32`), rasterizing it on first use.
+     */
+    static const GlyphAtlas *forHeight(int height);
+
+    /*!
+     * Returns the height of the glyphs in pixels.
+     */
+    int height() const;
+
+    /*!
+     * Returns the width of the glyph for \a c in columns.
+     */
+    int glyphWidth(QChar c) const;
+
+    /*!
+     * Returns the columns of the glyph for \a c, glyphWidth() entries long.
+     */
+    const quint32 *glyphColumns(QChar c) const;
+
+private:
+    explicit GlyphAtlas(int height);
+    int glyphIndex(QChar c) const;
+
+    static const ushort FirstChar = 0x20;
+    static const ushort LastChar = 0x7E;
+
+    int m_height;
+    QVector<quint32> m_columns;
+    int m_offsets[LastChar - FirstChar + 2];
+};
+
+/*!
+ * \brief Scrolling text source for matrix devices.
+ *
+ * The text is laid out into a strip of glyph columns once in setText(), render() then only copies the visible columns into a CustomFrame. Together with CustomFrame::upload() only rows that actually changed are sent to the device.
+ *
+ * \code
+ * libopenrazer::CustomFrame frame(device->getMatrixDimensions());
+ * libopenrazer::ScrollingText text(libopenrazer::GlyphAtlas::forHeight(frame.rows()));
+ * text.setText("Build passed");
+ * libopenrazer::TickScheduler::instance()->subscribe(device, 6, [&](quint64) {
+ *     text.advance();
+ *     text.render(&frame);
+ *     frame.upload(device);
+ * });
+ * \endcode
+ */
+class ScrollingText
+{
+public:
+    explicit ScrollingText(const GlyphAtlas *atlas);
+
+    /*!
+     * Sets the \a text to display, followed by \a gap empty columns before it repeats.
+     */
+    void setText(const QString &text, int gap = 4);
+
+    /*!
+     * Sets the \a foreground color of the text and the \a background color.
+     */
+    void setColors(::openrazer::RGB foreground, ::openrazer::RGB background);
+
+    /*!
+     * Returns the length of the text (including the gap) in columns.
+     */
+    int length() const;
+
+    /*!
+     * Sets the first visible column to \a offset.
+     */
+    void setOffset(int offset);
+
+    /*!
+     * Returns the first visible column.
+     */
+    int offset() const;
+
+    /*!
+     * Scrolls the text to the left by \a columns.
+     */
+    void advance(int columns = 1);
+
+    /*!
+     * Draws the visible part of the text into the top rows of \a frame.
+     */
+    void render(CustomFrame *frame) const;
+
+private:
+    const GlyphAtlas *m_atlas;
+    QVector<quint32> m_strip;
+    ::openrazer::RGB m_foreground;
+    ::openrazer::RGB m_background;
+    int m_offset;
+};
+
+}
+
+#endif // SCROLLINGTEXT_H
@@ -0,0 +1,161 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYSTEMMETRICS_H
+#define SYSTEMMETRICS_H
+
+#include "libopenrazer/openrazer.h"
+
+namespace libopenrazer {
+
+class CustomFrame;
+class Led;
+
+/*!
+ * \brief Load indicator source showing CPU, memory, disk and network usage.
+ *
+ * sample() reads `/proc/stat`, `/proc/meminfo`, `/proc/diskstats` and `/proc/net/dev` through file descriptors that stay open, into fixed buffers without allocating. render() then draws one vertical bar per CPU core, followed by bars for memory, disk and network usage, into the columns of a CustomFrame. Zone LEDs can show a single metric with updateZone().
+ *
+ * All values are scaled to `0` - `255`. Only available on Linux, on other systems sample() returns \c false.
+ *
+ * \code
+ * libopenrazer::CustomFrame frame(device->getMatrixDimensions());
+ * libopenrazer::SystemMetrics metrics;
+ * libopenrazer::TickScheduler::instance()->subscribe(device, 60, [&](quint64) {
+ *     metrics.sample();
+ *     metrics.render(&frame);
+ *     frame.upload(device);
+ * });
+ * \endcode
+ */
+class SystemMetrics
+{
+public:
+    enum Metric {
+        Cpu,
+        Memory,
+        Disk,
+        Network,
+    };
+    static const int MetricCount = Network + 1;
+
+    /*!
+     * Maximum number of CPU cores that are sampled individually.
+     */
+    static const int MaxCores = 64;
+
+    SystemMetrics();
+    /*!
+     * Reads the files from \a procPath instead of `/proc`, e.g. for a container with the /proc of the host mounted elsewhere.
+     */
+    explicit SystemMetrics(const char *procPath);
+    ~SystemMetrics();
+
+    SystemMetrics(const SystemMetrics &) = delete;
+    SystemMetrics &operator=(const SystemMetrics &) = delete;
+
+    /*!
+     * Reads the current counters. Loads are calculated relative to the previous call, so the first call only returns zero loads.
+     *
+     * Returns \c false if the counters could not be read, also if `/proc/diskstats` or `/proc/net/dev` doesn't fit into the internal 32 KiB buffer.
+     */
+    bool sample();
+
+    /*!
+     * Returns the number of sampled CPU cores.
+     */
+    int coreCount() const;
+
+    /*!
+     * Returns the load of the CPU \a core.
+     */
+    uchar coreLoad(int core) const;
+
+    /*!
+     * Returns the current value of \a metric. Cpu is the average over all cores, Disk the busy time of the busiest disk (loop devices, RAM disks and partitions are not counted) and Network the traffic relative to networkCapacity().
+     */
+    uchar value(Metric metric) const;
+
+    /*!
+     * Sets the traffic in bytes per second (received and sent) that is shown as full network usage. Defaults to 125 MB/s (1 Gbit/s).
+     */
+    void setNetworkCapacity(quint64 bytesPerSecond);
+    quint64 networkCapacity() const;
+
+    /*!
+     * Sets the \a low and \a high colors of the bars, bars are blended between them by their value. Unlit cells get the \a background color.
+     */
+    void setColors(::openrazer::RGB low, ::openrazer::RGB high, ::openrazer::RGB background);
+
+    /*!
+     * Draws the bars into \a frame. If there are more cores than columns, neighbouring cores share a column.
+     */
+    void render(CustomFrame *frame) const;
+
+    /*!
+     * Sets \a led to the color of \a metric. The color is quantised, so the LED is only written to when the visible color changes. The last written color is remembered per metric.
+     */
+    void updateZone(Led *led, Metric metric);
+
+private:
+    enum File {
+        Stat,
+        MemInfo,
+        DiskStats,
+        NetDev,
+    };
+    static const int FileCount = NetDev + 1;
+
+    // Counters of disks and network interfaces. They are matched by name, as devices can be
+    // added and removed between two samples. Virtual disks and partitions don't get one, so
+    // MaxCounters is only reached with more real disks or interfaces than that.
+    struct Counter {
+        char name[32];
+        int nameLength;
+        quint64 value;
+        bool seen;
+    };
+    static const int MaxCounters = 32;
+    struct CounterSet {
+        Counter counters[MaxCounters];
+        int count = 0;
+    };
+    static void beginCounters(CounterSet *set);
+    static bool updateCounter(CounterSet *set, const char *name, int nameLength, quint64 value, quint64 *delta);
+    static void endCounters(CounterSet *set);
+
+    // Returns the number of bytes read into m_buffer. If complete is true, files that don't fit
+    // into the buffer fail instead of being cut off.
+    int readFile(File file, bool complete);
+    bool sampleCpu();
+    bool sampleMemory();
+    bool sampleDisk(qint64 elapsed);
+    bool sampleNetwork(qint64 elapsed);
+    ::openrazer::RGB color(uchar value) const;
+
+    int m_fds[FileCount];
+
+    qint64 m_lastSample = 0;
+    int m_coreCount = 0;
+    quint64 m_coreBusy[MaxCores] = {};
+    quint64 m_coreTotal[MaxCores] = {};
+    uchar m_coreLoad[MaxCores] = {};
+    CounterSet m_disks;
+    CounterSet m_interfaces;
+    quint64 m_networkCapacity = 125000000;
+    uchar m_values[MetricCount] = {};
+
+    ::openrazer::RGB m_low { 0, 255, 0 };
+    ::openrazer::RGB m_high { 255, 0, 0 };
+    ::openrazer::RGB m_background { 0, 0, 0 };
+    ::openrazer::RGB m_zoneColors[MetricCount];
+    bool m_zoneValid[MetricCount] = {};
+
+    // Large enough for the cpu lines of /proc/stat on MaxCores cores, the other files are read completely
+    char m_buffer[32768];
+};
+
+}
+
+#endif // SYSTEMMETRICS_H
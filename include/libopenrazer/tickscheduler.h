@@ -0,0 +1,80 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+namespace libopenrazer {
+
+/*!
+ * \brief Single timer driving all animations.
+ *
+ * Instead of running one QTimer per animated Device or Led, animations subscribe to the shared scheduler. All subscribers are woken by the same high-resolution timer, slower animations run on an integer divisor of the base interval. The timer is stopped while there are no subscribers.
+ *
+ * The scheduler lives in the thread it was first used in, which needs a running event loop.
+ */
+class TickScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * Returns the shared scheduler.
+     */
+    static TickScheduler *instance();
+
+    /*!
+     * Sets the base interval to \a msec milliseconds. Defaults to 16 ms.
+     */
+    void setBaseInterval(int msec);
+
+    /*!
+     * Returns the base interval in milliseconds.
+     */
+    int baseInterval() const;
+
+    /*!
+     * Calls \a callback on every \a divisor'th tick, until unsubscribe() is called or \a context (e.g. the Device or Led being animated) is destroyed.
+     *
+     * The callback receives the number of the current tick, which is shared by all subscribers.
+     *
+     * Returns an id for unsubscribe().
+     */
+    int subscribe(QObject *context, int divisor, const std::function<void(quint64)> &callback);
+
+    /*!
+     * Removes the subscription with the given \a id.
+     */
+    void unsubscribe(int id);
+
+    /*!
+     * Returns if the timer is running, i.e. if there are subscribers.
+     */
+    bool isActive() const;
+
+private:
+    TickScheduler();
+    void tick();
+
+    struct Subscription {
+        int id;
+        int divisor;
+        std::function<void(quint64)> callback;
+        QMetaObject::Connection destroyedConnection;
+    };
+
+    QTimer m_timer;
+    quint64 m_tick = 0;
+    int m_nextId = 1;
+    bool m_dispatching = false;
+    QVector<Subscription> m_subscriptions;
+};
+
+}
+
+#endif // TICKSCHEDULER_H
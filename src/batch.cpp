@@ -0,0 +1,168 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/batch.h"
+
+#include "libopenrazer/dbusexception.h"
+#include "libopenrazer/device.h"
+#include "libopenrazer/led.h"
+
+#include <QFutureInterface>
+#include <QFutureWatcher>
+
+#include <algorithm>
+
+namespace libopenrazer {
+
+// State of one exec(), shared by the callbacks of all queues
+struct Batch::Run {
+    QVector<QVector<Operation>> queues;
+    int remainingQueues = 0;
+    BatchResult result;
+    // Failures together with the index of their operation
+    QVector<QPair<int, BatchFailure>> failures;
+    QFutureInterface<BatchResult> future;
+};
+
+void Batch::add(Device *device, const QString &name, const std::function<QFuture<void>()> &start)
+{
+    append(device, nullptr, name, start);
+}
+
+void Batch::add(Led *led, const QString &name, const std::function<QFuture<void>()> &start)
+{
+    append(led->getDevice(), led, name, start);
+}
+
+void Batch::append(Device *device, Led *led, const QString &name, const std::function<QFuture<void>()> &start)
+{
+    auto it = m_queueIndex.constFind(device);
+    int queue;
+    if (it != m_queueIndex.constEnd()) {
+        queue = it.value();
+    } else {
+        queue = m_queues.size();
+        m_queueIndex.insert(device, queue);
+        m_queues.append(QVector<Operation>());
+    }
+
+    Operation operation;
+    operation.index = m_size++;
+    operation.device = device;
+    operation.led = led;
+    operation.name = name;
+    operation.start = start;
+    m_queues[queue].append(operation);
+}
+
+void Batch::setOff(Led *led)
+{
+    add(led, QStringLiteral("setOff"), [led]() { return led->setOffAsync(); });
+}
+
+void Batch::setStatic(Led *led, ::openrazer::RGB color)
+{
+    add(led, QStringLiteral("setStatic"), [led, color]() { return led->setStaticAsync(color); });
+}
+
+void Batch::setSpectrum(Led *led)
+{
+    add(led, QStringLiteral("setSpectrum"), [led]() { return led->setSpectrumAsync(); });
+}
+
+void Batch::setBrightness(Led *led, uchar brightness)
+{
+    add(led, QStringLiteral("setBrightness"), [led, brightness]() { return led->setBrightnessAsync(brightness); });
+}
+
+void Batch::setDPI(Device *device, ::openrazer::DPI dpi)
+{
+    add(device, QStringLiteral("setDPI"), [device, dpi]() { return device->setDPIAsync(dpi); });
+}
+
+void Batch::setPollRate(Device *device, ushort pollRate)
+{
+    add(device, QStringLiteral("setPollRate"), [device, pollRate]() { return device->setPollRateAsync(pollRate); });
+}
+
+int Batch::size() const
+{
+    return m_size;
+}
+
+void Batch::clear()
+{
+    m_queues.clear();
+    m_queueIndex.clear();
+    m_size = 0;
+}
+
+QFuture<BatchResult> Batch::exec() const
+{
+    QSharedPointer<Run> run(new Run);
+    run->queues = m_queues;
+    run->remainingQueues = m_queues.size();
+    run->future.reportStarted();
+    QFuture<BatchResult> future = run->future.future();
+
+    if (m_queues.isEmpty()) {
+        run->future.reportFinished(&run->result);
+        return future;
+    }
+    // Every device works through its own queue, independently of the others
+    for (int queue = 0; queue < m_queues.size(); queue++)
+        runNext(run, queue, 0);
+    return future;
+}
+
+void Batch::runNext(const QSharedPointer<Run> &run, int queue, int position)
+{
+    const QVector<Operation> &operations = run->queues.at(queue);
+    if (position == operations.size()) {
+        if (--run->remainingQueues > 0)
+            return;
+
+        // Report the failures in the order the operations were added, not in the order they finished
+        std::sort(run->failures.begin(), run->failures.end(), [](const QPair<int, BatchFailure> &a, const QPair<int, BatchFailure> &b) {
+            return a.first < b.first;
+        });
+        for (const QPair<int, BatchFailure> &failure : run->failures)
+            run->result.failures.append(failure.second);
+
+        run->future.reportFinished(&run->result);
+        return;
+    }
+
+    auto *watcher = new QFutureWatcher<void>();
+    QObject::connect(watcher, &QFutureWatcher<void>::finished, [run, queue, position, watcher]() {
+        const Operation &operation = run->queues.at(queue).at(position);
+        watcher->deleteLater();
+        try {
+            // Already finished, this only rethrows the error of the operation
+            watcher->waitForFinished();
+            run->result.succeeded++;
+        } catch (const DBusException &e) {
+            BatchFailure failure;
+            failure.device = operation.device;
+            failure.led = operation.led;
+            failure.operation = operation.name;
+            failure.errorName = e.name();
+            failure.errorMessage = e.message();
+            run->failures.append(qMakePair(operation.index, failure));
+        } catch (const QException &e) {
+            // E.g. QUnhandledException for an exception libopenrazer doesn't know, only the D-Bus errors have a name
+            BatchFailure failure;
+            failure.device = operation.device;
+            failure.led = operation.led;
+            failure.operation = operation.name;
+            failure.errorName = QDBusError::errorString(QDBusError::Failed);
+            failure.errorMessage = QString::fromLocal8Bit(e.what());
+            run->failures.append(qMakePair(operation.index, failure));
+        }
+        runNext(run, queue, position + 1);
+    });
+    watcher->setFuture(operations.at(position).start());
+}
+
+}
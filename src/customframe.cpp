@@ -0,0 +1,88 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/customframe.h"
+
+#include "libopenrazer/device.h"
+
+namespace libopenrazer {
+
+CustomFrame::CustomFrame(::openrazer::MatrixDimensions dimensions)
+    : m_rows(dimensions.x), m_columns(dimensions.y),
+      m_pixels(dimensions.x * dimensions.y, ::openrazer::RGB { 0, 0, 0 }),
+      m_dirtyRows(dimensions.x, true), m_dirtyCount(dimensions.x)
+{
+}
+
+uchar CustomFrame::rows() const
+{
+    return m_rows;
+}
+
+uchar CustomFrame::columns() const
+{
+    return m_columns;
+}
+
+::openrazer::RGB CustomFrame::pixel(uchar row, uchar column) const
+{
+    return m_pixels.at(row * m_columns + column);
+}
+
+void CustomFrame::setPixel(uchar row, uchar column, ::openrazer::RGB color)
+{
+    ::openrazer::RGB &current = m_pixels[row * m_columns + column];
+    if (current == color)
+        return;
+    current = color;
+    if (!m_dirtyRows.at(row)) {
+        m_dirtyRows[row] = true;
+        m_dirtyCount++;
+    }
+}
+
+void CustomFrame::fill(::openrazer::RGB color)
+{
+    for (uchar row = 0; row < m_rows; row++) {
+        for (uchar column = 0; column < m_columns; column++) {
+            setPixel(row, column, color);
+        }
+    }
+}
+
+bool CustomFrame::isRowDirty(uchar row) const
+{
+    return m_dirtyRows.at(row);
+}
+
+bool CustomFrame::isDirty() const
+{
+    return m_dirtyCount > 0;
+}
+
+void CustomFrame::markDirty()
+{
+    m_dirtyRows.fill(true);
+    m_dirtyCount = m_rows;
+}
+
+int CustomFrame::upload(Device *device)
+{
+    if (m_dirtyCount == 0)
+        return 0;
+
+    int sent = 0;
+    for (uchar row = 0; row < m_rows; row++) {
+        if (!m_dirtyRows.at(row))
+            continue;
+        device->defineCustomFrame(row, 0, m_columns - 1, m_pixels.mid(row * m_columns, m_columns));
+        m_dirtyRows[row] = false;
+        m_dirtyCount--;
+        sent++;
+    }
+    device->displayCustomFrame();
+    return sent;
+}
+
+}
@@ -109,9 +109,8 @@ int main(int argc, char *argv[])
     qDebug() << "Turn off on screensaver:" << screensaver;
     manager->setTurnOffOnScreensaver(false);
 
-    for (const QDBusObjectPath &devicePath : manager->getDevices()) {
+    for (const QSharedPointer<libopenrazer::Device> &device : manager->getAllDevices()) {
         qDebug() << "-----------------";
-        libopenrazer::Device *device = manager->getDevice(devicePath);
         qDebug() << "Device name:" << device->getDeviceName();
         qDebug() << "Serial:" << device->getSerial();
         qDebug() << "Firmware version:" << device->getFirmwareVersion();
@@ -119,14 +118,14 @@ int main(int argc, char *argv[])
         qDebug() << "Device type:" << device->getDeviceType();
         qDebug() << "Device image:" << device->getDeviceImageUrl();
 
-        if (device->hasFeature("keyboard_layout")) {
+        if (device->hasFeature(libopenrazer::Device::KeyboardLayout)) {
             qDebug() << "Keyboard layout:" << device->getKeyboardLayout();
         }
 
-        if (device->hasFeature("dpi")) {
+        if (device->hasFeature(libopenrazer::Device::Dpi)) {
             openrazer::DPI dpi = device->getDPI();
             qDebug() << "DPI:" << dpi;
-            if (device->hasFeature("restricted_dpi")) {
+            if (device->hasFeature(libopenrazer::Device::RestrictedDpi)) {
                 QVector<ushort> allowedDPI = device->getAllowedDPI();
                 qDebug() << "Allowed DPI:" << allowedDPI;
                 device->setDPI({ allowedDPI.first(), 0 });
@@ -134,7 +133,7 @@ int main(int argc, char *argv[])
             } else {
                 device->setDPI({ 500, 500 });
             }
-            if (device->hasFeature("dpi_stages")) {
+            if (device->hasFeature(libopenrazer::Device::DpiStages)) {
                 QPair<uchar, QVector<openrazer::DPI>> dpiStages = device->getDPIStages();
                 qDebug() << "DPI stages:" << dpiStages;
                 device->setDPIStages(2, { { 400, 500 }, { 600, 700 }, { 800, 900 } });
@@ -146,7 +145,7 @@ int main(int argc, char *argv[])
             device->setDPI(dpi);
         }
 
-        if (device->hasFeature("poll_rate")) {
+        if (device->hasFeature(libopenrazer::Device::PollRate)) {
             ushort poll_rate = device->getPollRate();
             qDebug() << "Poll rate:" << poll_rate;
             QVector<ushort> supportedPollRates = device->getSupportedPollRates();
@@ -157,16 +156,16 @@ int main(int argc, char *argv[])
             device->setPollRate(poll_rate);
         }
 
-        if (device->hasFeature("custom_frame")) {
+        if (device->hasFeature(libopenrazer::Device::CustomFrame)) {
             qDebug() << "Matrix dimensions:" << device->getMatrixDimensions();
         }
 
-        if (device->hasFeature("battery")) {
+        if (device->hasFeature(libopenrazer::Device::Battery)) {
             qDebug() << "Battery:" << device->getBatteryPercent() << "%";
             qDebug() << "Charging:" << device->isCharging();
         }
 
-        if (device->hasFeature("low_battery_threshold")) {
+        if (device->hasFeature(libopenrazer::Device::LowBatteryThreshold)) {
             double threshold = device->getLowBatteryThreshold();
             qDebug() << "Low battery threshold:" << threshold << "%";
             device->setLowBatteryThreshold(50);
@@ -174,7 +173,7 @@ int main(int argc, char *argv[])
             device->setLowBatteryThreshold(threshold);
         }
 
-        if (device->hasFeature("idle_time")) {
+        if (device->hasFeature(libopenrazer::Device::IdleTime)) {
             ushort idleTime = device->getIdleTime();
             qDebug() << "Idle time:" << idleTime << "seconds";
             device->setIdleTime(900);
@@ -207,8 +206,6 @@ int main(int argc, char *argv[])
             }
             setEffect(led, effect, colors);
         }
-
-        delete device;
     }
 
     // restore settings
@@ -0,0 +1,56 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/device.h"
+
+#include <QStringList>
+
+namespace libopenrazer {
+
+namespace {
+
+struct FeatureName {
+    Device::Feature feature;
+    const char *name;
+};
+
+// Names as used by the daemons
+constexpr FeatureName featureNames[] = {
+    { Device::KeyboardLayout, "keyboard_layout" },
+    { Device::Dpi, "dpi" },
+    { Device::RestrictedDpi, "restricted_dpi" },
+    { Device::DpiStages, "dpi_stages" },
+    { Device::PollRate, "poll_rate" },
+    { Device::CustomFrame, "custom_frame" },
+    { Device::Battery, "battery" },
+    { Device::LowBatteryThreshold, "low_battery_threshold" },
+    { Device::IdleTime, "idle_time" },
+};
+
+}
+
+const char *Device::featureName(Feature feature)
+{
+    for (const FeatureName &entry : featureNames) {
+        if (entry.feature == feature)
+            return entry.name;
+    }
+    return nullptr;
+}
+
+Device::Features Device::featuresFromNames(const QStringList &featureStrs)
+{
+    Features features;
+    for (const QString &featureStr : featureStrs) {
+        for (const FeatureName &entry : featureNames) {
+            if (featureStr == QLatin1String(entry.name)) {
+                features |= entry.feature;
+                break;
+            }
+        }
+    }
+    return features;
+}
+
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICEDESCRIPTORCACHE_P_H
+#define DEVICEDESCRIPTORCACHE_P_H
+
+#include "libopenrazer/devicedescriptor.h"
+
+#include <QMutex>
+
+namespace libopenrazer {
+
+// Immutable metadata of a Device, shared by both backends. Every field is fetched and cached on
+// its own, so a getter only costs its own round trip and a failing call only affects its own
+// getter. Shared with the callbacks of async calls which can outlive the Device. All methods are
+// thread-safe.
+class DeviceDescriptorCache
+{
+public:
+    enum Field {
+        Serial,
+        DeviceName,
+        DeviceType,
+        FirmwareVersion,
+        KeyboardLayout,
+        DeviceImageUrl,
+        MatrixDimensions,
+        MaxDPI,
+        SupportedPollRates,
+        AllowedDPI,
+        FieldCount
+    };
+
+    bool has(Field field) const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_valid[field];
+    }
+
+    // Returns false if the field isn't cached
+    template<typename T>
+    bool get(Field field, T DeviceDescriptor::*member, T *result) const
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_valid[field])
+            *result = m_descriptor.*member;
+        return m_valid[field];
+    }
+
+    // Returns the value, so it can be used as the converter of an async call
+    template<typename T>
+    T store(Field field, T DeviceDescriptor::*member, const T &value)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_descriptor.*member = value;
+        m_valid[field] = true;
+        return value;
+    }
+
+    // Fields that aren't cached are left empty
+    DeviceDescriptor descriptor() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_descriptor;
+    }
+
+    void invalidate()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_descriptor = DeviceDescriptor();
+        for (bool &valid : m_valid)
+            valid = false;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    DeviceDescriptor m_descriptor;
+    bool m_valid[FieldCount] = {};
+};
+
+}
+
+#endif // DEVICEDESCRIPTORCACHE_P_H
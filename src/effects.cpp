@@ -0,0 +1,239 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "config.h"
+#include "effects_p.h"
+#include "libopenrazer.h"
+
+#include <QtMath>
+
+namespace libopenrazer {
+
+namespace fixedpoint {
+
+namespace {
+
+/*
+ * (1 - cos(2 * pi * i / 256)) / 2 in Q8.8 (255.0 == 65280), one extra entry
+ * so the interpolation in breathingIntensity() doesn't need to wrap.
+ */
+const ushort breathingTable[257] = {
+    0, 10, 39, 88, 157, 245, 353, 481, 627, 793, 978, 1182,
+    1405, 1647, 1908, 2187, 2485, 2800, 3134, 3485, 3854, 4240, 4644, 5064,
+    5501, 5954, 6423, 6908, 7409, 7925, 8455, 9001, 9560, 10133, 10720, 11320,
+    11933, 12559, 13196, 13846, 14506, 15178, 15860, 16552, 17254, 17965, 18685, 19413,
+    20149, 20893, 21644, 22401, 23165, 23934, 24709, 25489, 26272, 27060, 27851, 28645,
+    29441, 30239, 31038, 31839, 32640, 33441, 34242, 35041, 35839, 36635, 37429, 38220,
+    39008, 39791, 40571, 41346, 42115, 42879, 43636, 44387, 45131, 45867, 46595, 47315,
+    48026, 48728, 49420, 50102, 50774, 51434, 52084, 52721, 53347, 53960, 54560, 55147,
+    55720, 56279, 56825, 57355, 57871, 58372, 58857, 59326, 59779, 60216, 60636, 61040,
+    61426, 61795, 62146, 62480, 62795, 63093, 63372, 63633, 63875, 64098, 64302, 64487,
+    64653, 64799, 64927, 65035, 65123, 65192, 65241, 65270, 65280, 65270, 65241, 65192,
+    65123, 65035, 64927, 64799, 64653, 64487, 64302, 64098, 63875, 63633, 63372, 63093,
+    62795, 62480, 62146, 61795, 61426, 61040, 60636, 60216, 59779, 59326, 58857, 58372,
+    57871, 57355, 56825, 56279, 55720, 55147, 54560, 53960, 53347, 52721, 52084, 51434,
+    50774, 50102, 49420, 48728, 48026, 47315, 46595, 45867, 45131, 44387, 43636, 42879,
+    42115, 41346, 40571, 39791, 39008, 38220, 37429, 36635, 35839, 35041, 34242, 33441,
+    32640, 31839, 31038, 30239, 29441, 28645, 27851, 27060, 26272, 25489, 24709, 23934,
+    23165, 22401, 21644, 20893, 20149, 19413, 18685, 17965, 17254, 16552, 15860, 15178,
+    14506, 13846, 13196, 12559, 11933, 11320, 10720, 10133, 9560, 9001, 8455, 7925,
+    7409, 6908, 6423, 5954, 5501, 5064, 4644, 4240, 3854, 3485, 3134, 2800,
+    2485, 2187, 1908, 1647, 1405, 1182, 978, 793, 627, 481, 353, 245,
+    157, 88, 39, 10, 0,
+};
+
+// Rounded x * y / 255 for x, y in [0, 255], without a division
+inline uchar mulDiv255(uint x, uint y)
+{
+    uint t = x * y + 128;
+    return static_cast<uchar>((t + (t >> 8)) >> 8);
+}
+
+inline uchar lerp255(uint a, uint b, uint alpha)
+{
+    uint t = a * (255 - alpha) + b * alpha + 128;
+    return static_cast<uchar>((t + (t >> 8)) >> 8);
+}
+
+}
+
+uchar breathingIntensity(uint timeMs, uint periodMs)
+{
+    if (periodMs == 0)
+        return 0;
+    // Phase in Q16.16, only the fractional part is used
+    uint phase = static_cast<uint>((static_cast<quint64>(timeMs % periodMs) << 16) / periodMs);
+    uint index = phase >> 8;
+    uint frac = phase & 0xFF;
+    uint a = breathingTable[index];
+    uint b = breathingTable[index + 1];
+    uint value = b >= a ? a + (((b - a) * frac) >> 8) : a - (((a - b) * frac) >> 8);
+    return static_cast<uchar>((value + 128) >> 8);
+}
+
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value)
+{
+    hue %= 360;
+    if (saturation == 0)
+        return { value, value, value };
+
+    uint region = hue / 60;
+    // Position inside the region in Q8.8 (0 - 255)
+    uint remainder = ((hue - region * 60) * 255 + 30) / 60;
+
+    uchar p = mulDiv255(value, 255 - saturation);
+    uchar q = mulDiv255(value, 255 - mulDiv255(saturation, remainder));
+    uchar t = mulDiv255(value, 255 - mulDiv255(saturation, 255 - remainder));
+
+    switch (region) {
+    case 0:
+        return { value, t, p };
+    case 1:
+        return { q, value, p };
+    case 2:
+        return { p, value, t };
+    case 3:
+        return { p, q, value };
+    case 4:
+        return { t, p, value };
+    default:
+        return { value, p, q };
+    }
+}
+
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor)
+{
+    return { mulDiv255(color.r, factor), mulDiv255(color.g, factor), mulDiv255(color.b, factor) };
+}
+
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha)
+{
+    return { lerp255(a.r, b.r, alpha), lerp255(a.g, b.g, alpha), lerp255(a.b, b.b, alpha) };
+}
+
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha)
+{
+    for (int i = 0; i < count; i++) {
+        dst[i] = { lerp255(dst[i].r, src[i].r, alpha),
+                   lerp255(dst[i].g, src[i].g, alpha),
+                   lerp255(dst[i].b, src[i].b, alpha) };
+    }
+}
+
+}
+
+namespace floatingpoint {
+
+namespace {
+
+inline uchar toChannel(double value)
+{
+    return static_cast<uchar>(qBound(0.0, value + 0.5, 255.0));
+}
+
+}
+
+uchar breathingIntensity(uint timeMs, uint periodMs)
+{
+    if (periodMs == 0)
+        return 0;
+    double phase = static_cast<double>(timeMs % periodMs) / periodMs;
+    return toChannel((1 - qCos(2 * M_PI * phase)) / 2 * 255);
+}
+
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value)
+{
+    hue %= 360;
+    if (saturation == 0)
+        return { value, value, value };
+
+    double s = saturation / 255.0;
+    double v = value;
+    int region = hue / 60;
+    double f = (hue - region * 60) / 60.0;
+
+    uchar p = toChannel(v * (1 - s));
+    uchar q = toChannel(v * (1 - s * f));
+    uchar t = toChannel(v * (1 - s * (1 - f)));
+
+    switch (region) {
+    case 0:
+        return { value, t, p };
+    case 1:
+        return { q, value, p };
+    case 2:
+        return { p, value, t };
+    case 3:
+        return { p, q, value };
+    case 4:
+        return { t, p, value };
+    default:
+        return { value, p, q };
+    }
+}
+
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor)
+{
+    double f = factor / 255.0;
+    return { toChannel(color.r * f), toChannel(color.g * f), toChannel(color.b * f) };
+}
+
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha)
+{
+    double f = alpha / 255.0;
+    return { toChannel(a.r + (b.r - a.r) * f),
+             toChannel(a.g + (b.g - a.g) * f),
+             toChannel(a.b + (b.b - a.b) * f) };
+}
+
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha)
+{
+    for (int i = 0; i < count; i++) {
+        dst[i] = blendColors(dst[i], src[i], alpha);
+    }
+}
+
+}
+
+#ifdef LIBOPENRAZER_FIXED_POINT
+namespace kernels = fixedpoint;
+#else
+namespace kernels = floatingpoint;
+#endif
+
+bool effectsUseFixedPoint()
+{
+#ifdef LIBOPENRAZER_FIXED_POINT
+    return true;
+#else
+    return false;
+#endif
+}
+
+uchar breathingIntensity(uint timeMs, uint periodMs)
+{
+    return kernels::breathingIntensity(timeMs, periodMs);
+}
+
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value)
+{
+    return kernels::hsvToRgb(hue, saturation, value);
+}
+
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor)
+{
+    return kernels::scaleColor(color, factor);
+}
+
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha)
+{
+    return kernels::blendColors(a, b, alpha);
+}
+
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha)
+{
+    kernels::blendRow(dst, src, count, alpha);
+}
+
+}
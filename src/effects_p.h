@@ -0,0 +1,34 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EFFECTS_P_H
+#define EFFECTS_P_H
+
+#include "libopenrazer/openrazer.h"
+
+namespace libopenrazer {
+
+// Both variants of the effect kernels are always built, the public functions in effects.h forward
+// to the one selected with the meson option fixed_point. Having both lets the tests compare their
+// results and speed on the same host.
+
+namespace floatingpoint {
+uchar breathingIntensity(uint timeMs, uint periodMs);
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value);
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor);
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha);
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha);
+}
+
+namespace fixedpoint {
+uchar breathingIntensity(uint timeMs, uint periodMs);
+::openrazer::RGB hsvToRgb(ushort hue, uchar saturation, uchar value);
+::openrazer::RGB scaleColor(::openrazer::RGB color, uchar factor);
+::openrazer::RGB blendColors(::openrazer::RGB a, ::openrazer::RGB b, uchar alpha);
+void blendRow(::openrazer::RGB *dst, const ::openrazer::RGB *src, int count, uchar alpha);
+}
+
+}
+
+#endif // EFFECTS_P_H
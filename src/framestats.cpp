@@ -0,0 +1,207 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/framestats.h"
+
+#include <chrono>
+
+namespace libopenrazer {
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+void Histogram::record(qint64 nsecs)
+{
+    if (nsecs < 0)
+        nsecs = 0;
+    quint64 usecs = static_cast<quint64>(nsecs) / 1000;
+    int index = 0;
+    while (usecs > 1 && index < BucketCount - 1) {
+        usecs >>= 1;
+        index++;
+    }
+    m_buckets[index]++;
+    m_count++;
+    m_total += nsecs;
+    if (nsecs > m_max)
+        m_max = nsecs;
+}
+
+void Histogram::reset()
+{
+    for (quint64 &bucket : m_buckets)
+        bucket = 0;
+    m_count = 0;
+    m_total = 0;
+    m_max = 0;
+}
+
+quint64 Histogram::count() const
+{
+    return m_count;
+}
+
+qint64 Histogram::total() const
+{
+    return m_total;
+}
+
+qint64 Histogram::max() const
+{
+    return m_max;
+}
+
+quint64 Histogram::bucket(int index) const
+{
+    if (index < 0 || index >= BucketCount)
+        return 0;
+    return m_buckets[index];
+}
+
+qint64 Histogram::bucketUpperBound(int index)
+{
+    return (Q_INT64_C(2) << index) * 1000;
+}
+
+FrameStats::ScopedStage::ScopedStage(FrameStats *stats, Stage stage)
+    : m_stats(stats), m_stage(stage), m_start(FrameStats::now())
+{
+}
+
+FrameStats::ScopedStage::~ScopedStage()
+{
+    m_stats->record(m_stage, m_start, FrameStats::now());
+}
+
+FrameStats::FrameStats()
+    : m_frameStart(0), m_inFrame(false), m_budget(0), m_overruns(0)
+{
+}
+
+FrameStats::FrameStats(const FrameStats &other)
+    : FrameStats()
+{
+    *this = other;
+}
+
+FrameStats &FrameStats::operator=(const FrameStats &other)
+{
+    if (this == &other)
+        return *this;
+
+    // Copy under the lock of other first, so the two locks are never held at the same time
+    Histogram stages[StageCount];
+    Histogram frames;
+    qint64 frameStart;
+    bool inFrame;
+    qint64 budget;
+    quint64 overruns;
+    std::function<void(qint64)> overrunCallback;
+    {
+        QMutexLocker locker(&other.m_mutex);
+        for (int i = 0; i < StageCount; i++)
+            stages[i] = other.m_stages[i];
+        frames = other.m_frames;
+        frameStart = other.m_frameStart;
+        inFrame = other.m_inFrame;
+        budget = other.m_budget;
+        overruns = other.m_overruns;
+        overrunCallback = other.m_overrunCallback;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < StageCount; i++)
+        m_stages[i] = stages[i];
+    m_frames = frames;
+    m_frameStart = frameStart;
+    m_inFrame = inFrame;
+    m_budget = budget;
+    m_overruns = overruns;
+    m_overrunCallback = overrunCallback;
+    return *this;
+}
+
+qint64 FrameStats::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameStats::record(Stage stage, qint64 start, qint64 end)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_inFrame) {
+        m_frameStart = start;
+        m_inFrame = true;
+    }
+    m_stages[stage].record(end - start);
+}
+
+void FrameStats::endFrame()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_inFrame)
+        return;
+    m_inFrame = false;
+
+    qint64 duration = now() - m_frameStart;
+    m_frames.record(duration);
+    if (m_budget > 0 && duration > m_budget) {
+        m_overruns++;
+        // Not holding the lock in the callback, it may read the stats
+        std::function<void(qint64)> callback = m_overrunCallback;
+        locker.unlock();
+        if (callback)
+            callback(duration);
+    }
+}
+
+Histogram FrameStats::stage(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stages[stage];
+}
+
+Histogram FrameStats::frames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames;
+}
+
+void FrameStats::setBudget(qint64 nsecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_budget = nsecs;
+}
+
+qint64 FrameStats::budget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+quint64 FrameStats::overruns() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_overruns;
+}
+
+void FrameStats::setOverrunCallback(const std::function<void(qint64)> &callback)
+{
+    QMutexLocker locker(&m_mutex);
+    m_overrunCallback = callback;
+}
+
+void FrameStats::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (Histogram &histogram : m_stages)
+        histogram.reset();
+    m_frames.reset();
+    m_inFrame = false;
+    m_overruns = 0;
+}
+
+}
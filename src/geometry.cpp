@@ -0,0 +1,145 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer.h"
+
+namespace libopenrazer {
+
+namespace {
+
+constexpr LedPosition NO_LED { 0xFFFF, 0xFFFF };
+
+/*
+ * Full-size 6x22 keyboard matrices as used by the OpenRazer driver, with key
+ * centers based on a 19.05 mm key pitch. Column 0 holds the macro keys (if
+ * present), the Razer logo sits in row 0, column 20.
+ */
+// Size: 4572 x 1238
+constexpr LedPosition fullSizeMacroCells[6 * 22] = {
+    // Row 0
+    NO_LED, { 381, 95 }, NO_LED, { 762, 95 }, { 952, 95 }, { 1143, 95 }, { 1334, 95 }, { 1619, 95 }, { 1810, 95 }, { 2000, 95 }, { 2191, 95 },
+    { 2476, 95 }, { 2667, 95 }, { 2858, 95 }, { 3048, 95 }, { 3286, 95 }, { 3477, 95 }, { 3667, 95 }, NO_LED, NO_LED, { 4096, 95 }, NO_LED,
+    // Row 1
+    { 95, 381 }, { 381, 381 }, { 572, 381 }, { 762, 381 }, { 952, 381 }, { 1143, 381 }, { 1334, 381 }, { 1524, 381 }, { 1714, 381 }, { 1905, 381 }, { 2096, 381 },
+    { 2286, 381 }, { 2476, 381 }, { 2667, 381 }, { 2953, 381 }, { 3286, 381 }, { 3477, 381 }, { 3667, 381 }, { 3905, 381 }, { 4096, 381 }, { 4286, 381 }, { 4477, 381 },
+    // Row 2
+    { 95, 572 }, { 429, 572 }, { 667, 572 }, { 857, 572 }, { 1048, 572 }, { 1238, 572 }, { 1429, 572 }, { 1619, 572 }, { 1810, 572 }, { 2000, 572 }, { 2191, 572 },
+    { 2381, 572 }, { 2572, 572 }, { 2762, 572 }, { 3000, 572 }, { 3286, 572 }, { 3477, 572 }, { 3667, 572 }, { 3905, 572 }, { 4096, 572 }, { 4286, 572 }, { 4477, 667 },
+    // Row 3
+    { 95, 762 }, { 452, 762 }, { 714, 762 }, { 905, 762 }, { 1095, 762 }, { 1286, 762 }, { 1476, 762 }, { 1667, 762 }, { 1857, 762 }, { 2048, 762 }, { 2238, 762 },
+    { 2429, 762 }, { 2619, 762 }, NO_LED, { 2929, 762 }, NO_LED, NO_LED, NO_LED, { 3905, 762 }, { 4096, 762 }, { 4286, 762 }, NO_LED,
+    // Row 4
+    { 95, 952 }, { 500, 952 }, NO_LED, { 810, 952 }, { 1000, 952 }, { 1191, 952 }, { 1381, 952 }, { 1572, 952 }, { 1762, 952 }, { 1953, 952 }, { 2143, 952 },
+    { 2334, 952 }, { 2524, 952 }, NO_LED, { 2881, 952 }, NO_LED, { 3477, 952 }, NO_LED, { 3905, 952 }, { 4096, 952 }, { 4286, 952 }, { 4477, 1048 },
+    // Row 5
+    { 95, 1143 }, { 405, 1143 }, { 643, 1143 }, { 881, 1143 }, NO_LED, NO_LED, NO_LED, { 1595, 1143 }, NO_LED, NO_LED, NO_LED,
+    { 2310, 1143 }, { 2548, 1143 }, { 2786, 1143 }, { 3024, 1143 }, { 3286, 1143 }, { 3477, 1143 }, { 3667, 1143 }, NO_LED, { 4000, 1143 }, { 4286, 1143 }, NO_LED,
+};
+
+// Size: 4286 x 1238
+constexpr LedPosition fullSizeCells[6 * 22] = {
+    // Row 0
+    NO_LED, { 95, 95 }, NO_LED, { 476, 95 }, { 667, 95 }, { 857, 95 }, { 1048, 95 }, { 1334, 95 }, { 1524, 95 }, { 1714, 95 }, { 1905, 95 },
+    { 2191, 95 }, { 2381, 95 }, { 2572, 95 }, { 2762, 95 }, { 3000, 95 }, { 3191, 95 }, { 3381, 95 }, NO_LED, NO_LED, { 3810, 95 }, NO_LED,
+    // Row 1
+    NO_LED, { 95, 381 }, { 286, 381 }, { 476, 381 }, { 667, 381 }, { 857, 381 }, { 1048, 381 }, { 1238, 381 }, { 1429, 381 }, { 1619, 381 }, { 1810, 381 },
+    { 2000, 381 }, { 2191, 381 }, { 2381, 381 }, { 2667, 381 }, { 3000, 381 }, { 3191, 381 }, { 3381, 381 }, { 3620, 381 }, { 3810, 381 }, { 4000, 381 }, { 4191, 381 },
+    // Row 2
+    NO_LED, { 143, 572 }, { 381, 572 }, { 572, 572 }, { 762, 572 }, { 952, 572 }, { 1143, 572 }, { 1334, 572 }, { 1524, 572 }, { 1714, 572 }, { 1905, 572 },
+    { 2096, 572 }, { 2286, 572 }, { 2476, 572 }, { 2715, 572 }, { 3000, 572 }, { 3191, 572 }, { 3381, 572 }, { 3620, 572 }, { 3810, 572 }, { 4000, 572 }, { 4191, 667 },
+    // Row 3
+    NO_LED, { 167, 762 }, { 429, 762 }, { 619, 762 }, { 810, 762 }, { 1000, 762 }, { 1191, 762 }, { 1381, 762 }, { 1572, 762 }, { 1762, 762 }, { 1953, 762 },
+    { 2143, 762 }, { 2334, 762 }, NO_LED, { 2643, 762 }, NO_LED, NO_LED, NO_LED, { 3620, 762 }, { 3810, 762 }, { 4000, 762 }, NO_LED,
+    // Row 4
+    NO_LED, { 214, 952 }, NO_LED, { 524, 952 }, { 714, 952 }, { 905, 952 }, { 1095, 952 }, { 1286, 952 }, { 1476, 952 }, { 1667, 952 }, { 1857, 952 },
+    { 2048, 952 }, { 2238, 952 }, NO_LED, { 2596, 952 }, NO_LED, { 3191, 952 }, NO_LED, { 3620, 952 }, { 3810, 952 }, { 4000, 952 }, { 4191, 1048 },
+    // Row 5
+    NO_LED, { 119, 1143 }, { 357, 1143 }, { 595, 1143 }, NO_LED, NO_LED, NO_LED, { 1310, 1143 }, NO_LED, NO_LED, NO_LED,
+    { 2024, 1143 }, { 2262, 1143 }, { 2500, 1143 }, { 2738, 1143 }, { 3000, 1143 }, { 3191, 1143 }, { 3381, 1143 }, NO_LED, { 3715, 1143 }, { 4000, 1143 }, NO_LED,
+};
+
+/*
+ * Linux input event codes (see linux/input-event-codes.h) of the keys in the
+ * matrices above, 0 where there is no key. The macro keys report
+ * KEY_MACRO1 - KEY_MACRO5.
+ */
+constexpr ushort fullSizeMacroKeys[6 * 22] = {
+    0, 1, 0, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 87, 88, 99, 70, 119, 0, 0, 0, 0,
+    656, 41, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 110, 102, 104, 69, 98, 55, 74,
+    657, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 43, 111, 107, 109, 71, 72, 73, 78,
+    658, 58, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 0, 28, 0, 0, 0, 75, 76, 77, 0,
+    659, 42, 0, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 0, 54, 0, 103, 0, 79, 80, 81, 96,
+    660, 29, 125, 56, 0, 0, 0, 57, 0, 0, 0, 100, 464, 127, 97, 105, 108, 106, 0, 82, 83, 0,
+};
+
+constexpr ushort fullSizeKeys[6 * 22] = {
+    0, 1, 0, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 87, 88, 99, 70, 119, 0, 0, 0, 0,
+    0, 41, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 110, 102, 104, 69, 98, 55, 74,
+    0, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 43, 111, 107, 109, 71, 72, 73, 78,
+    0, 58, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 0, 28, 0, 0, 0, 75, 76, 77, 0,
+    0, 42, 0, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 0, 54, 0, 103, 0, 79, 80, 81, 96,
+    0, 29, 125, 56, 0, 0, 0, 57, 0, 0, 0, 100, 464, 127, 97, 105, 108, 106, 0, 82, 83, 0,
+};
+
+constexpr ZoneGeometry fullSizeMacroZones[] = {
+    { ::openrazer::LedId::LogoLED, { 4096, 95 } },
+};
+
+constexpr ZoneGeometry fullSizeZones[] = {
+    { ::openrazer::LedId::LogoLED, { 3810, 95 } },
+};
+
+constexpr ZoneGeometry deathAdderChromaZones[] = {
+    { ::openrazer::LedId::ScrollWheelLED, { 350, 300 } },
+    { ::openrazer::LedId::LogoLED, { 350, 1000 } },
+};
+
+constexpr ZoneGeometry basiliskZones[] = {
+    { ::openrazer::LedId::ScrollWheelLED, { 375, 290 } },
+    { ::openrazer::LedId::LogoLED, { 375, 960 } },
+};
+
+constexpr DeviceGeometry fullSizeMacroGeometry { { 6, 22 }, 4572, 1238, fullSizeMacroCells, fullSizeMacroKeys, fullSizeMacroZones, 1 };
+constexpr DeviceGeometry fullSizeGeometry { { 6, 22 }, 4286, 1238, fullSizeCells, fullSizeKeys, fullSizeZones, 1 };
+constexpr DeviceGeometry deathAdderChromaGeometry { { 0, 0 }, 700, 1270, nullptr, nullptr, deathAdderChromaZones, 2 };
+constexpr DeviceGeometry basiliskGeometry { { 0, 0 }, 750, 1240, nullptr, nullptr, basiliskZones, 2 };
+
+struct DeviceGeometryEntry {
+    const char *deviceName;
+    const DeviceGeometry *geometry;
+};
+
+constexpr DeviceGeometryEntry deviceGeometryTable[] = {
+    { "Razer BlackWidow Chroma", &fullSizeMacroGeometry },
+    { "Razer BlackWidow Chroma V2", &fullSizeMacroGeometry },
+    { "Razer BlackWidow Chroma (Overwatch)", &fullSizeMacroGeometry },
+    { "Razer BlackWidow X Chroma", &fullSizeGeometry },
+    { "Razer BlackWidow Elite", &fullSizeGeometry },
+    { "Razer Ornata Chroma", &fullSizeGeometry },
+    { "Razer Cynosa Chroma", &fullSizeGeometry },
+    { "Razer DeathAdder Chroma", &deathAdderChromaGeometry },
+    { "Razer Basilisk", &basiliskGeometry },
+};
+
+}
+
+LedPosition DeviceGeometry::zonePosition(::openrazer::LedId ledId) const
+{
+    for (uchar i = 0; i < zoneCount; i++) {
+        if (zones[i].ledId == ledId)
+            return zones[i].position;
+    }
+    return NO_LED;
+}
+
+const DeviceGeometry *findDeviceGeometry(const QString &deviceName)
+{
+    for (const DeviceGeometryEntry &entry : deviceGeometryTable) {
+        if (deviceName == QLatin1String(entry.deviceName))
+            return entry.geometry;
+    }
+    return nullptr;
+}
+
+}
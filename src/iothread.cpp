@@ -0,0 +1,168 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "iothread_p.h"
+#include "libopenrazer/dbusexception.h"
+#include "libopenrazer/framestats.h"
+#include "libopenrazer/iothread.h"
+#include "libopenrazer_private.h"
+
+#include <QAbstractEventDispatcher>
+#include <QMutex>
+
+namespace libopenrazer {
+
+static QAtomicPointer<IoWorker> ioWorker;
+
+void IoThread::enable()
+{
+    if (isEnabled())
+        return;
+    IoWorker::create();
+}
+
+bool IoThread::isEnabled()
+{
+    return IoWorker::instance() != nullptr;
+}
+
+IoWorker *IoWorker::instance()
+{
+    return ioWorker.loadAcquire();
+}
+
+void IoWorker::create()
+{
+    // Runs until the application exits
+    ioWorker.storeRelease(new IoWorker());
+}
+
+IoWorker::IoWorker()
+    : m_head(nullptr)
+{
+    m_thread.setObjectName(QStringLiteral("libopenrazer I/O"));
+    m_context.moveToThread(&m_thread);
+    m_thread.start();
+}
+
+void IoWorker::watch(const AsyncCall &call, const std::function<void(const QDBusPendingCall &)> &finished)
+{
+    // Every started QThread has an event dispatcher, but only a running event loop ever processes
+    // the callback. Pool workers and threads with their own run() would wait forever for it.
+    QThread *thread = QThread::currentThread();
+    QObject *context = thread->loopLevel() > 0 ? thread->eventDispatcher() : nullptr;
+    Job *job = new Job { call, finished, context, nullptr };
+    Job *head;
+    do {
+        head = m_head.loadAcquire();
+        job->next = head;
+    } while (!m_head.testAndSetRelease(head, job));
+
+    // Only the first job of an empty queue needs to wake the thread, later ones get drained with it
+    if (head == nullptr) {
+        QMetaObject::invokeMethod(&m_context, [this]() {
+            drain();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void IoWorker::drain()
+{
+    // Take all queued jobs at once and restore the order they were queued in
+    Job *jobs = m_head.fetchAndStoreAcquire(nullptr);
+    Job *ordered = nullptr;
+    while (jobs != nullptr) {
+        Job *next = jobs->next;
+        jobs->next = ordered;
+        ordered = jobs;
+        jobs = next;
+    }
+
+    while (ordered != nullptr) {
+        Job *job = ordered;
+        ordered = job->next;
+
+        auto *watcher = new QDBusPendingCallWatcher(job->call.send(), &m_context);
+        std::function<void(const QDBusPendingCall &)> finished = job->finished;
+        QPointer<QObject> context = job->context;
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [finished, context](QDBusPendingCallWatcher *watcher) {
+            QDBusPendingCall call = *watcher;
+            watcher->deleteLater();
+            if (context.isNull()) {
+                finished(call);
+                return;
+            }
+            // Caches and slots of the caller are only touched on its own thread
+            QMetaObject::invokeMethod(context.data(), [finished, call]() {
+                finished(call);
+            }, Qt::QueuedConnection);
+        });
+        delete job;
+    }
+}
+
+struct AsyncCall::Data {
+    explicit Data(const QDBusConnection &connection)
+        : connection(connection)
+    {
+    }
+
+    QMutex mutex;
+    QDBusConnection connection;
+    // Only set until the call has been sent
+    QDBusMessage message;
+    bool sent = false;
+    qint64 sentAt = 0;
+    QDBusPendingReply<> call;
+};
+
+AsyncCall::AsyncCall(const QDBusConnection &connection, const QDBusMessage &message)
+    : d(new Data(connection))
+{
+    d->message = message;
+    if (IoWorker::instance() == nullptr)
+        send();
+}
+
+AsyncCall::AsyncCall(const QDBusPendingCall &call)
+    : d(new Data(QDBusConnection(QString())))
+{
+    d->sent = true;
+    d->call = call;
+}
+
+QDBusPendingCall AsyncCall::send() const
+{
+    QMutexLocker locker(&d->mutex);
+    if (!d->sent) {
+        d->call = d->connection.asyncCall(d->message);
+        d->sentAt = FrameStats::now();
+        d->message = QDBusMessage();
+        d->sent = true;
+    }
+    return d->call;
+}
+
+qint64 AsyncCall::sentAt() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->sentAt;
+}
+
+void watchPendingCall(const AsyncCall &call, const std::function<void(const QDBusPendingCall &)> &finished)
+{
+    IoWorker *worker = IoWorker::instance();
+    if (worker != nullptr) {
+        worker->watch(call, finished);
+        return;
+    }
+
+    auto *watcher = new QDBusPendingCallWatcher(call.send());
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [finished](QDBusPendingCallWatcher *watcher) {
+        finished(*watcher);
+        watcher->deleteLater();
+    });
+}
+
+}
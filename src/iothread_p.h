@@ -0,0 +1,53 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IOTHREAD_P_H
+#define IOTHREAD_P_H
+
+#include "libopenrazer_private.h"
+
+#include <QAtomicPointer>
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <functional>
+
+namespace libopenrazer {
+
+// Sends and watches the calls of Async methods on the I/O thread. Calls are handed over through a
+// lock-free queue, so callers on any thread never wait for a lock. The callbacks are handed back
+// to the event loop of the thread that queued the call if it was running one at that time.
+class IoWorker
+{
+public:
+    // Returns nullptr if the I/O thread isn't enabled
+    static IoWorker *instance();
+    static void create();
+
+    void watch(const AsyncCall &call, const std::function<void(const QDBusPendingCall &)> &finished);
+
+private:
+    IoWorker();
+
+    void drain();
+
+    struct Job {
+        AsyncCall call;
+        std::function<void(const QDBusPendingCall &)> finished;
+        // Event dispatcher of the calling thread, finished runs on the I/O thread if the caller
+        // wasn't inside an event loop
+        QPointer<QObject> context;
+        Job *next;
+    };
+
+    QThread m_thread;
+    // Lives in m_thread, parent of the watchers
+    QObject m_context;
+    // Most recently queued job first, nullptr if there's nothing queued
+    QAtomicPointer<Job> m_head;
+};
+
+}
+
+#endif // IOTHREAD_P_H
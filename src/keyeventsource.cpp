@@ -0,0 +1,114 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/keyeventsource.h"
+
+#include "libopenrazer/framestats.h"
+
+#include <QFile>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+// Older kernel headers don't have the y2038-safe accessors yet
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+#endif
+
+namespace libopenrazer {
+
+KeyEventSource::KeyEventSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+EvdevKeyEventSource::EvdevKeyEventSource(const QString &devicePath, QObject *parent)
+    : KeyEventSource(parent)
+{
+#ifdef Q_OS_LINUX
+    m_fd = ::open(QFile::encodeName(devicePath).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning("libopenrazer: Failed to open %s", qUtf8Printable(devicePath));
+        return;
+    }
+    // Get the event timestamps on the same clock as FrameStats::now()
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(m_fd, EVIOCSCLOCKID, &clock) < 0) {
+        qWarning("libopenrazer: Failed to set the clock of %s, converting the timestamps", qUtf8Printable(devicePath));
+        m_realtimeClock = true;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    // QSocketNotifier::activated is overloaded since Qt 5.15
+    connect(m_notifier, SIGNAL(activated(int)), this, SLOT(readEvents()));
+#else
+    Q_UNUSED(devicePath)
+    qWarning("libopenrazer: EvdevKeyEventSource is only supported on Linux");
+#endif
+}
+
+EvdevKeyEventSource::~EvdevKeyEventSource()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0)
+        ::close(m_fd);
+#endif
+}
+
+bool EvdevKeyEventSource::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+void EvdevKeyEventSource::readEvents()
+{
+#ifdef Q_OS_LINUX
+    struct input_event events[64];
+    // Without CLOCK_MONOTONIC the events are stamped on CLOCK_REALTIME, the offset is taken once per read
+    qint64 clockOffset = 0;
+    if (m_realtimeClock) {
+        struct timespec monotonic;
+        struct timespec realtime;
+        clock_gettime(CLOCK_MONOTONIC, &monotonic);
+        clock_gettime(CLOCK_REALTIME, &realtime);
+        clockOffset = (static_cast<qint64>(monotonic.tv_sec) - realtime.tv_sec) * 1000000000 + (monotonic.tv_nsec - realtime.tv_nsec);
+    }
+    ssize_t bytes;
+    while ((bytes = ::read(m_fd, events, sizeof(events))) > 0) {
+        size_t count = static_cast<size_t>(bytes) / sizeof(struct input_event);
+        for (size_t i = 0; i < count; i++) {
+            const struct input_event &event = events[i];
+            // value 1 is a press, 0 a release and 2 an autorepeat
+            if (event.type != EV_KEY || event.value != 1)
+                continue;
+            qint64 timestamp = static_cast<qint64>(event.input_event_sec) * 1000000000 + static_cast<qint64>(event.input_event_usec) * 1000 + clockOffset;
+            emit keyPressed(event.code, timestamp);
+        }
+    }
+    if (bytes == 0 || (bytes < 0 && errno != EAGAIN && errno != EINTR)) {
+        // Device is gone (e.g. unplugged)
+        m_notifier->setEnabled(false);
+    }
+#endif
+}
+
+FakeKeyEventSource::FakeKeyEventSource(QObject *parent)
+    : KeyEventSource(parent)
+{
+}
+
+void FakeKeyEventSource::press(ushort code, qint64 timestamp)
+{
+    emit keyPressed(code, timestamp != 0 ? timestamp : FrameStats::now());
+}
+
+}
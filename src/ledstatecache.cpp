@@ -0,0 +1,282 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ledstatecache_p.h"
+
+#include "libopenrazer/framestats.h"
+#include "libopenrazer_private.h"
+
+namespace libopenrazer {
+
+namespace {
+
+// The getters always return at least three colors
+const int ColorCount = 3;
+
+bool sameWrite(const LedStateCache::EffectWrite &a, const LedStateCache::EffectWrite &b)
+{
+    return a.effect == b.effect && a.parameter == b.parameter && a.colors == b.colors;
+}
+
+// Returns if colors starts with the colors used by write
+bool usesColors(const LedStateCache::EffectWrite &write, const QVector<::openrazer::RGB> &colors)
+{
+    return colors.mid(0, write.colors.size()) == write.colors;
+}
+
+}
+
+LedStateCache::EffectWrite LedStateCache::effectWrite(::openrazer::Effect effect, const QVector<::openrazer::RGB> &colors, int parameter)
+{
+    EffectWrite write;
+    write.effect = effect;
+    write.colors = colors;
+    write.parameter = parameter;
+    return write;
+}
+
+template<typename T>
+bool LedStateCache::fresh(const Value<T> &value) const
+{
+    return m_enabled && value.valid && FrameStats::now() - value.time < m_lifetime * 1000000;
+}
+
+template<typename T>
+void LedStateCache::set(Value<T> *value, const T &newValue)
+{
+    value->valid = true;
+    value->value = newValue;
+    value->time = FrameStats::now();
+}
+
+void LedStateCache::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_enabled = enabled;
+    if (!enabled) {
+        // Nothing is stored while disabled, so nothing outdated is used once it is enabled again
+        invalidateEffectLocked();
+        m_brightness.valid = false;
+        m_generation++;
+        m_brightnessGeneration++;
+    }
+}
+
+bool LedStateCache::isEnabled()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_enabled;
+}
+
+void LedStateCache::setLifetime(qint64 msecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lifetime = msecs;
+}
+
+quint64 LedStateCache::suppressedWrites()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_suppressedWrites;
+}
+
+quint64 LedStateCache::generation()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+quint64 LedStateCache::brightnessGeneration()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_brightnessGeneration;
+}
+
+bool LedStateCache::effect(::openrazer::Effect *result)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!fresh(m_effect))
+        return false;
+    *result = m_effect.value;
+    return true;
+}
+
+bool LedStateCache::colors(QVector<::openrazer::RGB> *result)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!fresh(m_colors))
+        return false;
+    *result = m_colors.value;
+    return true;
+}
+
+bool LedStateCache::waveDirection(::openrazer::WaveDirection *result)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!fresh(m_waveDirection))
+        return false;
+    *result = m_waveDirection.value;
+    return true;
+}
+
+bool LedStateCache::brightness(uchar *result)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!fresh(m_brightness))
+        return false;
+    *result = m_brightness.value;
+    return true;
+}
+
+void LedStateCache::storeEffect(::openrazer::Effect value, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || generation != m_generation)
+        return;
+    set(&m_effect, value);
+    set(&m_reportedEffect, value);
+    // Somebody else has changed the LED since the last write
+    if (m_lastWrite.valid && m_lastWrite.value.effect != value)
+        m_lastWrite.valid = false;
+}
+
+void LedStateCache::storeColors(const QVector<::openrazer::RGB> &value, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || generation != m_generation)
+        return;
+    set(&m_colors, value);
+    set(&m_reportedColors, value);
+    if (m_lastWrite.valid && !usesColors(m_lastWrite.value, value))
+        m_lastWrite.valid = false;
+}
+
+void LedStateCache::storeWaveDirection(::openrazer::WaveDirection value, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || generation != m_generation)
+        return;
+    set(&m_waveDirection, value);
+    if (m_lastWrite.valid && m_lastWrite.value.effect == ::openrazer::Effect::Wave && m_lastWrite.value.parameter != static_cast<int>(value))
+        m_lastWrite.valid = false;
+}
+
+void LedStateCache::storeBrightness(uchar value, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || generation != m_brightnessGeneration)
+        return;
+    set(&m_brightness, value);
+}
+
+bool LedStateCache::changeEffect(::openrazer::Effect value)
+{
+    QMutexLocker locker(&m_mutex);
+    m_generation++;
+    // Compared with what the daemon has reported before, written() already knows the new value
+    bool changed = !m_reportedEffect.valid || m_reportedEffect.value != value;
+    set(&m_reportedEffect, value);
+    if (!m_enabled)
+        return changed;
+    set(&m_effect, value);
+    if (m_lastWrite.valid && m_lastWrite.value.effect != value)
+        m_lastWrite.valid = false;
+    return changed;
+}
+
+bool LedStateCache::changeColors(const QVector<::openrazer::RGB> &value)
+{
+    QMutexLocker locker(&m_mutex);
+    m_generation++;
+    bool changed = !m_reportedColors.valid || m_reportedColors.value != value;
+    set(&m_reportedColors, value);
+    if (!m_enabled)
+        return changed;
+    set(&m_colors, value);
+    if (m_lastWrite.valid && !usesColors(m_lastWrite.value, value))
+        m_lastWrite.valid = false;
+    return changed;
+}
+
+void LedStateCache::invalidateEffect()
+{
+    QMutexLocker locker(&m_mutex);
+    m_generation++;
+    invalidateEffectLocked();
+}
+
+void LedStateCache::invalidateEffectLocked()
+{
+    m_effect.valid = false;
+    m_colors.valid = false;
+    m_waveDirection.valid = false;
+    m_lastWrite.valid = false;
+}
+
+bool LedStateCache::beginWrite(const EffectWrite &write, quint64 *generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (fresh(m_lastWrite) && sameWrite(m_lastWrite.value, write)) {
+        m_suppressedWrites++;
+        return false;
+    }
+    // Unknown until the write has succeeded, it might also fail half way
+    invalidateEffectLocked();
+    *generation = ++m_generation;
+    return true;
+}
+
+bool LedStateCache::beginWrite(uchar brightness, quint64 *generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (fresh(m_brightness) && m_brightness.value == brightness) {
+        m_suppressedWrites++;
+        return false;
+    }
+    m_brightness.valid = false;
+    *generation = ++m_brightnessGeneration;
+    return true;
+}
+
+void LedStateCache::written(const EffectWrite &write, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    // Another write or a change has happened in the meantime
+    if (!m_enabled || generation != m_generation)
+        return;
+    set(&m_effect, write.effect);
+    // The daemon also reports the colors the effect doesn't use, they aren't known from the write.
+    // Only an effect using all of them fills the cache, otherwise they are fetched on demand.
+    if (write.colors.size() >= ColorCount)
+        set(&m_colors, write.colors);
+    if (write.effect == ::openrazer::Effect::Wave)
+        set(&m_waveDirection, static_cast<::openrazer::WaveDirection>(write.parameter));
+    set(&m_lastWrite, write);
+}
+
+void LedStateCache::written(uchar brightness, quint64 generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_enabled || generation != m_brightnessGeneration)
+        return;
+    set(&m_brightness, brightness);
+}
+
+void LedStateCache::watchWrite(const QSharedPointer<LedStateCache> &cache, const AsyncCall &call, const EffectWrite &write, quint64 generation)
+{
+    watchPendingCall(call, [cache, write, generation](const QDBusPendingCall &call) {
+        if (!call.isError())
+            cache->written(write, generation);
+    });
+}
+
+void LedStateCache::watchWrite(const QSharedPointer<LedStateCache> &cache, const AsyncCall &call, uchar brightness, quint64 generation)
+{
+    watchPendingCall(call, [cache, brightness, generation](const QDBusPendingCall &call) {
+        if (!call.isError())
+            cache->written(brightness, generation);
+    });
+}
+
+}
@@ -0,0 +1,108 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LEDSTATECACHE_P_H
+#define LEDSTATECACHE_P_H
+
+#include "libopenrazer/openrazer.h"
+#include "libopenrazer_private.h"
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+namespace libopenrazer {
+
+// Last known state of a Led, shared by both backends. Filled from successful writes (write-through)
+// and from replies of the getters, so getters don't need a round trip and writes of the state the
+// LED already has can be skipped. Other applications can change the LED without the library
+// noticing, so values are only trusted for Lifetime. All methods are thread-safe.
+class LedStateCache
+{
+public:
+    static const qint64 Lifetime = 60000;
+
+    // An effect write with all its arguments
+    struct EffectWrite {
+        ::openrazer::Effect effect;
+        // Empty for effects without colors
+        QVector<::openrazer::RGB> colors;
+        // Direction or speed, -1 for effects without one
+        int parameter;
+    };
+    static EffectWrite effectWrite(::openrazer::Effect effect, const QVector<::openrazer::RGB> &colors = QVector<::openrazer::RGB>(), int parameter = -1);
+
+    void setEnabled(bool enabled);
+    bool isEnabled();
+    // Values older than msecs aren't used, Lifetime by default
+    void setLifetime(qint64 msecs);
+    quint64 suppressedWrites();
+
+    // Incremented on every change of the effect (or the brightness), replies to calls sent before
+    // a change are not stored
+    quint64 generation();
+    quint64 brightnessGeneration();
+
+    bool effect(::openrazer::Effect *result);
+    bool colors(QVector<::openrazer::RGB> *result);
+    bool waveDirection(::openrazer::WaveDirection *result);
+    bool brightness(uchar *result);
+
+    // Values read from the daemon
+    void storeEffect(::openrazer::Effect value, quint64 generation);
+    void storeColors(const QVector<::openrazer::RGB> &value, quint64 generation);
+    void storeWaveDirection(::openrazer::WaveDirection value, quint64 generation);
+    void storeBrightness(uchar value, quint64 generation);
+
+    // Values the daemon reported as changed. Return if the value differs from the one it reported
+    // before.
+    bool changeEffect(::openrazer::Effect value);
+    bool changeColors(const QVector<::openrazer::RGB> &value);
+    void invalidateEffect();
+
+    // Called before a write. Returns false if the LED already has this state and the write is
+    // skipped, otherwise drops the affected values until the write has succeeded.
+    bool beginWrite(const EffectWrite &write, quint64 *generation);
+    bool beginWrite(uchar brightness, quint64 *generation);
+    // Called once the write has succeeded
+    void written(const EffectWrite &write, quint64 generation);
+    void written(uchar brightness, quint64 generation);
+    // Calls written() once the reply of call has arrived without error
+    static void watchWrite(const QSharedPointer<LedStateCache> &cache, const AsyncCall &call, const EffectWrite &write, quint64 generation);
+    static void watchWrite(const QSharedPointer<LedStateCache> &cache, const AsyncCall &call, uchar brightness, quint64 generation);
+
+private:
+    template<typename T>
+    struct Value {
+        bool valid = false;
+        T value;
+        qint64 time = 0;
+    };
+    template<typename T>
+    bool fresh(const Value<T> &value) const;
+    template<typename T>
+    void set(Value<T> *value, const T &newValue);
+    void invalidateEffectLocked();
+
+    QMutex m_mutex;
+    bool m_enabled = true;
+    qint64 m_lifetime = Lifetime;
+    quint64 m_suppressedWrites = 0;
+    quint64 m_generation = 0;
+    quint64 m_brightnessGeneration = 0;
+
+    Value<::openrazer::Effect> m_effect;
+    Value<QVector<::openrazer::RGB>> m_colors;
+    Value<::openrazer::WaveDirection> m_waveDirection;
+    Value<uchar> m_brightness;
+    // Last values read from the daemon, changeEffect() and changeColors() compare with them
+    Value<::openrazer::Effect> m_reportedEffect;
+    Value<QVector<::openrazer::RGB>> m_reportedColors;
+    // Last successful effect write, writes are only skipped if they match it
+    Value<EffectWrite> m_lastWrite;
+};
+
+}
+
+#endif // LEDSTATECACHE_P_H
@@ -5,13 +5,26 @@
 #ifndef LIBOPENRAZER_PRIVATE_H
 #define LIBOPENRAZER_PRIVATE_H
 
+#include "libopenrazer/dbusexception.h"
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QDBusReply>
+#include <QDBusVariant>
+#include <QFutureInterface>
+#include <QSharedPointer>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
 
 namespace libopenrazer {
 
 void printDBusError(QDBusError error, const char *functionname);
 void handleVoidDBusReply(QDBusReply<bool> reply, const char *functionname);
-QString fromCamelCase(const QString &s);
 
 template<typename T>
 T handleDBusReply(QDBusReply<T> reply, const char *functionname)
@@ -28,22 +41,120 @@ template<>
 void handleDBusReply(QDBusReply<void> reply, const char *functionname);
 
 template<typename T>
-T handleDBusVariant(QVariant variant, QDBusError error, const char *functionname)
+T handleDBusVariant(QDBusReply<QDBusVariant> reply, const char *functionname)
 {
-    if (variant.isValid()) {
-        return variant.value<T>();
+    if (reply.isValid()) {
+        return qdbus_cast<T>(reply.value().variant());
     }
-    printDBusError(error, functionname);
-    throw DBusException(error);
+    printDBusError(reply.error(), functionname);
+    throw DBusException(reply.error());
+}
+
+/*
+ * Call of an Async method. Without the IoThread it is sent right away, with it the message is only
+ * sent from the I/O thread once the call is watched. Converting it to a QDBusPendingCall (e.g. to
+ * wait for the reply) sends it from the calling thread if that hasn't happened yet. Copies refer to
+ * the same call, so it is only sent once.
+ */
+class AsyncCall
+{
+public:
+    AsyncCall(const QDBusConnection &connection, const QDBusMessage &message);
+    // A call that has already been sent
+    AsyncCall(const QDBusPendingCall &call);
+
+    QDBusPendingCall send() const;
+    // FrameStats::now() once send() has handed the message to the connection, 0 before
+    qint64 sentAt() const;
+    operator QDBusPendingCall() const
+    {
+        return send();
+    }
+
+private:
+    struct Data;
+    QSharedPointer<Data> d;
+};
+
+/*
+ * Calls finished with the call once its reply has arrived. It runs in the event loop of the calling
+ * thread. With the IoThread enabled, the call is sent and waited for on the I/O thread, finished
+ * runs there if the calling thread wasn't running an event loop when it made the call.
+ */
+void watchPendingCall(const AsyncCall &call, const std::function<void(const QDBusPendingCall &)> &finished);
+
+/*
+ * Async counterparts of the functions above. The returned future finishes once the reply has
+ * arrived, D-Bus errors are reported as DBusException in the future instead of being thrown.
+ * The reply is delivered through watchPendingCall().
+ */
+template<typename T, typename Converter>
+auto handleDBusPendingReply(const AsyncCall &call, const char *functionname, Converter convert)
+        -> QFuture<typename std::decay<decltype(convert(std::declval<T>()))>::type>
+{
+    typedef typename std::decay<decltype(convert(std::declval<T>()))>::type R;
+    QFutureInterface<R> future(QFutureInterfaceBase::Started);
+    watchPendingCall(call, [future, functionname, convert](const QDBusPendingCall &call) mutable {
+        QDBusPendingReply<T> reply = call;
+        if (reply.isError()) {
+            printDBusError(reply.error(), functionname);
+            future.reportException(DBusException(reply.error()));
+        } else {
+            try {
+                future.reportResult(convert(reply.value()));
+            } catch (const DBusException &e) {
+                future.reportException(e);
+            }
+        }
+        future.reportFinished();
+    });
+    return future.future();
+}
+
+template<typename T>
+QFuture<T> handleDBusPendingReply(const AsyncCall &call, const char *functionname)
+{
+    return handleDBusPendingReply<T>(call, functionname, [](const T &value) { return value; });
 }
 
+// Specialization for QDBusPendingReply<>
+template<>
+QFuture<void> handleDBusPendingReply<void>(const AsyncCall &call, const char *functionname);
+
+QFuture<void> handleVoidDBusPendingReply(const AsyncCall &call, const char *functionname);
+
+template<typename T>
+QFuture<T> handleDBusPendingVariant(const AsyncCall &call, const char *functionname)
+{
+    return handleDBusPendingReply<QDBusVariant>(call, functionname, [](const QDBusVariant &value) {
+        return qdbus_cast<T>(value.variant());
+    });
+}
+
+/*
+ * Returns an already finished future, for values that are known without asking the daemon.
+ */
+template<typename T>
+QFuture<T> readyFuture(const T &value)
+{
+    QFutureInterface<T> future(QFutureInterfaceBase::Started);
+    future.reportFinished(&value);
+    return future.future();
+}
+
+QFuture<void> readyFuture();
+
 namespace openrazer {
 extern const char *OPENRAZER_SERVICE_NAME;
-extern QDBusConnection OPENRAZER_DBUS_BUS;
+// Connection to the daemon, chosen on first use and never changed afterwards: a connection only
+// used by libopenrazer if the IoThread is enabled, otherwise the shared one of the application.
+QDBusConnection dbusConnection();
 }
 namespace razer_test {
 extern const char *OPENRAZER_SERVICE_NAME;
-extern QDBusConnection OPENRAZER_DBUS_BUS;
+// Connection to the daemon, chosen on first use and never changed afterwards: a connection only
+// used by libopenrazer if the IoThread is enabled, otherwise the shared one of the application.
+QDBusConnection dbusConnection();
 }
 
 }
@@ -9,7 +9,6 @@
 #include <QCoreApplication>
 #include <QDBusReply>
 #include <QLocale>
-#include <QRegularExpression>
 
 namespace libopenrazer {
 
@@ -43,15 +42,43 @@ void handleVoidDBusReply(QDBusReply<bool> reply, const char *functionname)
     }
 }
 
-// Convert CamelCase string to snake_case
-QString fromCamelCase(const QString &s)
+template<>
+QFuture<void> handleDBusPendingReply<void>(const AsyncCall &call, const char *functionname)
+{
+    QFutureInterface<void> future(QFutureInterfaceBase::Started);
+    watchPendingCall(call, [future, functionname](const QDBusPendingCall &call) mutable {
+        QDBusPendingReply<> reply = call;
+        if (reply.isError()) {
+            printDBusError(reply.error(), functionname);
+            future.reportException(DBusException(reply.error()));
+        }
+        future.reportFinished();
+    });
+    return future.future();
+}
+
+QFuture<void> handleVoidDBusPendingReply(const AsyncCall &call, const char *functionname)
+{
+    QFutureInterface<void> future(QFutureInterfaceBase::Started);
+    watchPendingCall(call, [future, functionname](const QDBusPendingCall &call) mutable {
+        QDBusPendingReply<bool> reply = call;
+        if (reply.isError()) {
+            printDBusError(reply.error(), functionname);
+            future.reportException(DBusException(reply.error()));
+        } else if (!reply.value()) {
+            qWarning("libopenrazer: %s: The function has returned false", functionname);
+            future.reportException(DBusException("Call failed", QString(functionname) + " has returned false"));
+        }
+        future.reportFinished();
+    });
+    return future.future();
+}
+
+QFuture<void> readyFuture()
 {
-    static QRegularExpression regExp1 { "(.)([A-Z][a-z]+)" };
-    static QRegularExpression regExp2 { "([a-z0-9])([A-Z])" };
-    QString result = s;
-    result.replace(regExp1, "\\1_\\2");
-    result.replace(regExp2, "\\1_\\2");
-    return result.toLower();
+    QFutureInterface<void> future(QFutureInterfaceBase::Started);
+    future.reportFinished();
+    return future.future();
 }
 
 bool loadTranslations(QTranslator *translator)
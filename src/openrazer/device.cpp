@@ -7,22 +7,112 @@
 #include "libopenrazer_private.h"
 
 #include <QDBusReply>
-#include <QDomDocument>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QVector>
+#include <QXmlStreamReader>
+
+#include <exception>
 
 namespace libopenrazer {
 
 namespace openrazer {
 
+// Conversions of the daemon replies, shared by the blocking and the async calls
+
+static QString parseDeviceImageUrl(const QString &json)
+{
+    return QJsonDocument::fromJson(json.toUtf8()).object().value("top_img").toString();
+}
+
+static QString translateDeviceType(const QString &type)
+{
+    const QHash<QString, QString> translationTable = {
+        { "core", "accessory" },
+        { "mousemat", "mousepad" },
+        { "mug", "accessory" },
+    };
+    if (translationTable.contains(type))
+        return translationTable.value(type);
+    return type;
+}
+
+static QString translateKeyboardLayout(const QString &layout)
+{
+    const QHash<QString, QString> translationTable = {
+        { "de_DE", "German" },
+        { "el_GR", "Greek" },
+        { "en_GB", "UK" },
+        { "en_US", "US" },
+        { "en_US_mac", "US-mac" },
+        { "es_ES", "Spanish" },
+        { "fr_FR", "French" },
+        { "it_IT", "Italian" },
+        { "ja_JP", "Japanese" },
+        { "pt_PT", "Portuguese" },
+    };
+    if (translationTable.contains(layout))
+        return translationTable.value(layout);
+    return layout;
+}
+
+static ::openrazer::DPI toDPI(const QList<int> &dpi)
+{
+    if (dpi.size() == 1) {
+        return { static_cast<ushort>(dpi[0]), 0 };
+    } else if (dpi.size() == 2) {
+        return { static_cast<ushort>(dpi[0]), static_cast<ushort>(dpi[1]) };
+    } else {
+        throw DBusException("Invalid return array from DPI", "The DPI return array has an invalid size.");
+    }
+}
+
+static QVector<ushort> toAllowedDPI(const QVector<int> &values)
+{
+    if (values.isEmpty())
+        throw DBusException("Invalid return array from availableDPI", "The availableDPI return array is empty.");
+    // Convert QVector<int> to QVector<ushort>
+    QVector<ushort> out;
+    out.reserve(values.size());
+    std::transform(values.cbegin(), values.cend(), std::back_inserter(out),
+                   [](int c) { return static_cast<ushort>(c); });
+    return out;
+}
+
+static ::openrazer::MatrixDimensions toMatrixDimensions(const QList<int> &dims)
+{
+    if (dims.size() != 2)
+        throw DBusException("Invalid return array from getMatrixDimensions", "The getMatrixDimensions return array has an invalid size.");
+    return { static_cast<uchar>(dims[0]), static_cast<uchar>(dims[1]) };
+}
+
+static QByteArray packCustomFrame(uchar row, uchar startColumn, uchar endColumn, const QVector<::openrazer::RGB> &colorData)
+{
+    QByteArray data;
+    data.reserve(3 + colorData.size() * 3);
+    data.append(row);
+    data.append(startColumn);
+    data.append(endColumn);
+    for (const ::openrazer::RGB &color : colorData) {
+        data.append(color.r);
+        data.append(color.g);
+        data.append(color.b);
+    }
+    return data;
+}
+
 Device::Device(QDBusObjectPath objectPath)
+    : Device(objectPath, DevicePrivate::parseIntrospection(handleDBusReply(QDBusReply<QString>(DevicePrivate::introspect(objectPath)), Q_FUNC_INFO)))
+{
+}
+
+Device::Device(QDBusObjectPath objectPath, const DeviceIntrospection &introspection)
 {
     d = new DevicePrivate();
     d->mParent = this;
     d->mObjectPath = objectPath;
 
-    d->introspect();
+    d->introspection = introspection;
     d->setupCapabilities();
 
     QMap<::openrazer::LedId, QString>::const_iterator i = d->supportedLeds.constBegin();
@@ -40,32 +130,40 @@ Device::~Device()
     }
 }
 
-void DevicePrivate::introspect()
-{
-    QStringList intr;
-
-    QDBusMessage m = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "org.freedesktop.DBus.Introspectable", "Introspect");
-    QDBusReply<QString> reply = OPENRAZER_DBUS_BUS.call(m);
-    if (!reply.isValid()) {
-        throw DBusException(reply.error());
-    }
-    QDomDocument doc;
-    doc.setContent(reply.value());
-
-    QDomNodeList nodes = doc.documentElement().childNodes();
-    for (int i = 0; i < nodes.count(); i++) {
-        // Check if "interface" and also not org.freedesktop.DBus.Introspectable
-        QDomElement element = nodes.at(i).toElement();
-        QString interfacename = element.attributeNode("name").value();
-
-        QDomNodeList methodnodes = element.childNodes();
-        for (int ii = 0; ii < methodnodes.count(); ii++) {
-            QDomElement methodelement = methodnodes.at(ii).toElement();
-            intr.append(interfacename + ";" + methodelement.attributeNode("name").value());
+QDBusPendingCall DevicePrivate::introspect(const QDBusObjectPath &objectPath)
+{
+    QDBusMessage m = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, objectPath.path(), "org.freedesktop.DBus.Introspectable", "Introspect");
+    return dbusConnection().asyncCall(m);
+}
+
+DeviceIntrospection DevicePrivate::parseIntrospection(const QString &xml)
+{
+    DeviceIntrospection intr;
+
+    // <node><interface name="..."><method name="..."/>...</interface>...</node>
+    QXmlStreamReader reader(xml);
+    DeviceIntrospection::iterator currentInterface = intr.end();
+    bool inRoot = false;
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        if (reader.name() == QLatin1String("interface")) {
+            currentInterface = intr.insert(reader.attributes().value(QLatin1String("name")).toString(), QSet<QString>());
+        } else if (reader.name() == QLatin1String("node")) {
+            // The root node is the device (dbus-python names it after the object path), nodes below
+            // it are child objects whose interfaces are not the ones of this device
+            if (inRoot) {
+                currentInterface = intr.end();
+                reader.skipCurrentElement();
+            }
+            inRoot = true;
+        } else if (currentInterface != intr.end()) {
+            // Method, signal or property, skip over its arguments
+            currentInterface->insert(reader.attributes().value(QLatin1String("name")).toString());
+            reader.skipCurrentElement();
         }
-        intr.append(interfacename);
     }
-    introspection = intr;
+    return intr;
 }
 
 /**
@@ -73,52 +171,52 @@ void DevicePrivate::introspect()
  */
 void DevicePrivate::setupCapabilities()
 {
-    if (hasCapabilityInternal("razer.device.misc", "getKeyboardLayout"))
-        supportedFeatures.append("keyboard_layout");
-    if (hasCapabilityInternal("razer.device.dpi", "setDPI"))
-        supportedFeatures.append("dpi");
-    if (hasCapabilityInternal("razer.device.dpi", "availableDPI"))
-        supportedFeatures.append("restricted_dpi");
-    if (hasCapabilityInternal("razer.device.dpi", "setDPIStages"))
-        supportedFeatures.append("dpi_stages");
-    if (hasCapabilityInternal("razer.device.misc", "setPollRate"))
-        supportedFeatures.append("poll_rate");
-    if (hasCapabilityInternal("razer.device.lighting.chroma", "setCustom"))
-        supportedFeatures.append("custom_frame");
-    if (hasCapabilityInternal("razer.device.power", "getBattery"))
-        supportedFeatures.append("battery");
-    if (hasCapabilityInternal("razer.device.power", "getLowBatteryThreshold"))
-        supportedFeatures.append("low_battery_threshold");
-    if (hasCapabilityInternal("razer.device.power", "getIdleTime"))
-        supportedFeatures.append("idle_time");
+    if (hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getKeyboardLayout")))
+        features |= Device::KeyboardLayout;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.dpi"), QStringLiteral("setDPI")))
+        features |= Device::Dpi;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.dpi"), QStringLiteral("availableDPI")))
+        features |= Device::RestrictedDpi;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.dpi"), QStringLiteral("setDPIStages")))
+        features |= Device::DpiStages;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("setPollRate")))
+        features |= Device::PollRate;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.chroma"), QStringLiteral("setCustom")))
+        features |= Device::CustomFrame;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.power"), QStringLiteral("getBattery")))
+        features |= Device::Battery;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.power"), QStringLiteral("getLowBatteryThreshold")))
+        features |= Device::LowBatteryThreshold;
+    if (hasCapabilityInternal(QStringLiteral("razer.device.power"), QStringLiteral("getIdleTime")))
+        features |= Device::IdleTime;
 
     // razer.device.lighting.chroma more than only the normal fx, so check for methods directly
-    if (hasCapabilityInternal("razer.device.lighting.chroma", "setNone")
-        || hasCapabilityInternal("razer.device.lighting.chroma", "setStatic")
-        || hasCapabilityInternal("razer.device.lighting.bw2013")
-        || hasCapabilityInternal("razer.device.lighting.brightness"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.chroma"), QStringLiteral("setNone"))
+        || hasCapabilityInternal(QStringLiteral("razer.device.lighting.chroma"), QStringLiteral("setStatic"))
+        || hasCapabilityInternal(QStringLiteral("razer.device.lighting.bw2013"))
+        || hasCapabilityInternal(QStringLiteral("razer.device.lighting.brightness")))
         supportedLeds.insert(::openrazer::LedId::Unspecified, "Chroma");
-    if (hasCapabilityInternal("razer.device.lighting.logo"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.logo")))
         supportedLeds.insert(::openrazer::LedId::LogoLED, "Logo");
-    if (hasCapabilityInternal("razer.device.lighting.scroll"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.scroll")))
         supportedLeds.insert(::openrazer::LedId::ScrollWheelLED, "Scroll");
-    if (hasCapabilityInternal("razer.device.lighting.backlight"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.backlight")))
         supportedLeds.insert(::openrazer::LedId::BacklightLED, "Backlight");
-    if (hasCapabilityInternal("razer.device.lighting.left"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.left")))
         supportedLeds.insert(::openrazer::LedId::LeftSideLED, "Left");
-    if (hasCapabilityInternal("razer.device.lighting.right"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.right")))
         supportedLeds.insert(::openrazer::LedId::RightSideLED, "Right");
-    if (hasCapabilityInternal("razer.device.lighting.profile_led", "setRedLED"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.profile_led"), QStringLiteral("setRedLED")))
         supportedLeds.insert(::openrazer::LedId::KeymapRedLED, "RedLED");
-    if (hasCapabilityInternal("razer.device.lighting.profile_led", "setGreenLED"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.profile_led"), QStringLiteral("setGreenLED")))
         supportedLeds.insert(::openrazer::LedId::KeymapGreenLED, "GreenLED");
-    if (hasCapabilityInternal("razer.device.lighting.profile_led", "setBlueLED"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.profile_led"), QStringLiteral("setBlueLED")))
         supportedLeds.insert(::openrazer::LedId::KeymapBlueLED, "BlueLED");
-    if (hasCapabilityInternal("razer.device.lighting.charging"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.charging")))
         supportedLeds.insert(::openrazer::LedId::ChargingLED, "Charging");
-    if (hasCapabilityInternal("razer.device.lighting.fast_charging"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.fast_charging")))
         supportedLeds.insert(::openrazer::LedId::FastChargingLED, "FastCharging");
-    if (hasCapabilityInternal("razer.device.lighting.fully_charged"))
+    if (hasCapabilityInternal(QStringLiteral("razer.device.lighting.fully_charged")))
         supportedLeds.insert(::openrazer::LedId::FullyChargedLED, "FullyCharged");
 }
 
@@ -127,10 +225,10 @@ void DevicePrivate::setupCapabilities()
  */
 bool DevicePrivate::hasCapabilityInternal(const QString &interface, const QString &method)
 {
-    if (method.isNull()) {
-        return introspection.contains(interface);
-    }
-    return introspection.contains(interface + ";" + method);
+    DeviceIntrospection::const_iterator it = introspection.constFind(interface);
+    if (it == introspection.constEnd())
+        return false;
+    return method.isNull() || it->contains(method);
 }
 
 QDBusObjectPath Device::objectPath()
@@ -140,14 +238,21 @@ QDBusObjectPath Device::objectPath()
 
 bool Device::hasFeature(const QString &featureStr)
 {
-    return d->supportedFeatures.contains(featureStr);
+    return d->features & featuresFromNames(QStringList(featureStr));
+}
+
+Device::Features Device::features()
+{
+    return d->features;
 }
 
 QString Device::getDeviceImageUrl()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getRazerUrls");
-    QString json = handleDBusReply(reply, Q_FUNC_INFO);
-    return QJsonDocument::fromJson(json.toUtf8()).object().value("top_img").toString();
+    QString url;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceImageUrl, &DeviceDescriptor::deviceImageUrl, &url))
+        return url;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getRazerUrls");
+    return d->descriptorCache->store(DeviceDescriptorCache::DeviceImageUrl, &DeviceDescriptor::deviceImageUrl, parseDeviceImageUrl(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
 // ----- DBUS METHODS -----
@@ -159,252 +264,600 @@ QList<::libopenrazer::Led *> Device::getLeds()
 
 QString Device::getDeviceMode()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getDeviceMode");
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getDeviceMode");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 QString Device::getSerial()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getSerial");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString serial;
+    if (d->descriptorCache->get(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, &serial))
+        return serial;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getSerial");
+    return d->descriptorCache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QString Device::getDeviceName()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getDeviceName");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString deviceName;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, &deviceName))
+        return deviceName;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getDeviceName");
+    return d->descriptorCache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QString Device::getDeviceType()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getDeviceType");
-    QString type = handleDBusReply(reply, Q_FUNC_INFO);
-    const QHash<QString, QString> translationTable = {
-        { "core", "accessory" },
-        { "mousemat", "mousepad" },
-        { "mug", "accessory" },
-    };
-    if (translationTable.contains(type))
-        return translationTable.value(type);
-    return type;
+    QString deviceType;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, &deviceType))
+        return deviceType;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getDeviceType");
+    return d->descriptorCache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, translateDeviceType(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
 QString Device::getFirmwareVersion()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getFirmware");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString firmwareVersion;
+    if (d->descriptorCache->get(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, &firmwareVersion))
+        return firmwareVersion;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getFirmware");
+    return d->descriptorCache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QString Device::getKeyboardLayout()
 {
-    QDBusReply<QString> reply = d->deviceMiscIface()->call("getKeyboardLayout");
-    QString layout = handleDBusReply(reply, Q_FUNC_INFO);
-    const QHash<QString, QString> translationTable = {
-        { "de_DE", "German" },
-        { "el_GR", "Greek" },
-        { "en_GB", "UK" },
-        { "en_US", "US" },
-        { "en_US_mac", "US-mac" },
-        { "es_ES", "Spanish" },
-        { "fr_FR", "French" },
-        { "it_IT", "Italian" },
-        { "ja_JP", "Japanese" },
-        { "pt_PT", "Portuguese" },
-    };
-    if (translationTable.contains(layout))
-        return translationTable.value(layout);
-    return layout;
+    QString keyboardLayout;
+    if (d->descriptorCache->get(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, &keyboardLayout))
+        return keyboardLayout;
+    QDBusReply<QString> reply = d->call("razer.device.misc", "getKeyboardLayout");
+    return d->descriptorCache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, translateKeyboardLayout(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
 ushort Device::getPollRate()
 {
-    QDBusReply<int> reply = d->deviceMiscIface()->call("getPollRate");
+    QDBusReply<int> reply = d->call("razer.device.misc", "getPollRate");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::setPollRate(ushort pollrate)
 {
-    QDBusReply<void> reply = d->deviceMiscIface()->call("setPollRate", QVariant::fromValue(pollrate));
+    QDBusReply<void> reply = d->call("razer.device.misc", "setPollRate", { QVariant::fromValue(pollrate) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 QVector<ushort> Device::getSupportedPollRates()
 {
     // Not every device has getSupportedPollRates yet, return defaults in that case.
-    if (!d->hasCapabilityInternal("razer.device.misc", "getSupportedPollRates")) {
+    if (!d->hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getSupportedPollRates")))
         return { 125, 500, 1000 };
-    }
-    QDBusReply<QVector<ushort>> reply = d->deviceMiscIface()->call("getSupportedPollRates");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QVector<ushort> pollRates;
+    if (d->descriptorCache->get(DeviceDescriptorCache::SupportedPollRates, &DeviceDescriptor::supportedPollRates, &pollRates))
+        return pollRates;
+    QDBusReply<QVector<ushort>> reply = d->call("razer.device.misc", "getSupportedPollRates");
+    return d->descriptorCache->store(DeviceDescriptorCache::SupportedPollRates, &DeviceDescriptor::supportedPollRates, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 void Device::setDPI(::openrazer::DPI dpi)
 {
-    QDBusReply<void> reply = d->deviceDpiIface()->call("setDPI", QVariant::fromValue(dpi.dpi_x), QVariant::fromValue(dpi.dpi_y));
+    QDBusReply<void> reply = d->call("razer.device.dpi", "setDPI", { QVariant::fromValue(dpi.dpi_x), QVariant::fromValue(dpi.dpi_y) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 ::openrazer::DPI Device::getDPI()
 {
-    QDBusReply<QList<int>> reply = d->deviceDpiIface()->call("getDPI");
+    QDBusReply<QList<int>> reply = d->call("razer.device.dpi", "getDPI");
     QList<int> dpi = handleDBusReply(reply, Q_FUNC_INFO);
-    if (dpi.size() == 1) {
-        return { static_cast<ushort>(dpi[0]), 0 };
-    } else if (dpi.size() == 2) {
-        return { static_cast<ushort>(dpi[0]), static_cast<ushort>(dpi[1]) };
-    } else {
-        throw DBusException("Invalid return array from DPI", "The DPI return array has an invalid size.");
-    }
+    return toDPI(dpi);
 }
 
 void Device::setDPIStages(uchar activeStage, QVector<::openrazer::DPI> dpiStages)
 {
-    QDBusReply<void> reply = d->deviceDpiIface()->call("setDPIStages", QVariant::fromValue(activeStage), QVariant::fromValue(dpiStages));
+    QDBusReply<void> reply = d->call("razer.device.dpi", "setDPIStages", { QVariant::fromValue(activeStage), QVariant::fromValue(dpiStages) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 QPair<uchar, QVector<::openrazer::DPI>> Device::getDPIStages()
 {
-    QDBusReply<QPair<uchar, QVector<::openrazer::DPI>>> reply = d->deviceDpiIface()->call("getDPIStages");
+    QDBusReply<QPair<uchar, QVector<::openrazer::DPI>>> reply = d->call("razer.device.dpi", "getDPIStages");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 ushort Device::maxDPI()
 {
-    QDBusReply<int> reply = d->deviceDpiIface()->call("maxDPI");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    ushort dpi;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, &dpi))
+        return dpi;
+    QDBusReply<int> reply = d->call("razer.device.dpi", "maxDPI");
+    return d->descriptorCache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, static_cast<ushort>(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
 double Device::getBatteryPercent()
 {
-    QDBusReply<double> reply = d->devicePowerIface()->call("getBattery");
+    QDBusReply<double> reply = d->call("razer.device.power", "getBattery");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 bool Device::isCharging()
 {
-    QDBusReply<bool> reply = d->devicePowerIface()->call("isCharging");
+    QDBusReply<bool> reply = d->call("razer.device.power", "isCharging");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 QVector<ushort> Device::getAllowedDPI()
 {
-    QDBusReply<QVector<int>> reply = d->deviceDpiIface()->call("availableDPI");
-    QVector<int> values = handleDBusReply(reply, Q_FUNC_INFO);
-    if (values.isEmpty())
-        throw DBusException("Invalid return array from availableDPI", "The availableDPI return array is empty.");
-    // Convert QVector<int> to QVector<ushort>
-    QVector<ushort> out;
-    out.reserve(values.size());
-    std::transform(values.cbegin(), values.cend(), std::back_inserter(out),
-                   [](int c) { return static_cast<ushort>(c); });
-    return out;
+    QVector<ushort> allowedDPI;
+    if (d->descriptorCache->get(DeviceDescriptorCache::AllowedDPI, &DeviceDescriptor::allowedDPI, &allowedDPI))
+        return allowedDPI;
+    QDBusReply<QVector<int>> reply = d->call("razer.device.dpi", "availableDPI");
+    return d->descriptorCache->store(DeviceDescriptorCache::AllowedDPI, &DeviceDescriptor::allowedDPI, toAllowedDPI(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
 ushort Device::getIdleTime()
 {
-    QDBusReply<ushort> reply = d->devicePowerIface()->call("getIdleTime");
+    QDBusReply<ushort> reply = d->call("razer.device.power", "getIdleTime");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::setIdleTime(ushort idleTime)
 {
-    QDBusReply<void> reply = d->devicePowerIface()->call("setIdleTime", QVariant::fromValue(idleTime));
+    QDBusReply<void> reply = d->call("razer.device.power", "setIdleTime", { QVariant::fromValue(idleTime) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 double Device::getLowBatteryThreshold()
 {
-    QDBusReply<uchar> reply = d->devicePowerIface()->call("getLowBatteryThreshold");
+    QDBusReply<uchar> reply = d->call("razer.device.power", "getLowBatteryThreshold");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::setLowBatteryThreshold(double threshold)
 {
-    QDBusReply<void> reply = d->devicePowerIface()->call("setLowBatteryThreshold", QVariant::fromValue(threshold));
+    QDBusReply<void> reply = d->call("razer.device.power", "setLowBatteryThreshold", { QVariant::fromValue(static_cast<uchar>(threshold)) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::displayCustomFrame()
 {
-    QDBusReply<void> reply = d->deviceLightingChromaIface()->call("setCustom");
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    QDBusReply<void> reply = d->frameCall(d->asyncCall("razer.device.lighting.chroma", "setCustom"), start);
+    d->frameStats->endFrame();
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData)
 {
-    QByteArray data;
-    data.append(row);
-    data.append(startColumn);
-    data.append(endColumn);
-    for (const ::openrazer::RGB &color : colorData) {
-        data.append(color.r);
-        data.append(color.g);
-        data.append(color.b);
-    }
-    QDBusReply<void> reply = d->deviceLightingChromaIface()->call("setKeyRow", data);
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    QByteArray data = packCustomFrame(row, startColumn, endColumn, colorData);
+    qint64 packed = FrameStats::now();
+    d->frameStats->record(FrameStats::Pack, start, packed);
+
+    QDBusReply<void> reply = d->frameCall(d->asyncCall("razer.device.lighting.chroma", "setKeyRow", { data }), packed);
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 ::openrazer::MatrixDimensions Device::getMatrixDimensions()
 {
-    QDBusReply<QList<int>> reply = d->deviceMiscIface()->call("getMatrixDimensions");
-    QList<int> dims = handleDBusReply(reply, Q_FUNC_INFO);
-    if (dims.size() != 2)
-        throw DBusException("Invalid return array from getMatrixDimensions", "The getMatrixDimensions return array has an invalid size.");
-    return { static_cast<uchar>(dims[0]), static_cast<uchar>(dims[1]) };
+    ::openrazer::MatrixDimensions dimensions;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, &dimensions))
+        return dimensions;
+    QDBusReply<QList<int>> reply = d->call("razer.device.misc", "getMatrixDimensions");
+    return d->descriptorCache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, toMatrixDimensions(handleDBusReply(reply, Q_FUNC_INFO)));
 }
 
-QDBusInterface *DevicePrivate::deviceMiscIface()
+FrameStats *Device::frameStats()
 {
-    if (ifaceMisc == nullptr) {
-        ifaceMisc = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.misc",
-                                       OPENRAZER_DBUS_BUS, mParent);
-    }
-    if (!ifaceMisc->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
-    }
-    return ifaceMisc;
+    return d->frameStats.data();
 }
 
-QDBusInterface *DevicePrivate::deviceDpiIface()
+DeviceDescriptor Device::getDescriptor()
 {
-    if (ifaceDpi == nullptr) {
-        ifaceDpi = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.dpi",
-                                      OPENRAZER_DBUS_BUS, mParent);
-    }
-    if (!ifaceDpi->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
-    }
-    return ifaceDpi;
+    return d->getDescriptor();
 }
 
-QDBusInterface *DevicePrivate::devicePowerIface()
+DeviceDescriptor DevicePrivate::getDescriptor()
 {
-    if (ifacePower == nullptr) {
-        ifacePower = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.power",
-                                        OPENRAZER_DBUS_BUS, mParent);
-    }
-    if (!ifacePower->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
-    }
-    return ifacePower;
+    // Cached fields aren't requested again. The lock of the cache isn't held while waiting for the
+    // daemon, at worst two threads fetch the same field.
+    return finishDescriptor(requestDescriptor());
 }
 
-QDBusInterface *DevicePrivate::deviceLightingChromaIface()
+DevicePrivate::PendingDescriptor DevicePrivate::requestDescriptor()
 {
-    if (ifaceLightingChroma == nullptr) {
-        ifaceLightingChroma = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.lighting.chroma",
-                                                 OPENRAZER_DBUS_BUS, mParent);
+    PendingDescriptor pending;
+    // Fields of capabilities the device doesn't have stay empty
+    auto request = [&pending, this](DeviceDescriptorCache::Field field, bool available) {
+        pending.requested[field] = available && !descriptorCache->has(field);
+        return pending.requested[field];
+    };
+
+    // Send all calls before waiting for the first reply, so this only takes one round trip
+    if (request(DeviceDescriptorCache::Serial, true))
+        pending.serial = asyncCall("razer.device.misc", "getSerial");
+    if (request(DeviceDescriptorCache::DeviceName, true))
+        pending.deviceName = asyncCall("razer.device.misc", "getDeviceName");
+    if (request(DeviceDescriptorCache::DeviceType, true))
+        pending.deviceType = asyncCall("razer.device.misc", "getDeviceType");
+    if (request(DeviceDescriptorCache::FirmwareVersion, true))
+        pending.firmwareVersion = asyncCall("razer.device.misc", "getFirmware");
+    if (request(DeviceDescriptorCache::KeyboardLayout, hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getKeyboardLayout"))))
+        pending.keyboardLayout = asyncCall("razer.device.misc", "getKeyboardLayout");
+    if (request(DeviceDescriptorCache::DeviceImageUrl, hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getRazerUrls"))))
+        pending.razerUrls = asyncCall("razer.device.misc", "getRazerUrls");
+    if (request(DeviceDescriptorCache::MatrixDimensions, hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getMatrixDimensions"))))
+        pending.matrixDimensions = asyncCall("razer.device.misc", "getMatrixDimensions");
+    if (request(DeviceDescriptorCache::MaxDPI, hasCapabilityInternal(QStringLiteral("razer.device.dpi"), QStringLiteral("maxDPI"))))
+        pending.maxDPI = asyncCall("razer.device.dpi", "maxDPI");
+    if (request(DeviceDescriptorCache::SupportedPollRates, hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getSupportedPollRates"))))
+        pending.supportedPollRates = asyncCall("razer.device.misc", "getSupportedPollRates");
+    if (request(DeviceDescriptorCache::AllowedDPI, hasCapabilityInternal(QStringLiteral("razer.device.dpi"), QStringLiteral("availableDPI"))))
+        pending.allowedDPI = asyncCall("razer.device.dpi", "availableDPI");
+    return pending;
+}
+
+DeviceDescriptor DevicePrivate::finishDescriptor(const PendingDescriptor &pending)
+{
+    const char *functionname = Q_FUNC_INFO;
+    DeviceDescriptorCache *cache = descriptorCache.data();
+    // Every field is cached on its own, a failed call doesn't keep the others from being cached.
+    // The first error is thrown once all replies have been handled.
+    std::exception_ptr error;
+    auto finish = [&pending, &error](DeviceDescriptorCache::Field field, const std::function<void()> &store) {
+        if (!pending.requested[field])
+            return;
+        try {
+            store();
+        } catch (const DBusException &) {
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    finish(DeviceDescriptorCache::Serial, [&] {
+        cache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, handleDBusReply(QDBusReply<QString>(pending.serial), functionname));
+    });
+    finish(DeviceDescriptorCache::DeviceName, [&] {
+        cache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, handleDBusReply(QDBusReply<QString>(pending.deviceName), functionname));
+    });
+    finish(DeviceDescriptorCache::DeviceType, [&] {
+        cache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, translateDeviceType(handleDBusReply(QDBusReply<QString>(pending.deviceType), functionname)));
+    });
+    finish(DeviceDescriptorCache::FirmwareVersion, [&] {
+        cache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, handleDBusReply(QDBusReply<QString>(pending.firmwareVersion), functionname));
+    });
+    finish(DeviceDescriptorCache::KeyboardLayout, [&] {
+        cache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, translateKeyboardLayout(handleDBusReply(QDBusReply<QString>(pending.keyboardLayout), functionname)));
+    });
+    finish(DeviceDescriptorCache::DeviceImageUrl, [&] {
+        cache->store(DeviceDescriptorCache::DeviceImageUrl, &DeviceDescriptor::deviceImageUrl, parseDeviceImageUrl(handleDBusReply(QDBusReply<QString>(pending.razerUrls), functionname)));
+    });
+    finish(DeviceDescriptorCache::MatrixDimensions, [&] {
+        cache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, toMatrixDimensions(handleDBusReply(QDBusReply<QList<int>>(pending.matrixDimensions), functionname)));
+    });
+    finish(DeviceDescriptorCache::MaxDPI, [&] {
+        cache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, static_cast<ushort>(handleDBusReply(QDBusReply<int>(pending.maxDPI), functionname)));
+    });
+    finish(DeviceDescriptorCache::SupportedPollRates, [&] {
+        cache->store(DeviceDescriptorCache::SupportedPollRates, &DeviceDescriptor::supportedPollRates, handleDBusReply(QDBusReply<QVector<ushort>>(pending.supportedPollRates), functionname));
+    });
+    finish(DeviceDescriptorCache::AllowedDPI, [&] {
+        cache->store(DeviceDescriptorCache::AllowedDPI, &DeviceDescriptor::allowedDPI, toAllowedDPI(handleDBusReply(QDBusReply<QVector<int>>(pending.allowedDPI), functionname)));
+    });
+    if (error)
+        std::rethrow_exception(error);
+
+    DeviceDescriptor result = cache->descriptor();
+    // Not every device has getSupportedPollRates yet, use defaults in that case.
+    if (!hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getSupportedPollRates")))
+        result.supportedPollRates = { 125, 500, 1000 };
+    return result;
+}
+
+DeviceSnapshot Device::snapshot()
+{
+    return d->finishSnapshot(d->requestSnapshot());
+}
+
+DevicePrivate::PendingSnapshot DevicePrivate::requestSnapshot()
+{
+    // Send all calls before waiting for the first reply, so this only takes one round trip
+    PendingSnapshot pending;
+    if (features.testFlag(Device::Dpi))
+        pending.dpi = asyncCall("razer.device.dpi", "getDPI");
+    if (features.testFlag(Device::DpiStages))
+        pending.dpiStages = asyncCall("razer.device.dpi", "getDPIStages");
+    if (features.testFlag(Device::PollRate))
+        pending.pollRate = asyncCall("razer.device.misc", "getPollRate");
+    if (features.testFlag(Device::Battery)) {
+        pending.batteryPercent = asyncCall("razer.device.power", "getBattery");
+        pending.charging = asyncCall("razer.device.power", "isCharging");
     }
-    if (!ifaceLightingChroma->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    if (features.testFlag(Device::IdleTime))
+        pending.idleTime = asyncCall("razer.device.power", "getIdleTime");
+    if (features.testFlag(Device::LowBatteryThreshold))
+        pending.lowBatteryThreshold = asyncCall("razer.device.power", "getLowBatteryThreshold");
+    for (::libopenrazer::Led *led : leds)
+        pending.leds.append(static_cast<Led *>(led)->d->requestSnapshot());
+    return pending;
+}
+
+DeviceSnapshot DevicePrivate::finishSnapshot(const PendingSnapshot &pending)
+{
+    DeviceSnapshot snapshot;
+    if (features.testFlag(Device::Dpi))
+        snapshot.dpi = toDPI(handleDBusReply(QDBusReply<QList<int>>(pending.dpi), Q_FUNC_INFO));
+    if (features.testFlag(Device::DpiStages)) {
+        QPair<uchar, QVector<::openrazer::DPI>> stages = handleDBusReply(QDBusReply<QPair<uchar, QVector<::openrazer::DPI>>>(pending.dpiStages), Q_FUNC_INFO);
+        snapshot.activeDPIStage = stages.first;
+        snapshot.dpiStages = stages.second;
     }
-    return ifaceLightingChroma;
+    if (features.testFlag(Device::PollRate))
+        snapshot.pollRate = static_cast<ushort>(handleDBusReply(QDBusReply<int>(pending.pollRate), Q_FUNC_INFO));
+    if (features.testFlag(Device::Battery)) {
+        snapshot.batteryPercent = handleDBusReply(QDBusReply<double>(pending.batteryPercent), Q_FUNC_INFO);
+        snapshot.charging = handleDBusReply(QDBusReply<bool>(pending.charging), Q_FUNC_INFO);
+    }
+    if (features.testFlag(Device::IdleTime))
+        snapshot.idleTime = handleDBusReply(QDBusReply<ushort>(pending.idleTime), Q_FUNC_INFO);
+    if (features.testFlag(Device::LowBatteryThreshold))
+        snapshot.lowBatteryThreshold = handleDBusReply(QDBusReply<uchar>(pending.lowBatteryThreshold), Q_FUNC_INFO);
+    for (int i = 0; i < leds.size(); i++)
+        snapshot.leds.append(static_cast<Led *>(leds.at(i))->d->finishSnapshot(pending.leds.at(i)));
+    return snapshot;
+}
+
+void DevicePrivate::invalidateDescriptor()
+{
+    descriptorCache->invalidate();
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<QString> Device::getDeviceImageUrlAsync()
+{
+    QString deviceImageUrl;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceImageUrl, &DeviceDescriptor::deviceImageUrl, &deviceImageUrl))
+        return readyFuture(deviceImageUrl);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getRazerUrls"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::DeviceImageUrl, &DeviceDescriptor::deviceImageUrl, parseDeviceImageUrl(value));
+    });
+}
+
+QFuture<QString> Device::getDeviceModeAsync()
+{
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getDeviceMode"), Q_FUNC_INFO);
+}
+
+QFuture<QString> Device::getSerialAsync()
+{
+    QString serial;
+    if (d->descriptorCache->get(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, &serial))
+        return readyFuture(serial);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getSerial"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, value);
+    });
+}
+
+QFuture<QString> Device::getDeviceNameAsync()
+{
+    QString deviceName;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, &deviceName))
+        return readyFuture(deviceName);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getDeviceName"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, value);
+    });
+}
+
+QFuture<QString> Device::getDeviceTypeAsync()
+{
+    QString deviceType;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, &deviceType))
+        return readyFuture(deviceType);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getDeviceType"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, translateDeviceType(value));
+    });
+}
+
+QFuture<QString> Device::getFirmwareVersionAsync()
+{
+    QString firmwareVersion;
+    if (d->descriptorCache->get(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, &firmwareVersion))
+        return readyFuture(firmwareVersion);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getFirmware"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, value);
+    });
+}
+
+QFuture<QString> Device::getKeyboardLayoutAsync()
+{
+    QString keyboardLayout;
+    if (d->descriptorCache->get(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, &keyboardLayout))
+        return readyFuture(keyboardLayout);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.device.misc", "getKeyboardLayout"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, translateKeyboardLayout(value));
+    });
+}
+
+QFuture<ushort> Device::getPollRateAsync()
+{
+    return handleDBusPendingReply<int>(d->asyncCall("razer.device.misc", "getPollRate"), Q_FUNC_INFO, [](int value) {
+        return static_cast<ushort>(value);
+    });
+}
+
+QFuture<void> Device::setPollRateAsync(ushort pollrate)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.device.misc", "setPollRate", { QVariant::fromValue(pollrate) }), Q_FUNC_INFO);
+}
+
+QFuture<QVector<ushort>> Device::getSupportedPollRatesAsync()
+{
+    QVector<ushort> supportedPollRates;
+    if (d->descriptorCache->get(DeviceDescriptorCache::SupportedPollRates, &DeviceDescriptor::supportedPollRates, &supportedPollRates))
+        return readyFuture(supportedPollRates);
+    // Not every device has getSupportedPollRates yet, return defaults in that case.
+    if (!d->hasCapabilityInternal(QStringLiteral("razer.device.misc"), QStringLiteral("getSupportedPollRates")))
+        return readyFuture(QVector<ushort> { 125, 500, 1000 });
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QVector<ushort>>(d->asyncCall("razer.device.misc", "getSupportedPollRates"), Q_FUNC_INFO, [cache](const QVector<ushort> &value) {
+        return cache->store(DeviceDescriptorCache::SupportedPollRates, &DeviceDescriptor::supportedPollRates, value);
+    });
+}
+
+QFuture<void> Device::setDPIAsync(::openrazer::DPI dpi)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.device.dpi", "setDPI", { QVariant::fromValue(dpi.dpi_x), QVariant::fromValue(dpi.dpi_y) }), Q_FUNC_INFO);
+}
+
+QFuture<::openrazer::DPI> Device::getDPIAsync()
+{
+    return handleDBusPendingReply<QList<int>>(d->asyncCall("razer.device.dpi", "getDPI"), Q_FUNC_INFO, toDPI);
+}
+
+QFuture<void> Device::setDPIStagesAsync(uchar activeStage, QVector<::openrazer::DPI> dpiStages)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.device.dpi", "setDPIStages", { QVariant::fromValue(activeStage), QVariant::fromValue(dpiStages) }), Q_FUNC_INFO);
+}
+
+QFuture<QPair<uchar, QVector<::openrazer::DPI>>> Device::getDPIStagesAsync()
+{
+    return handleDBusPendingReply<QPair<uchar, QVector<::openrazer::DPI>>>(d->asyncCall("razer.device.dpi", "getDPIStages"), Q_FUNC_INFO);
+}
+
+QFuture<ushort> Device::maxDPIAsync()
+{
+    ushort maxDPI;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, &maxDPI))
+        return readyFuture(maxDPI);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<int>(d->asyncCall("razer.device.dpi", "maxDPI"), Q_FUNC_INFO, [cache](const int &value) {
+        return cache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, static_cast<ushort>(value));
+    });
+}
+
+QFuture<QVector<ushort>> Device::getAllowedDPIAsync()
+{
+    QVector<ushort> allowedDPI;
+    if (d->descriptorCache->get(DeviceDescriptorCache::AllowedDPI, &DeviceDescriptor::allowedDPI, &allowedDPI))
+        return readyFuture(allowedDPI);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QVector<int>>(d->asyncCall("razer.device.dpi", "availableDPI"), Q_FUNC_INFO, [cache](const QVector<int> &value) {
+        return cache->store(DeviceDescriptorCache::AllowedDPI, &DeviceDescriptor::allowedDPI, toAllowedDPI(value));
+    });
+}
+
+QFuture<double> Device::getBatteryPercentAsync()
+{
+    return handleDBusPendingReply<double>(d->asyncCall("razer.device.power", "getBattery"), Q_FUNC_INFO);
+}
+
+QFuture<bool> Device::isChargingAsync()
+{
+    return handleDBusPendingReply<bool>(d->asyncCall("razer.device.power", "isCharging"), Q_FUNC_INFO);
+}
+
+QFuture<ushort> Device::getIdleTimeAsync()
+{
+    return handleDBusPendingReply<ushort>(d->asyncCall("razer.device.power", "getIdleTime"), Q_FUNC_INFO);
+}
+
+QFuture<void> Device::setIdleTimeAsync(ushort idleTime)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.device.power", "setIdleTime", { QVariant::fromValue(idleTime) }), Q_FUNC_INFO);
+}
+
+QFuture<double> Device::getLowBatteryThresholdAsync()
+{
+    return handleDBusPendingReply<uchar>(d->asyncCall("razer.device.power", "getLowBatteryThreshold"), Q_FUNC_INFO, [](uchar value) {
+        return static_cast<double>(value);
+    });
+}
+
+QFuture<void> Device::setLowBatteryThresholdAsync(double threshold)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.device.power", "setLowBatteryThreshold", { QVariant::fromValue(static_cast<uchar>(threshold)) }), Q_FUNC_INFO);
+}
+
+QFuture<void> Device::displayCustomFrameAsync()
+{
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    AsyncCall call = d->asyncCall("razer.device.lighting.chroma", "setCustom");
+    d->watchFrameCall(call, start, true);
+    return handleDBusPendingReply<void>(call, Q_FUNC_INFO);
+}
+
+QFuture<void> Device::defineCustomFrameAsync(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData)
+{
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    QByteArray data = packCustomFrame(row, startColumn, endColumn, colorData);
+    qint64 packed = FrameStats::now();
+    d->frameStats->record(FrameStats::Pack, start, packed);
+    AsyncCall call = d->asyncCall("razer.device.lighting.chroma", "setKeyRow", { data });
+    d->watchFrameCall(call, packed, false);
+    return handleDBusPendingReply<void>(call, Q_FUNC_INFO);
+}
+
+QFuture<::openrazer::MatrixDimensions> Device::getMatrixDimensionsAsync()
+{
+    ::openrazer::MatrixDimensions matrixDimensions;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, &matrixDimensions))
+        return readyFuture(matrixDimensions);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QList<int>>(d->asyncCall("razer.device.misc", "getMatrixDimensions"), Q_FUNC_INFO, [cache](const QList<int> &value) {
+        return cache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, toMatrixDimensions(value));
+    });
+}
+
+QDBusMessage DevicePrivate::call(const QString &interface, const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), interface, method);
+    message.setArguments(arguments);
+    return dbusConnection().call(message);
+}
+
+AsyncCall DevicePrivate::asyncCall(const QString &interface, const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), interface, method);
+    message.setArguments(arguments);
+    return AsyncCall(dbusConnection(), message);
+}
+
+void DevicePrivate::invalidateLedEffects()
+{
+    for (::libopenrazer::Led *led : leds)
+        static_cast<Led *>(led)->d->state->invalidateEffect();
+}
+
+QDBusPendingCall DevicePrivate::frameCall(const AsyncCall &call, qint64 start)
+{
+    QDBusPendingCall pending = call.send();
+    const qint64 sent = call.sentAt();
+    frameStats->record(FrameStats::Marshal, start, sent);
+    pending.waitForFinished();
+    frameStats->record(FrameStats::DBusWait, sent, FrameStats::now());
+    return pending;
+}
+
+void DevicePrivate::watchFrameCall(const AsyncCall &call, qint64 start, bool endFrame)
+{
+    QSharedPointer<FrameStats> stats = frameStats;
+    watchPendingCall(call, [stats, call, start, endFrame](const QDBusPendingCall &) {
+        const qint64 sent = call.sentAt();
+        stats->record(FrameStats::Marshal, start, sent);
+        stats->record(FrameStats::DBusWait, sent, FrameStats::now());
+        // The frame is only shown once the daemon has replied
+        if (endFrame)
+            stats->endFrame();
+    });
 }
 
 }
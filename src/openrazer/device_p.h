@@ -5,39 +5,95 @@
 #ifndef OPENRAZER_DEVICE_P_H
 #define OPENRAZER_DEVICE_P_H
 
+#include "devicedescriptorcache_p.h"
 #include "libopenrazer/device.h"
 #include "libopenrazer/led.h"
+#include "libopenrazer_private.h"
+#include "led_p.h"
 
-#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusPendingReply>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
 
 namespace libopenrazer {
 
 namespace openrazer {
 
+// Introspection data of a device: interface name -> names of its methods, signals and properties.
+// A class rather than a typedef, so the private Device constructor can take it with a forward declaration.
+class DeviceIntrospection : public QHash<QString, QSet<QString>>
+{
+};
+
 class DevicePrivate
 {
 public:
     Device *mParent = nullptr;
 
-    QDBusInterface *ifaceMisc = nullptr;
-    QDBusInterface *ifaceDpi = nullptr;
-    QDBusInterface *ifacePower = nullptr;
-    QDBusInterface *ifaceLightingChroma = nullptr;
-    QDBusInterface *deviceMiscIface();
-    QDBusInterface *deviceDpiIface();
-    QDBusInterface *devicePowerIface();
-    QDBusInterface *deviceLightingChromaIface();
+    QDBusMessage call(const QString &interface, const QString &method, const QVariantList &arguments = QVariantList());
+    AsyncCall asyncCall(const QString &interface, const QString &method, const QVariantList &arguments = QVariantList());
 
     QDBusObjectPath mObjectPath;
 
-    QStringList supportedFeatures;
+    Device::Features features;
 
     QList<::libopenrazer::Led *> leds;
 
-    void introspect();
+    // Shared with the callbacks of async custom frame calls which can outlive the Device
+    QSharedPointer<FrameStats> frameStats { new FrameStats };
+    // Record the Marshal stage from start until the call has been sent and DBusWait until its reply
+    // has arrived. frameCall() waits for the reply, watchFrameCall() records once it arrives.
+    QDBusPendingCall frameCall(const AsyncCall &call, qint64 start);
+    void watchFrameCall(const AsyncCall &call, qint64 start, bool endFrame);
+    // Custom frames replace the effect of every LED, their state caches don't know the new one
+    void invalidateLedEffects();
+
+    // Immutable metadata, each field is fetched on first use
+    QSharedPointer<DeviceDescriptorCache> descriptorCache { new DeviceDescriptorCache };
+    DeviceDescriptor getDescriptor();
+    // Called when the device is removed or the daemon has stopped, the data may be different
+    // once it is back
+    void invalidateDescriptor();
+
+    // Descriptor calls that have been sent, but whose replies haven't been waited for yet. Only
+    // fields that aren't cached and whose capability the device has are requested.
+    struct PendingDescriptor {
+        bool requested[DeviceDescriptorCache::FieldCount] = {};
+        QDBusPendingReply<QString> serial;
+        QDBusPendingReply<QString> deviceName;
+        QDBusPendingReply<QString> deviceType;
+        QDBusPendingReply<QString> firmwareVersion;
+        QDBusPendingReply<QString> keyboardLayout;
+        QDBusPendingReply<QString> razerUrls;
+        QDBusPendingReply<QList<int>> matrixDimensions;
+        QDBusPendingReply<int> maxDPI;
+        QDBusPendingReply<QVector<ushort>> supportedPollRates;
+        QDBusPendingReply<QVector<int>> allowedDPI;
+    };
+    PendingDescriptor requestDescriptor();
+    DeviceDescriptor finishDescriptor(const PendingDescriptor &pending);
+
+    // Snapshot calls that have been sent, but whose replies haven't been waited for yet
+    struct PendingSnapshot {
+        QDBusPendingReply<QList<int>> dpi;
+        QDBusPendingReply<QPair<uchar, QVector<::openrazer::DPI>>> dpiStages;
+        QDBusPendingReply<int> pollRate;
+        QDBusPendingReply<double> batteryPercent;
+        QDBusPendingReply<bool> charging;
+        QDBusPendingReply<ushort> idleTime;
+        QDBusPendingReply<uchar> lowBatteryThreshold;
+        QList<LedPrivate::PendingSnapshot> leds;
+    };
+    PendingSnapshot requestSnapshot();
+    DeviceSnapshot finishSnapshot(const PendingSnapshot &pending);
+
+    static QDBusPendingCall introspect(const QDBusObjectPath &objectPath);
+    static DeviceIntrospection parseIntrospection(const QString &xml);
     void setupCapabilities();
     bool hasCapabilityInternal(const QString &interface, const QString &method = QString());
-    QStringList introspection;
+    DeviceIntrospection introspection;
 
     // Maps LedId to "Chroma" or "Scroll" (the string put e.g. into setScrollSpectrum)
     QMap<::openrazer::LedId, QString> supportedLeds;
@@ -0,0 +1,117 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "introspectioncache_p.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace libopenrazer {
+
+namespace openrazer {
+
+static const quint32 CacheMagic = 0x4c4f5243; // "LORC"
+static const quint32 CacheFormatVersion = 2;
+
+IntrospectionCache::IntrospectionCache()
+{
+    // $XDG_CACHE_HOME/libopenrazer on Linux
+    path = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/libopenrazer/introspection.cache";
+}
+
+IntrospectionCache *IntrospectionCache::instance()
+{
+    static IntrospectionCache cache;
+    return &cache;
+}
+
+QByteArray IntrospectionCache::hash(const QString &xml)
+{
+    return QCryptographicHash::hash(xml.toUtf8(), QCryptographicHash::Sha1);
+}
+
+bool IntrospectionCache::lookup(const QString &daemonVersion, const QString &serial, DeviceIntrospection *introspection, QByteArray *xmlHash)
+{
+    QMutexLocker locker(&mutex);
+    load();
+    QHash<QString, Entry>::const_iterator it = entries.constFind(serial);
+    if (it == entries.constEnd() || it->daemonVersion != daemonVersion)
+        return false;
+    *introspection = it->introspection;
+    *xmlHash = it->xmlHash;
+    return true;
+}
+
+void IntrospectionCache::insert(const QString &daemonVersion, const QString &serial, const QByteArray &xmlHash, const DeviceIntrospection &introspection)
+{
+    QMutexLocker locker(&mutex);
+    load();
+    Entry &entry = entries[serial];
+    if (entry.daemonVersion == daemonVersion && entry.xmlHash == xmlHash)
+        return;
+    entry.daemonVersion = daemonVersion;
+    entry.xmlHash = xmlHash;
+    entry.introspection = introspection;
+    dirty = true;
+}
+
+// Called with the mutex held
+void IntrospectionCache::load()
+{
+    if (loaded)
+        return;
+    loaded = true;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, formatVersion, count;
+    stream >> magic >> formatVersion >> count;
+    if (magic != CacheMagic || formatVersion != CacheFormatVersion)
+        return;
+
+    QHash<QString, Entry> read;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        QString serial;
+        Entry entry;
+        stream >> serial >> entry.daemonVersion >> entry.xmlHash >> entry.introspection;
+        read.insert(serial, entry);
+    }
+    // Ignore truncated or otherwise broken files, they get rewritten on the next save
+    if (stream.status() == QDataStream::Ok)
+        entries = read;
+}
+
+void IntrospectionCache::save()
+{
+    QMutexLocker locker(&mutex);
+    if (!dirty)
+        return;
+
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << CacheMagic << CacheFormatVersion << static_cast<quint32>(entries.size());
+    for (QHash<QString, Entry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it)
+        stream << it.key() << it->daemonVersion << it->xmlHash << it->introspection;
+    // QSaveFile only replaces the old file if everything was written
+    if (file.commit())
+        dirty = false;
+}
+
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef OPENRAZER_INTROSPECTIONCACHE_P_H
+#define OPENRAZER_INTROSPECTIONCACHE_P_H
+
+#include "device_p.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+namespace libopenrazer {
+
+namespace openrazer {
+
+// On-disk cache of the parsed device introspection data, so devices can be set up without introspecting them first.
+//
+// Entries are stored per device serial together with the daemon version they were created with and a hash of the
+// introspection data. Devices are set up from an entry as long as the version matches, the Manager then introspects
+// them in the background and replaces entries whose hash doesn't match anymore (e.g. after a firmware update or a
+// patched daemon without a version bump). All methods are thread-safe.
+class IntrospectionCache
+{
+public:
+    static IntrospectionCache *instance();
+
+    static QByteArray hash(const QString &xml);
+
+    // Sets introspection and xmlHash to the cached data of the device with serial and returns true, if there is an entry for daemonVersion
+    bool lookup(const QString &daemonVersion, const QString &serial, DeviceIntrospection *introspection, QByteArray *xmlHash);
+    void insert(const QString &daemonVersion, const QString &serial, const QByteArray &xmlHash, const DeviceIntrospection &introspection);
+
+    // Writes the cache file if anything changed since it was loaded
+    void save();
+
+private:
+    IntrospectionCache();
+    void load();
+
+    struct Entry {
+        QString daemonVersion;
+        QByteArray xmlHash;
+        DeviceIntrospection introspection;
+    };
+
+    QMutex mutex;
+    QString path;
+    bool loaded = false;
+    bool dirty = false;
+    QHash<QString, Entry> entries;
+};
+
+}
+
+}
+
+#endif // OPENRAZER_INTROSPECTIONCACHE_P_H
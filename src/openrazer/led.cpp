@@ -18,6 +18,68 @@ namespace libopenrazer {
 
 namespace openrazer {
 
+// Conversions of the daemon replies, shared by the blocking and the async calls
+
+static ::openrazer::Effect parseEffect(const QString &effect)
+{
+    // TODO:
+    // * breathTriple
+    // * starlightSingle
+    // * starlightDual
+    // * starlightRandom
+    if (effect == "none") {
+        return ::openrazer::Effect::Off;
+    } else if (effect == "on") {
+        return ::openrazer::Effect::On;
+    } else if (effect == "static") {
+        return ::openrazer::Effect::Static;
+    } else if (effect == "breathSingle" || effect == "pulsate") {
+        return ::openrazer::Effect::Breathing;
+    } else if (effect == "breathDual") {
+        return ::openrazer::Effect::BreathingDual;
+    } else if (effect == "breathRandom") {
+        return ::openrazer::Effect::BreathingRandom;
+    } else if (effect == "breathMono") {
+        return ::openrazer::Effect::BreathingMono;
+    } else if (effect == "blinking") {
+        return ::openrazer::Effect::Blinking;
+    } else if (effect == "spectrum") {
+        return ::openrazer::Effect::Spectrum;
+    } else if (effect == "wave") {
+        return ::openrazer::Effect::Wave;
+    } else if (effect == "wheel") {
+        return ::openrazer::Effect::Wheel;
+    } else if (effect == "reactive") {
+        return ::openrazer::Effect::Reactive;
+    } else if (effect == "ripple") {
+        return ::openrazer::Effect::Ripple;
+    } else if (effect == "rippleRandomColour") {
+        return ::openrazer::Effect::RippleRandom;
+    } else {
+        qWarning("libopenrazer: Unhandled effect in getCurrentEffect: %s, defaulting to Spectrum", qUtf8Printable(effect));
+        return ::openrazer::Effect::Spectrum;
+    }
+}
+
+static QVector<::openrazer::RGB> toColors(const QByteArray &values)
+{
+    if (values.size() % 3 != 0) {
+        throw DBusException("Invalid return array from EffectColors", "The EffectColors return array has an invalid size.");
+    }
+    QVector<::openrazer::RGB> colors;
+    for (int i = 0; i < values.size() / 3; i++) {
+        colors.append({ static_cast<uchar>(values[i * 3]),
+                        static_cast<uchar>(values[i * 3 + 1]),
+                        static_cast<uchar>(values[i * 3 + 2]) });
+    }
+    return colors;
+}
+
+static uchar toBrightness(double value)
+{
+    return value / 100 * 255;
+}
+
 Led::Led(Device *device, QDBusObjectPath objectPath, ::openrazer::LedId ledId, QString lightingLocation)
 {
     d = new LedPrivate();
@@ -25,19 +87,8 @@ Led::Led(Device *device, QDBusObjectPath objectPath, ::openrazer::LedId ledId, Q
     d->device = device;
     d->mObjectPath = objectPath;
     d->ledId = ledId;
-    d->lightingLocation = lightingLocation;
-
-    // Leave lightingLocationMethod empty in case it's Chroma
-    if (lightingLocation == "Chroma") {
-        d->interface = "razer.device.lighting.chroma";
-    } else if (d->isProfileLed()) {
-        d->lightingLocationMethod = lightingLocation;
-        d->interface = "razer.device.lighting.profile_led";
-    } else {
-        d->lightingLocationMethod = lightingLocation;
-        d->interface = "razer.device.lighting." + fromCamelCase(lightingLocation);
-    }
 
+    d->setupMethods(lightingLocation);
     d->setupCapabilities();
 }
 
@@ -46,61 +97,148 @@ Led::Led(Device *device, QDBusObjectPath objectPath, ::openrazer::LedId ledId, Q
  */
 Led::~Led() = default;
 
+namespace {
+
+struct LightingLocation {
+    const char *location;
+    const char *interface;
+};
+
+const LightingLocation lightingLocations[] = {
+    { "Chroma", "razer.device.lighting.chroma" },
+    { "Logo", "razer.device.lighting.logo" },
+    { "Scroll", "razer.device.lighting.scroll" },
+    { "Backlight", "razer.device.lighting.backlight" },
+    { "Left", "razer.device.lighting.left" },
+    { "Right", "razer.device.lighting.right" },
+    { "RedLED", "razer.device.lighting.profile_led" },
+    { "GreenLED", "razer.device.lighting.profile_led" },
+    { "BlueLED", "razer.device.lighting.profile_led" },
+    { "Charging", "razer.device.lighting.charging" },
+    { "FastCharging", "razer.device.lighting.fast_charging" },
+    { "FullyCharged", "razer.device.lighting.fully_charged" },
+};
+
+struct MethodName {
+    const char *prefix;
+    const char *suffix;
+};
+
+// Indexed by LedPrivate::MethodId up to LedPrivate::Bw2013Static, the method name is prefix + location + suffix
+const MethodName methodNames[] = {
+    { "set", "None" },
+    { "set", "On" },
+    { "set", "Static" },
+    { "set", "Blinking" },
+    { "set", "BreathSingle" },
+    { "set", "BreathDual" },
+    { "set", "BreathRandom" },
+    { "set", "BreathMono" },
+    { "set", "Spectrum" },
+    { "set", "Wave" },
+    { "set", "Wheel" },
+    { "set", "Reactive" },
+    { "set", "Active" },
+    { "get", "Active" },
+    { "set", "Brightness" },
+    { "get", "Brightness" },
+    { "get", "Effect" },
+    { "get", "EffectColors" },
+    { "get", "WaveDir" },
+};
+static_assert(sizeof(methodNames) / sizeof(methodNames[0]) == LedPrivate::Bw2013Static, "methodNames doesn't match LedPrivate::MethodId");
+
+}
+
+/**
+ * Resolves the interfaces and names of all methods the LED uses, so calls don't need to build any strings.
+ */
+void LedPrivate::setupMethods(const QString &lightingLocation)
+{
+    const bool isChroma = lightingLocation == QLatin1String("Chroma");
+
+    QString interface;
+    for (const LightingLocation &entry : lightingLocations) {
+        if (lightingLocation == QLatin1String(entry.location)) {
+            interface = QLatin1String(entry.interface);
+            break;
+        }
+    }
+    if (interface.isEmpty())
+        qWarning("libopenrazer: Unhandled lighting location %s", qUtf8Printable(lightingLocation));
+
+    // The method names of the Chroma LED don't contain the location
+    const QString location = isChroma ? QString() : lightingLocation;
+    for (int i = 0; i < Bw2013Static; i++) {
+        methods[i].interface = interface;
+        methods[i].name = QLatin1String(methodNames[i].prefix) + location + QLatin1String(methodNames[i].suffix);
+    }
+    if (isProfileLed()) {
+        methods[SetActive].name = "set" + location;
+        methods[GetActive].name = "get" + location;
+    }
+    if (isChroma) {
+        methods[SetBrightness].interface = "razer.device.lighting.brightness";
+        methods[GetBrightness].interface = "razer.device.lighting.brightness";
+    }
+    methods[Bw2013Static].interface = "razer.device.lighting.bw2013";
+    methods[Bw2013Static].name = "setStatic";
+    methods[Bw2013Pulsate].interface = "razer.device.lighting.bw2013";
+    methods[Bw2013Pulsate].name = "setPulsate";
+    methods[Ripple].interface = "razer.device.lighting.custom";
+    methods[Ripple].name = "setRipple";
+    methods[RippleRandom].interface = "razer.device.lighting.custom";
+    methods[RippleRandom].name = "setRippleRandomColour";
+
+    for (Method &method : methods)
+        method.available = device->d->hasCapabilityInternal(method.interface, method.name);
+}
+
 void LedPrivate::setupCapabilities()
 {
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "None"))
+    if (hasMethod(SetNone))
         supportedFx.append(::openrazer::Effect::Off);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "On"))
+    if (hasMethod(SetOn))
         supportedFx.append(::openrazer::Effect::On);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Static"))
+    if (hasMethod(SetStatic))
         supportedFx.append(::openrazer::Effect::Static);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Blinking"))
+    if (hasMethod(SetBlinking))
         supportedFx.append(::openrazer::Effect::Blinking);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "BreathSingle"))
+    if (hasMethod(SetBreathSingle))
         supportedFx.append(::openrazer::Effect::Breathing);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "BreathDual"))
+    if (hasMethod(SetBreathDual))
         supportedFx.append(::openrazer::Effect::BreathingDual);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "BreathRandom"))
+    if (hasMethod(SetBreathRandom))
         supportedFx.append(::openrazer::Effect::BreathingRandom);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "BreathMono"))
+    if (hasMethod(SetBreathMono))
         supportedFx.append(::openrazer::Effect::BreathingMono);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Spectrum"))
+    if (hasMethod(SetSpectrum))
         supportedFx.append(::openrazer::Effect::Spectrum);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Wave"))
+    if (hasMethod(SetWave))
         supportedFx.append(::openrazer::Effect::Wave);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Wheel"))
+    if (hasMethod(SetWheel))
         supportedFx.append(::openrazer::Effect::Wheel);
-    if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Reactive"))
+    if (hasMethod(SetReactive))
         supportedFx.append(::openrazer::Effect::Reactive);
 
-    if (supportedFx.isEmpty() && device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Active")) {
-        supportedFx.append(::openrazer::Effect::Off);
-        supportedFx.append(::openrazer::Effect::On);
-    }
-
-    if (device->d->hasCapabilityInternal("razer.device.lighting.profile_led", "set" + lightingLocationMethod)) {
+    // Profile LEDs only have on/off
+    if (hasMethod(SetActive) && (supportedFx.isEmpty() || isProfileLed())) {
         supportedFx.append(::openrazer::Effect::Off);
         supportedFx.append(::openrazer::Effect::On);
     }
 
     // No-color static/breathing variants
-    if (device->d->hasCapabilityInternal("razer.device.lighting.bw2013", "setStatic"))
+    if (hasMethod(Bw2013Static))
         supportedFx.append(::openrazer::Effect::Static);
-    if (device->d->hasCapabilityInternal("razer.device.lighting.bw2013", "setPulsate"))
+    if (hasMethod(Bw2013Pulsate))
         supportedFx.append(::openrazer::Effect::Breathing);
 
-    if (device->d->hasCapabilityInternal("razer.device.lighting.custom", "setRipple"))
+    if (hasMethod(Ripple))
         supportedFx.append(::openrazer::Effect::Ripple);
-    if (device->d->hasCapabilityInternal("razer.device.lighting.custom", "setRippleRandomColour"))
+    if (hasMethod(RippleRandom))
         supportedFx.append(::openrazer::Effect::RippleRandom);
 
-    if (lightingLocation == "Chroma") {
-        if (device->d->hasCapabilityInternal("razer.device.lighting.brightness", "setBrightness"))
-            supportsBrightness = true;
-    } else {
-        if (device->d->hasCapabilityInternal(interface, "set" + lightingLocationMethod + "Brightness"))
-            supportsBrightness = true;
-    }
+    supportsBrightness = hasMethod(SetBrightness);
 }
 
 QDBusObjectPath Led::getObjectPath()
@@ -108,6 +246,11 @@ QDBusObjectPath Led::getObjectPath()
     return d->mObjectPath;
 }
 
+::libopenrazer::Device *Led::getDevice()
+{
+    return d->device;
+}
+
 bool Led::hasBrightness()
 {
     return d->supportsBrightness;
@@ -125,59 +268,25 @@ bool Led::hasFx(::openrazer::Effect fx)
         return ::openrazer::Effect::Off;
     }
 
+    ::openrazer::Effect effect;
+    if (d->state->effect(&effect))
+        return effect;
+    quint64 generation = d->state->generation();
+
     // Devices with On/Off effects need special handling, except for when
     // openrazer already supports the "On" effect. Then we can treat it
     // standard.
     if (hasFx(::openrazer::Effect::On) &&
-            !d->device->d->hasCapabilityInternal(d->interface, "set" + d->lightingLocationMethod + "On")) {
-        QDBusReply<bool> reply;
-        if (d->isProfileLed())
-            reply = d->ledIface()->call("get" + d->lightingLocationMethod);
-        else
-            reply = d->ledIface()->call("get" + d->lightingLocationMethod + "Active");
+            !d->hasMethod(LedPrivate::SetOn)) {
+        QDBusReply<bool> reply = d->call(LedPrivate::GetActive);
         bool on = handleDBusReply(reply, Q_FUNC_INFO);
-        return on ? ::openrazer::Effect::On : ::openrazer::Effect::Off;
-    }
-
-    QDBusReply<QString> reply = d->ledIface()->call("get" + d->lightingLocationMethod + "Effect");
-    QString effect = handleDBusReply(reply, Q_FUNC_INFO);
-    // TODO:
-    // * breathTriple
-    // * starlightSingle
-    // * starlightDual
-    // * starlightRandom
-    if (effect == "none") {
-        return ::openrazer::Effect::Off;
-    } else if (effect == "on") {
-        return ::openrazer::Effect::On;
-    } else if (effect == "static") {
-        return ::openrazer::Effect::Static;
-    } else if (effect == "breathSingle" || effect == "pulsate") {
-        return ::openrazer::Effect::Breathing;
-    } else if (effect == "breathDual") {
-        return ::openrazer::Effect::BreathingDual;
-    } else if (effect == "breathRandom") {
-        return ::openrazer::Effect::BreathingRandom;
-    } else if (effect == "breathMono") {
-        return ::openrazer::Effect::BreathingMono;
-    } else if (effect == "blinking") {
-        return ::openrazer::Effect::Blinking;
-    } else if (effect == "spectrum") {
-        return ::openrazer::Effect::Spectrum;
-    } else if (effect == "wave") {
-        return ::openrazer::Effect::Wave;
-    } else if (effect == "wheel") {
-        return ::openrazer::Effect::Wheel;
-    } else if (effect == "reactive") {
-        return ::openrazer::Effect::Reactive;
-    } else if (effect == "ripple") {
-        return ::openrazer::Effect::Ripple;
-    } else if (effect == "rippleRandomColour") {
-        return ::openrazer::Effect::RippleRandom;
+        effect = on ? ::openrazer::Effect::On : ::openrazer::Effect::Off;
     } else {
-        qWarning("libopenrazer: Unhandled effect in getCurrentEffect: %s, defaulting to Spectrum", qUtf8Printable(effect));
-        return ::openrazer::Effect::Spectrum;
+        QDBusReply<QString> reply = d->call(LedPrivate::GetEffect);
+        effect = parseEffect(handleDBusReply(reply, Q_FUNC_INFO));
     }
+    d->state->storeEffect(effect, generation);
+    return effect;
 }
 
 QVector<::openrazer::RGB> Led::getCurrentColors()
@@ -188,17 +297,14 @@ QVector<::openrazer::RGB> Led::getCurrentColors()
         return {};
     }
 
-    QDBusReply<QByteArray> reply = d->ledIface()->call("get" + d->lightingLocationMethod + "EffectColors");
-    QByteArray values = handleDBusReply(reply, Q_FUNC_INFO);
-    if (values.size() % 3 != 0) {
-        throw DBusException("Invalid return array from EffectColors", "The EffectColors return array has an invalid size.");
-    }
     QVector<::openrazer::RGB> colors;
-    for (int i = 0; i < values.size() / 3; i++) {
-        colors.append({ static_cast<uchar>(values[i * 3]),
-                        static_cast<uchar>(values[i * 3 + 1]),
-                        static_cast<uchar>(values[i * 3 + 2]) });
-    }
+    if (d->state->colors(&colors))
+        return colors;
+    quint64 generation = d->state->generation();
+    QDBusReply<QByteArray> reply = d->call(LedPrivate::GetEffectColors);
+    QByteArray values = handleDBusReply(reply, Q_FUNC_INFO);
+    colors = toColors(values);
+    d->state->storeColors(colors, generation);
     return colors;
 }
 
@@ -210,9 +316,15 @@ QVector<::openrazer::RGB> Led::getCurrentColors()
         return ::openrazer::WaveDirection::LEFT_TO_RIGHT;
     }
 
-    QDBusReply<int> reply = d->ledIface()->call("get" + d->lightingLocationMethod + "WaveDir");
+    ::openrazer::WaveDirection direction;
+    if (d->state->waveDirection(&direction))
+        return direction;
+    quint64 generation = d->state->generation();
+    QDBusReply<int> reply = d->call(LedPrivate::GetWaveDir);
     int value = handleDBusReply(reply, Q_FUNC_INFO);
-    return static_cast<::openrazer::WaveDirection>(value);
+    direction = static_cast<::openrazer::WaveDirection>(value);
+    d->state->storeWaveDirection(direction, generation);
+    return direction;
 }
 
 ::openrazer::LedId Led::getLedId()
@@ -222,193 +334,400 @@ QVector<::openrazer::RGB> Led::getCurrentColors()
 
 void Led::setOff()
 {
-    QDBusReply<void> reply;
-    if (d->isProfileLed())
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod, false);
-    else if (d->device->d->hasCapabilityInternal(d->interface, "set" + d->lightingLocationMethod + "Active"))
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Active", false);
+    LedStateCache::EffectWrite write = LedStateCache::effectWrite(::openrazer::Effect::Off);
+    if (d->hasMethod(LedPrivate::SetActive))
+        d->write(write, LedPrivate::SetActive, { false }, Q_FUNC_INFO);
     else
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "None");
-    handleDBusReply(reply, Q_FUNC_INFO);
+        d->write(write, LedPrivate::SetNone, {}, Q_FUNC_INFO);
 }
 
 void Led::setOn()
 {
-    QDBusReply<void> reply;
-    if (d->isProfileLed())
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod, true);
-    else if (d->device->d->hasCapabilityInternal(d->interface, "set" + d->lightingLocationMethod + "Active"))
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Active", true);
+    LedStateCache::EffectWrite write = LedStateCache::effectWrite(::openrazer::Effect::On);
+    if (d->hasMethod(LedPrivate::SetActive))
+        d->write(write, LedPrivate::SetActive, { true }, Q_FUNC_INFO);
     else
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "On");
-    handleDBusReply(reply, Q_FUNC_INFO);
+        d->write(write, LedPrivate::SetOn, {}, Q_FUNC_INFO);
 }
 
 void Led::setStatic(::openrazer::RGB color)
 {
-    QDBusReply<void> reply;
-    if (d->device->d->hasCapabilityInternal("razer.device.lighting.bw2013", "setStatic"))
-        reply = d->ledBw2013Iface()->call("setStatic");
+    // The bw2013 variant has a fixed color
+    if (d->hasMethod(LedPrivate::Bw2013Static))
+        d->write(LedStateCache::effectWrite(::openrazer::Effect::Static), LedPrivate::Bw2013Static, {}, Q_FUNC_INFO);
     else
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Static", RGB_TO_QVARIANT(color));
-    handleDBusReply(reply, Q_FUNC_INFO);
+        d->write(LedStateCache::effectWrite(::openrazer::Effect::Static, { color }), LedPrivate::SetStatic, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathing(::openrazer::RGB color)
 {
-    QDBusReply<void> reply;
-    if (d->device->d->hasCapabilityInternal("razer.device.lighting.bw2013", "setPulsate"))
-        reply = d->ledBw2013Iface()->call("setPulsate");
+    if (d->hasMethod(LedPrivate::Bw2013Pulsate))
+        d->write(LedStateCache::effectWrite(::openrazer::Effect::Breathing), LedPrivate::Bw2013Pulsate, {}, Q_FUNC_INFO);
     else
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "BreathSingle", RGB_TO_QVARIANT(color));
-    handleDBusReply(reply, Q_FUNC_INFO);
+        d->write(LedStateCache::effectWrite(::openrazer::Effect::Breathing, { color }), LedPrivate::SetBreathSingle, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathingDual(::openrazer::RGB color, ::openrazer::RGB color2)
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "BreathDual", RGB_TO_QVARIANT(color), RGB_TO_QVARIANT(color2));
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::BreathingDual, { color, color2 }), LedPrivate::SetBreathDual, { RGB_TO_QVARIANT(color), RGB_TO_QVARIANT(color2) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathingRandom()
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "BreathRandom");
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::BreathingRandom), LedPrivate::SetBreathRandom, {}, Q_FUNC_INFO);
 }
 
 void Led::setBreathingMono()
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "BreathMono");
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::BreathingMono), LedPrivate::SetBreathMono, {}, Q_FUNC_INFO);
 }
 
 void Led::setBlinking(::openrazer::RGB color)
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Blinking", RGB_TO_QVARIANT(color));
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Blinking, { color }), LedPrivate::SetBlinking, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
 }
 
 void Led::setSpectrum()
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Spectrum");
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Spectrum), LedPrivate::SetSpectrum, {}, Q_FUNC_INFO);
 }
 
 void Led::setWave(::openrazer::WaveDirection direction)
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Wave", static_cast<int>(direction));
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Wave, {}, static_cast<int>(direction)), LedPrivate::SetWave, { static_cast<int>(direction) }, Q_FUNC_INFO);
 }
 
 void Led::setWheel(::openrazer::WheelDirection direction)
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Wheel", static_cast<int>(direction));
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Wheel, {}, static_cast<int>(direction)), LedPrivate::SetWheel, { static_cast<int>(direction) }, Q_FUNC_INFO);
 }
 
 void Led::setReactive(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed)
 {
-    QDBusReply<void> reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Reactive", RGB_TO_QVARIANT(color), static_cast<uchar>(speed));
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Reactive, { color }, static_cast<int>(speed)), LedPrivate::SetReactive, { RGB_TO_QVARIANT(color), QVariant::fromValue(static_cast<uchar>(speed)) }, Q_FUNC_INFO);
 }
 
 void Led::setRipple(::openrazer::RGB color)
 {
-    QDBusReply<void> reply = d->ledCustomIface()->call("setRipple", RGB_TO_QVARIANT(color), 0.05);
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Ripple, { color }), LedPrivate::Ripple, { RGB_TO_QVARIANT(color), 0.05 }, Q_FUNC_INFO);
 }
 
 void Led::setRippleRandom()
 {
-    QDBusReply<void> reply = d->ledCustomIface()->call("setRippleRandomColour", 0.05);
-    handleDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::RippleRandom), LedPrivate::RippleRandom, { 0.05 }, Q_FUNC_INFO);
 }
 
 void Led::setBrightness(uchar brightness)
 {
+    quint64 generation;
+    if (!d->state->beginWrite(brightness, &generation))
+        return;
     double dbusBrightness = (double)brightness / 255 * 100;
-    QDBusReply<void> reply;
-    if (d->lightingLocation == "Chroma")
-        reply = d->ledBrightnessIface()->call("setBrightness", QVariant::fromValue(dbusBrightness));
-    else
-        reply = d->ledIface()->call("set" + d->lightingLocationMethod + "Brightness", QVariant::fromValue(dbusBrightness));
+    QDBusReply<void> reply = d->call(LedPrivate::SetBrightness, { QVariant::fromValue(dbusBrightness) });
     handleDBusReply(reply, Q_FUNC_INFO);
+    d->state->written(brightness, generation);
 }
 
 uchar Led::getBrightness()
 {
-    QDBusReply<double> reply;
-    if (d->lightingLocation == "Chroma")
-        reply = d->ledBrightnessIface()->call("getBrightness");
-    else
-        reply = d->ledIface()->call("get" + d->lightingLocationMethod + "Brightness");
-
+    uchar brightness;
+    if (d->state->brightness(&brightness))
+        return brightness;
+    quint64 generation = d->state->brightnessGeneration();
+    QDBusReply<double> reply = d->call(LedPrivate::GetBrightness);
     double value = handleDBusReply(reply, Q_FUNC_INFO);
-    return value / 100 * 255;
+    brightness = toBrightness(value);
+    d->state->storeBrightness(brightness, generation);
+    return brightness;
 }
 
-bool LedPrivate::hasFx()
+void Led::setStateCacheEnabled(bool enabled)
 {
-    return !supportedFx.isEmpty();
+    d->state->setEnabled(enabled);
 }
 
-bool LedPrivate::isProfileLed()
+bool Led::isStateCacheEnabled()
 {
-    return ledId == ::openrazer::LedId::KeymapRedLED
-            || ledId == ::openrazer::LedId::KeymapGreenLED
-            || ledId == ::openrazer::LedId::KeymapBlueLED;
+    return d->state->isEnabled();
 }
 
-QDBusInterface *LedPrivate::ledIface()
+quint64 Led::suppressedWrites()
 {
-    if (iface == nullptr) {
-        iface = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), interface,
-                                   OPENRAZER_DBUS_BUS, mParent);
+    return d->state->suppressedWrites();
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<::openrazer::Effect> Led::getCurrentEffectAsync()
+{
+    // OpenRazer doesn't expose get*Effect when there's no effect supported.
+    if (!d->hasFx()) {
+        return readyFuture(::openrazer::Effect::Off);
     }
-    if (!iface->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+
+    ::openrazer::Effect effect;
+    if (d->state->effect(&effect))
+        return readyFuture(effect);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->generation();
+
+    // Devices with On/Off effects need special handling, see getCurrentEffect()
+    if (hasFx(::openrazer::Effect::On) &&
+            !d->hasMethod(LedPrivate::SetOn)) {
+        return handleDBusPendingReply<bool>(d->asyncCall(LedPrivate::GetActive), Q_FUNC_INFO, [state, generation](bool on) {
+            ::openrazer::Effect effect = on ? ::openrazer::Effect::On : ::openrazer::Effect::Off;
+            state->storeEffect(effect, generation);
+            return effect;
+        });
     }
-    return iface;
+
+    return handleDBusPendingReply<QString>(d->asyncCall(LedPrivate::GetEffect), Q_FUNC_INFO, [state, generation](const QString &value) {
+        ::openrazer::Effect effect = parseEffect(value);
+        state->storeEffect(effect, generation);
+        return effect;
+    });
 }
 
-QDBusInterface *LedPrivate::ledBrightnessIface()
+QFuture<QVector<::openrazer::RGB>> Led::getCurrentColorsAsync()
 {
-    if (ifaceBrightness == nullptr) {
-        ifaceBrightness = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.lighting.brightness",
-                                             OPENRAZER_DBUS_BUS, mParent);
+    if (!d->hasFx() || d->isProfileLed()) {
+        return readyFuture(QVector<::openrazer::RGB>());
     }
-    if (!ifaceBrightness->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+
+    QVector<::openrazer::RGB> colors;
+    if (d->state->colors(&colors))
+        return readyFuture(colors);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->generation();
+    return handleDBusPendingReply<QByteArray>(d->asyncCall(LedPrivate::GetEffectColors), Q_FUNC_INFO, [state, generation](const QByteArray &values) {
+        QVector<::openrazer::RGB> colors = toColors(values);
+        state->storeColors(colors, generation);
+        return colors;
+    });
+}
+
+QFuture<::openrazer::WaveDirection> Led::getWaveDirectionAsync()
+{
+    if (!d->hasFx() || d->isProfileLed()) {
+        return readyFuture(::openrazer::WaveDirection::LEFT_TO_RIGHT);
     }
-    return ifaceBrightness;
+
+    ::openrazer::WaveDirection direction;
+    if (d->state->waveDirection(&direction))
+        return readyFuture(direction);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->generation();
+    return handleDBusPendingReply<int>(d->asyncCall(LedPrivate::GetWaveDir), Q_FUNC_INFO, [state, generation](int value) {
+        auto direction = static_cast<::openrazer::WaveDirection>(value);
+        state->storeWaveDirection(direction, generation);
+        return direction;
+    });
 }
 
-QDBusInterface *LedPrivate::ledBw2013Iface()
+QFuture<::openrazer::LedId> Led::getLedIdAsync()
 {
-    if (ifaceBw2013 == nullptr) {
-        ifaceBw2013 = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.lighting.bw2013",
-                                         OPENRAZER_DBUS_BUS, mParent);
-    }
-    if (!ifaceBw2013->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    return readyFuture(d->ledId);
+}
+
+QFuture<void> Led::setOffAsync()
+{
+    LedStateCache::EffectWrite write = LedStateCache::effectWrite(::openrazer::Effect::Off);
+    if (d->hasMethod(LedPrivate::SetActive))
+        return d->asyncWrite(write, LedPrivate::SetActive, { false }, Q_FUNC_INFO);
+    else
+        return d->asyncWrite(write, LedPrivate::SetNone, {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setOnAsync()
+{
+    LedStateCache::EffectWrite write = LedStateCache::effectWrite(::openrazer::Effect::On);
+    if (d->hasMethod(LedPrivate::SetActive))
+        return d->asyncWrite(write, LedPrivate::SetActive, { true }, Q_FUNC_INFO);
+    else
+        return d->asyncWrite(write, LedPrivate::SetOn, {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setStaticAsync(::openrazer::RGB color)
+{
+    if (d->hasMethod(LedPrivate::Bw2013Static))
+        return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Static), LedPrivate::Bw2013Static, {}, Q_FUNC_INFO);
+    else
+        return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Static, { color }), LedPrivate::SetStatic, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingAsync(::openrazer::RGB color)
+{
+    if (d->hasMethod(LedPrivate::Bw2013Pulsate))
+        return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Breathing), LedPrivate::Bw2013Pulsate, {}, Q_FUNC_INFO);
+    else
+        return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Breathing, { color }), LedPrivate::SetBreathSingle, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingDualAsync(::openrazer::RGB color, ::openrazer::RGB color2)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::BreathingDual, { color, color2 }), LedPrivate::SetBreathDual, { RGB_TO_QVARIANT(color), RGB_TO_QVARIANT(color2) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingRandomAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::BreathingRandom), LedPrivate::SetBreathRandom, {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingMonoAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::BreathingMono), LedPrivate::SetBreathMono, {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBlinkingAsync(::openrazer::RGB color)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Blinking, { color }), LedPrivate::SetBlinking, { RGB_TO_QVARIANT(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setSpectrumAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Spectrum), LedPrivate::SetSpectrum, {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setWaveAsync(::openrazer::WaveDirection direction)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Wave, {}, static_cast<int>(direction)), LedPrivate::SetWave, { static_cast<int>(direction) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setWheelAsync(::openrazer::WheelDirection direction)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Wheel, {}, static_cast<int>(direction)), LedPrivate::SetWheel, { static_cast<int>(direction) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setReactiveAsync(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Reactive, { color }, static_cast<int>(speed)), LedPrivate::SetReactive, { RGB_TO_QVARIANT(color), QVariant::fromValue(static_cast<uchar>(speed)) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setRippleAsync(::openrazer::RGB color)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Ripple, { color }), LedPrivate::Ripple, { RGB_TO_QVARIANT(color), 0.05 }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setRippleRandomAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::RippleRandom), LedPrivate::RippleRandom, { 0.05 }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBrightnessAsync(uchar brightness)
+{
+    quint64 generation;
+    if (!d->state->beginWrite(brightness, &generation))
+        return readyFuture();
+    double dbusBrightness = (double)brightness / 255 * 100;
+    AsyncCall call = d->asyncCall(LedPrivate::SetBrightness, { QVariant::fromValue(dbusBrightness) });
+    LedStateCache::watchWrite(d->state, call, brightness, generation);
+    return handleDBusPendingReply<void>(call, Q_FUNC_INFO);
+}
+
+QFuture<uchar> Led::getBrightnessAsync()
+{
+    uchar brightness;
+    if (d->state->brightness(&brightness))
+        return readyFuture(brightness);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->brightnessGeneration();
+    return handleDBusPendingReply<double>(d->asyncCall(LedPrivate::GetBrightness), Q_FUNC_INFO, [state, generation](double value) {
+        uchar brightness = toBrightness(value);
+        state->storeBrightness(brightness, generation);
+        return brightness;
+    });
+}
+
+LedPrivate::PendingSnapshot LedPrivate::requestSnapshot()
+{
+    // Same conditions as in getCurrentEffect(), getCurrentColors(), getWaveDirection() and getBrightness()
+    PendingSnapshot pending;
+    pending.hasEffect = hasFx();
+    pending.onOff = supportedFx.contains(::openrazer::Effect::On) && !hasMethod(SetOn);
+    pending.hasColors = hasFx() && !isProfileLed();
+    pending.hasBrightness = supportsBrightness;
+
+    if (pending.hasEffect && pending.onOff)
+        pending.active = asyncCall(GetActive);
+    else if (pending.hasEffect)
+        pending.effect = asyncCall(GetEffect);
+    if (pending.hasColors) {
+        pending.colors = asyncCall(GetEffectColors);
+        pending.waveDirection = asyncCall(GetWaveDir);
     }
-    return ifaceBw2013;
+    if (pending.hasBrightness)
+        pending.brightness = asyncCall(GetBrightness);
+    return pending;
 }
 
-QDBusInterface *LedPrivate::ledCustomIface()
+LedSnapshot LedPrivate::finishSnapshot(const PendingSnapshot &pending)
 {
-    if (ifaceCustom == nullptr) {
-        ifaceCustom = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "razer.device.lighting.custom",
-                                         OPENRAZER_DBUS_BUS, mParent);
+    LedSnapshot snapshot;
+    snapshot.ledId = ledId;
+    if (pending.hasEffect && pending.onOff) {
+        bool on = handleDBusReply(QDBusReply<bool>(pending.active), Q_FUNC_INFO);
+        snapshot.effect = on ? ::openrazer::Effect::On : ::openrazer::Effect::Off;
+    } else if (pending.hasEffect) {
+        snapshot.effect = parseEffect(handleDBusReply(QDBusReply<QString>(pending.effect), Q_FUNC_INFO));
     }
-    if (!ifaceCustom->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    if (pending.hasColors) {
+        snapshot.colors = toColors(handleDBusReply(QDBusReply<QByteArray>(pending.colors), Q_FUNC_INFO));
+        snapshot.waveDirection = static_cast<::openrazer::WaveDirection>(handleDBusReply(QDBusReply<int>(pending.waveDirection), Q_FUNC_INFO));
     }
-    return ifaceCustom;
+    if (pending.hasBrightness)
+        snapshot.brightness = toBrightness(handleDBusReply(QDBusReply<double>(pending.brightness), Q_FUNC_INFO));
+    return snapshot;
+}
+
+void LedPrivate::write(const LedStateCache::EffectWrite &write, MethodId method, const QVariantList &arguments, const char *functionname)
+{
+    quint64 generation;
+    if (!state->beginWrite(write, &generation))
+        return;
+    QDBusReply<void> reply = call(method, arguments);
+    handleDBusReply(reply, functionname);
+    state->written(write, generation);
+}
+
+QFuture<void> LedPrivate::asyncWrite(const LedStateCache::EffectWrite &write, MethodId method, const QVariantList &arguments, const char *functionname)
+{
+    quint64 generation;
+    if (!state->beginWrite(write, &generation))
+        return readyFuture();
+    AsyncCall pending = asyncCall(method, arguments);
+    LedStateCache::watchWrite(state, pending, write, generation);
+    return handleDBusPendingReply<void>(pending, functionname);
+}
+
+bool LedPrivate::hasFx()
+{
+    return !supportedFx.isEmpty();
+}
+
+bool LedPrivate::isProfileLed()
+{
+    return ledId == ::openrazer::LedId::KeymapRedLED
+            || ledId == ::openrazer::LedId::KeymapGreenLED
+            || ledId == ::openrazer::LedId::KeymapBlueLED;
+}
+
+bool LedPrivate::hasMethod(MethodId method) const
+{
+    return methods[method].available;
+}
+
+QDBusMessage LedPrivate::call(MethodId method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), methods[method].interface, methods[method].name);
+    message.setArguments(arguments);
+    return dbusConnection().call(message);
+}
+
+AsyncCall LedPrivate::asyncCall(MethodId method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), methods[method].interface, methods[method].name);
+    message.setArguments(arguments);
+    return AsyncCall(dbusConnection(), message);
 }
 
 }
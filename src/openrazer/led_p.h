@@ -5,9 +5,12 @@
 #ifndef OPENRAZER_LED_P_H
 #define OPENRAZER_LED_P_H
 
+#include "ledstatecache_p.h"
 #include "libopenrazer/led.h"
+#include "libopenrazer_private.h"
 
-#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusPendingReply>
 
 namespace libopenrazer {
 
@@ -18,14 +21,51 @@ class LedPrivate
 public:
     Led *mParent = nullptr;
 
-    QDBusInterface *iface = nullptr;
-    QDBusInterface *ifaceBrightness = nullptr;
-    QDBusInterface *ifaceBw2013 = nullptr;
-    QDBusInterface *ifaceCustom = nullptr;
-    QDBusInterface *ledIface();
-    QDBusInterface *ledBrightnessIface();
-    QDBusInterface *ledBw2013Iface();
-    QDBusInterface *ledCustomIface();
+    // D-Bus methods used by the LED, resolved once on construction
+    enum MethodId {
+        SetNone,
+        SetOn,
+        SetStatic,
+        SetBlinking,
+        SetBreathSingle,
+        SetBreathDual,
+        SetBreathRandom,
+        SetBreathMono,
+        SetSpectrum,
+        SetWave,
+        SetWheel,
+        SetReactive,
+        // set<Location>Active, or set<Location> for profile LEDs
+        SetActive,
+        GetActive,
+        SetBrightness,
+        GetBrightness,
+        GetEffect,
+        GetEffectColors,
+        GetWaveDir,
+        // Methods not specific to the lighting location
+        Bw2013Static,
+        Bw2013Pulsate,
+        Ripple,
+        RippleRandom,
+        MethodCount
+    };
+    struct Method {
+        QString interface;
+        QString name;
+        bool available = false;
+    };
+    Method methods[MethodCount];
+
+    QDBusMessage call(MethodId method, const QVariantList &arguments = QVariantList());
+    AsyncCall asyncCall(MethodId method, const QVariantList &arguments = QVariantList());
+    bool hasMethod(MethodId method) const;
+
+    // Last known state, shared with the callbacks of async calls which can outlive the Led
+    QSharedPointer<LedStateCache> state { new LedStateCache };
+    // Setters go through the state cache, identical writes are skipped
+    void write(const LedStateCache::EffectWrite &write, MethodId method, const QVariantList &arguments, const char *functionname);
+    QFuture<void> asyncWrite(const LedStateCache::EffectWrite &write, MethodId method, const QVariantList &arguments, const char *functionname);
 
     Device *device;
     QDBusObjectPath mObjectPath;
@@ -34,13 +74,26 @@ public:
     bool supportsBrightness;
 
     ::openrazer::LedId ledId;
-    QString lightingLocation;
-    QString lightingLocationMethod;
-    QString interface;
 
     bool hasFx();
     bool isProfileLed();
+    void setupMethods(const QString &lightingLocation);
     void setupCapabilities();
+
+    // Snapshot calls that have been sent, but whose replies haven't been waited for yet
+    struct PendingSnapshot {
+        bool hasEffect = false;
+        bool onOff = false;
+        bool hasColors = false;
+        bool hasBrightness = false;
+        QDBusPendingReply<QString> effect;
+        QDBusPendingReply<bool> active;
+        QDBusPendingReply<QByteArray> colors;
+        QDBusPendingReply<int> waveDirection;
+        QDBusPendingReply<double> brightness;
+    };
+    PendingSnapshot requestSnapshot();
+    LedSnapshot finishSnapshot(const PendingSnapshot &pending);
 };
 
 }
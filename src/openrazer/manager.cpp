@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include "device_p.h"
+#include "introspectioncache_p.h"
 #include "libopenrazer.h"
 #include "libopenrazer_private.h"
 #include "manager_p.h"
@@ -17,31 +19,51 @@ namespace libopenrazer {
 
 namespace openrazer {
 
+const char *OPENRAZER_SERVICE_NAME = "org.razer";
+
+QDBusConnection dbusConnection()
+{
+    static const QDBusConnection connection = IoThread::isEnabled()
+            ? QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("libopenrazer-openrazer"))
+            : QDBusConnection::sessionBus();
+    return connection;
+}
+
 Manager::Manager()
 {
     d = new ManagerPrivate();
     d->mParent = this;
+    d->setParent(this);
 
     // Register the enums with the Qt system
     ::openrazer::registerMetaTypes();
+
+    // Track the connected devices for deviceAdded() and deviceRemoved(), this also drops removed shared devices
+    dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_added", d, SLOT(devicesChanged()));
+    dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_removed", d, SLOT(devicesChanged()));
+    auto *watcher = new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, dbusConnection(), QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration | QDBusServiceWatcher::WatchForOwnerChange, d);
+    QObject::connect(watcher, &QDBusServiceWatcher::serviceOwnerChanged, d, &ManagerPrivate::daemonOwnerChanged);
+    QObject::connect(watcher, &QDBusServiceWatcher::serviceRegistered, d, &ManagerPrivate::devicesChanged);
+    QObject::connect(watcher, &QDBusServiceWatcher::serviceUnregistered, d, &ManagerPrivate::daemonStopped);
+    d->refreshDevices(false);
 }
 
 bool Manager::isDaemonRunning()
 {
-    QDBusReply<QString> reply = d->managerDaemonIface()->call("version");
+    QDBusReply<QString> reply = d->call("razer.daemon", "version");
     return reply.isValid();
 }
 
 QVariantHash Manager::getSupportedDevices()
 {
-    QDBusReply<QString> reply = d->managerDevicesIface()->call("supportedDevices");
+    QDBusReply<QString> reply = d->call("razer.devices", "supportedDevices");
     QString content = handleDBusReply(reply, Q_FUNC_INFO);
     return QJsonDocument::fromJson(content.toUtf8()).object().toVariantHash();
 }
 
 QList<QDBusObjectPath> Manager::getDevices()
 {
-    QDBusReply<QStringList> reply = d->managerDevicesIface()->call("getDevices");
+    QDBusReply<QStringList> reply = d->call("razer.devices", "getDevices");
     QStringList serialList = handleDBusReply(reply, Q_FUNC_INFO);
     QList<QDBusObjectPath> ret;
     for (const QString &serial : serialList) {
@@ -50,38 +72,80 @@ QList<QDBusObjectPath> Manager::getDevices()
     return ret;
 }
 
-Device *Manager::getDevice(QDBusObjectPath objectPath)
+QSharedPointer<::libopenrazer::Device> Manager::getDevice(QDBusObjectPath objectPath)
+{
+    {
+        QMutexLocker locker(&d->devicesMutex);
+        auto it = d->devices.constFind(objectPath.path());
+        if (it != d->devices.constEnd())
+            return it.value();
+    }
+    return d->sharedDevices({ objectPath }).first();
+}
+
+QList<QSharedPointer<::libopenrazer::Device>> Manager::getAllDevices()
+{
+    const QList<QSharedPointer<Device>> devices = d->sharedDevices(getDevices());
+
+    // Request the metadata all devices don't have yet before waiting for the first reply
+    QList<DevicePrivate::PendingDescriptor> descriptors;
+    for (const QSharedPointer<Device> &device : devices)
+        descriptors.append(device->d->requestDescriptor());
+    for (int i = 0; i < devices.size(); i++) {
+        try {
+            devices.at(i)->d->finishDescriptor(descriptors.at(i));
+        } catch (const DBusException &) {
+            // Already printed, failed fields get requested again on first use
+        }
+    }
+
+    QList<QSharedPointer<::libopenrazer::Device>> ret;
+    for (const QSharedPointer<Device> &device : devices)
+        ret.append(device);
+    return ret;
+}
+
+QVector<DeviceSnapshot> Manager::snapshotAll(const QList<QSharedPointer<::libopenrazer::Device>> &devices)
 {
-    return new Device(objectPath);
+    // Send the calls of all devices before waiting for the first reply
+    QList<DevicePrivate::PendingSnapshot> pending;
+    for (const QSharedPointer<::libopenrazer::Device> &device : devices)
+        pending.append(static_cast<Device *>(device.data())->d->requestSnapshot());
+
+    QVector<DeviceSnapshot> snapshots;
+    snapshots.reserve(devices.size());
+    for (int i = 0; i < devices.size(); i++)
+        snapshots.append(static_cast<Device *>(devices.at(i).data())->d->finishSnapshot(pending.at(i)));
+    return snapshots;
 }
 
 void Manager::syncEffects(bool yes)
 {
-    QDBusReply<void> reply = d->managerDevicesIface()->call("syncEffects", QVariant::fromValue(yes));
+    QDBusReply<void> reply = d->call("razer.devices", "syncEffects", { QVariant::fromValue(yes) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 bool Manager::getSyncEffects()
 {
-    QDBusReply<bool> reply = d->managerDevicesIface()->call("getSyncEffects");
+    QDBusReply<bool> reply = d->call("razer.devices", "getSyncEffects");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 QString Manager::getDaemonVersion()
 {
-    QDBusReply<QString> reply = d->managerDaemonIface()->call("version");
+    QDBusReply<QString> reply = d->call("razer.daemon", "version");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Manager::setTurnOffOnScreensaver(bool turnOffOnScreensaver)
 {
-    QDBusReply<void> reply = d->managerDevicesIface()->call("enableTurnOffOnScreensaver", QVariant::fromValue(turnOffOnScreensaver));
+    QDBusReply<void> reply = d->call("razer.devices", "enableTurnOffOnScreensaver", { QVariant::fromValue(turnOffOnScreensaver) });
     handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 bool Manager::getTurnOffOnScreensaver()
 {
-    QDBusReply<bool> reply = d->managerDevicesIface()->call("getOffOnScreensaver");
+    QDBusReply<bool> reply = d->call("razer.devices", "getOffOnScreensaver");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
@@ -144,40 +208,346 @@ bool Manager::enableDaemon()
 // TODO New Qt5 connect style syntax - maybe https://stackoverflow.com/a/35501065/3527128
 bool Manager::connectDevicesChanged(QObject *receiver, const char *slot)
 {
-    bool ret = OPENRAZER_DBUS_BUS.connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_added", receiver, slot);
-    ret &= OPENRAZER_DBUS_BUS.connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_removed", receiver, slot);
+    bool ret = dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_added", receiver, slot);
+    ret &= dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices", "device_removed", receiver, slot);
     return ret;
 }
 
 QDBusServiceWatcher *Manager::getServiceWatcher()
 {
-    return new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, OPENRAZER_DBUS_BUS);
+    return new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, dbusConnection());
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<QList<QDBusObjectPath>> Manager::getDevicesAsync()
+{
+    return handleDBusPendingReply<QStringList>(d->asyncCall("razer.devices", "getDevices"), Q_FUNC_INFO, [](const QStringList &serialList) {
+        QList<QDBusObjectPath> ret;
+        for (const QString &serial : serialList) {
+            ret.append(QDBusObjectPath("/org/razer/device/" + serial));
+        }
+        return ret;
+    });
+}
+
+QFuture<QString> Manager::getDaemonVersionAsync()
+{
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.daemon", "version"), Q_FUNC_INFO);
 }
 
-QDBusInterface *ManagerPrivate::managerDaemonIface()
+QFuture<bool> Manager::isDaemonRunningAsync()
 {
-    if (ifaceDaemon == nullptr) {
-        ifaceDaemon = new QDBusInterface(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.daemon",
-                                         OPENRAZER_DBUS_BUS, mParent);
+    // Not running is a valid result here and not an error
+    QFutureInterface<bool> future(QFutureInterfaceBase::Started);
+    watchPendingCall(d->asyncCall("razer.daemon", "version"), [future](const QDBusPendingCall &call) mutable {
+        bool running = !call.isError();
+        future.reportFinished(&running);
+    });
+    return future.future();
+}
+
+QFuture<QVariantHash> Manager::getSupportedDevicesAsync()
+{
+    return handleDBusPendingReply<QString>(d->asyncCall("razer.devices", "supportedDevices"), Q_FUNC_INFO, [](const QString &content) {
+        return QJsonDocument::fromJson(content.toUtf8()).object().toVariantHash();
+    });
+}
+
+QFuture<void> Manager::syncEffectsAsync(bool yes)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.devices", "syncEffects", { yes }), Q_FUNC_INFO);
+}
+
+QFuture<bool> Manager::getSyncEffectsAsync()
+{
+    return handleDBusPendingReply<bool>(d->asyncCall("razer.devices", "getSyncEffects"), Q_FUNC_INFO);
+}
+
+QFuture<void> Manager::setTurnOffOnScreensaverAsync(bool turnOffOnScreensaver)
+{
+    return handleDBusPendingReply<void>(d->asyncCall("razer.devices", "enableTurnOffOnScreensaver", { turnOffOnScreensaver }), Q_FUNC_INFO);
+}
+
+QFuture<bool> Manager::getTurnOffOnScreensaverAsync()
+{
+    return handleDBusPendingReply<bool>(d->asyncCall("razer.devices", "getOffOnScreensaver"), Q_FUNC_INFO);
+}
+
+// Object paths of openrazer devices end with the device serial
+static QString serialFromPath(const QDBusObjectPath &objectPath)
+{
+    return objectPath.path().section('/', -1);
+}
+
+QList<Device *> ManagerPrivate::createDevices(const QList<QDBusObjectPath> &objectPaths)
+{
+    IntrospectionCache *cache = IntrospectionCache::instance();
+    // Cache entries are only valid for the daemon version they were created with
+    QString version;
+    const bool useCache = daemonVersion(&version);
+
+    QList<DeviceIntrospection> introspections;
+    QList<QPair<int, QDBusPendingCall>> pending;
+    for (int i = 0; i < objectPaths.size(); i++) {
+        DeviceIntrospection introspection;
+        QByteArray xmlHash;
+        if (useCache && cache->lookup(version, serialFromPath(objectPaths.at(i)), &introspection, &xmlHash)) {
+            // Checked once the device has been handed out, on the thread of the Manager
+            const QDBusObjectPath objectPath = objectPaths.at(i);
+            QMetaObject::invokeMethod(this, [this, objectPath, version, xmlHash]() {
+                revalidateDevice(objectPath, version, xmlHash);
+            }, Qt::QueuedConnection);
+        } else {
+            pending.append(qMakePair(i, DevicePrivate::introspect(objectPaths.at(i))));
+        }
+        introspections.append(introspection);
     }
-    if (!ifaceDaemon->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+
+    // The introspection calls of all uncached devices have been sent already, so this only waits for the slowest
+    for (const QPair<int, QDBusPendingCall> &reply : pending) {
+        QString xml = handleDBusReply(QDBusReply<QString>(reply.second), Q_FUNC_INFO);
+        introspections[reply.first] = DevicePrivate::parseIntrospection(xml);
+        if (useCache)
+            cache->insert(version, serialFromPath(objectPaths.at(reply.first)), IntrospectionCache::hash(xml), introspections.at(reply.first));
     }
-    return ifaceDaemon;
+    if (!pending.isEmpty())
+        cache->save();
+
+    QList<Device *> devices;
+    for (int i = 0; i < objectPaths.size(); i++)
+        devices.append(new Device(objectPaths.at(i), introspections.at(i)));
+    return devices;
 }
 
-QDBusInterface *ManagerPrivate::managerDevicesIface()
+bool ManagerPrivate::daemonVersion(QString *result)
 {
-    if (ifaceDevices == nullptr) {
-        ifaceDevices = new QDBusInterface(OPENRAZER_SERVICE_NAME, "/org/razer", "razer.devices",
-                                          OPENRAZER_DBUS_BUS, mParent);
+    QMutexLocker locker(&versionMutex);
+    if (!versionValid) {
+        // Not running, asked again next time
+        QDBusReply<QString> reply = call("razer.daemon", "version");
+        if (!reply.isValid())
+            return false;
+        version = reply.value();
+        versionValid = true;
     }
-    if (!ifaceDevices->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    *result = version;
+    return true;
+}
+
+QList<QSharedPointer<Device>> ManagerPrivate::sharedDevices(const QList<QDBusObjectPath> &objectPaths)
+{
+    // Set up all devices that aren't cached yet at once
+    QList<QDBusObjectPath> missing;
+    {
+        QMutexLocker locker(&devicesMutex);
+        for (const QDBusObjectPath &objectPath : objectPaths) {
+            if (!devices.contains(objectPath.path()) && !missing.contains(objectPath))
+                missing.append(objectPath);
+        }
+    }
+    QList<Device *> created;
+    if (!missing.isEmpty())
+        created = createDevices(missing);
+
+    QMutexLocker locker(&devicesMutex);
+    for (int i = 0; i < missing.size(); i++) {
+        // Another thread might have been faster, all callers get the same device
+        if (devices.contains(missing.at(i).path()))
+            delete created.at(i);
+        else
+            devices.insert(missing.at(i).path(), QSharedPointer<Device>(created.at(i)));
+    }
+
+    QList<QSharedPointer<Device>> ret;
+    for (const QDBusObjectPath &objectPath : objectPaths)
+        ret.append(devices.value(objectPath.path()));
+    return ret;
+}
+
+void ManagerPrivate::refreshDevices(bool notify)
+{
+    auto *watcher = new QDBusPendingCallWatcher(asyncCall("razer.devices", "getDevices"), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, notify](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QStringList> reply = *watcher;
+        watcher->deleteLater();
+        // Not running, devices get reported once it has started
+        if (reply.isError())
+            return;
+        QList<QDBusObjectPath> objectPaths;
+        for (const QString &serial : reply.value())
+            objectPaths.append(QDBusObjectPath("/org/razer/device/" + serial));
+        updateDevices(objectPaths, notify);
+    });
+}
+
+void ManagerPrivate::addDevice(const QDBusObjectPath &objectPath)
+{
+    // A device that has been connected before is set up from the introspection cache right away
+    IntrospectionCache *cache = IntrospectionCache::instance();
+    QString version;
+    const bool useCache = daemonVersion(&version);
+    DeviceIntrospection introspection;
+    QByteArray xmlHash;
+    if (useCache && cache->lookup(version, serialFromPath(objectPath), &introspection, &xmlHash)) {
+        finishAddDevice(objectPath, introspection);
+        revalidateDevice(objectPath, version, xmlHash);
+        return;
+    }
+
+    auto *watcher = new QDBusPendingCallWatcher(DevicePrivate::introspect(objectPath), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, objectPath, useCache, version](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QString> reply = *watcher;
+        watcher->deleteLater();
+        if (reply.isError()) {
+            printDBusError(reply.error(), Q_FUNC_INFO);
+            return;
+        }
+        DeviceIntrospection introspection = DevicePrivate::parseIntrospection(reply.value());
+        if (useCache) {
+            IntrospectionCache *cache = IntrospectionCache::instance();
+            cache->insert(version, serialFromPath(objectPath), IntrospectionCache::hash(reply.value()), introspection);
+            cache->save();
+        }
+        finishAddDevice(objectPath, introspection);
+    });
+}
+
+void ManagerPrivate::finishAddDevice(const QDBusObjectPath &objectPath, const DeviceIntrospection &introspection)
+{
+    QSharedPointer<Device> device;
+    {
+        QMutexLocker locker(&devicesMutex);
+        // Removed again in the meantime
+        if (!knownDevices.contains(objectPath.path()))
+            return;
+        // getDevice() might have been faster
+        device = devices.value(objectPath.path());
+        if (device.isNull()) {
+            device = QSharedPointer<Device>(new Device(objectPath, introspection));
+            devices.insert(objectPath.path(), device);
+        }
     }
-    return ifaceDevices;
+    emit mParent->deviceAdded(device);
+}
+
+void ManagerPrivate::revalidateDevice(const QDBusObjectPath &objectPath, const QString &version, const QByteArray &xmlHash)
+{
+    auto *watcher = new QDBusPendingCallWatcher(DevicePrivate::introspect(objectPath), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, objectPath, version, xmlHash](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QString> reply = *watcher;
+        watcher->deleteLater();
+        // Gone in the meantime, the cached data is checked again next time
+        if (reply.isError() || IntrospectionCache::hash(reply.value()) == xmlHash)
+            return;
+
+        DeviceIntrospection introspection = DevicePrivate::parseIntrospection(reply.value());
+        IntrospectionCache *cache = IntrospectionCache::instance();
+        cache->insert(version, serialFromPath(objectPath), IntrospectionCache::hash(reply.value()), introspection);
+        cache->save();
+
+        // Applications get the device with the new features and LEDs like a reconnected one
+        QSharedPointer<Device> device;
+        {
+            QMutexLocker locker(&devicesMutex);
+            auto it = devices.find(objectPath.path());
+            if (it == devices.end())
+                return;
+            it.value()->d->invalidateDescriptor();
+            device = QSharedPointer<Device>(new Device(objectPath, introspection));
+            it.value() = device;
+        }
+        emit mParent->deviceRemoved(objectPath);
+        emit mParent->deviceAdded(device);
+    });
+}
+
+void ManagerPrivate::devicesChanged()
+{
+    refreshDevices(true);
+}
+
+void ManagerPrivate::updateDevices(const QList<QDBusObjectPath> &objectPaths, bool notify)
+{
+    QSet<QString> connected;
+    for (const QDBusObjectPath &objectPath : objectPaths)
+        connected.insert(objectPath.path());
+
+    QList<QDBusObjectPath> removed;
+    QList<QDBusObjectPath> added;
+    {
+        QMutexLocker locker(&devicesMutex);
+        // Shared devices can also be created before the initial list has arrived, so check all of them
+        for (auto it = devices.begin(); it != devices.end();) {
+            if (connected.contains(it.key())) {
+                ++it;
+            } else {
+                // Applications can still hold the device, don't let them see data of the old connection
+                it.value()->d->invalidateDescriptor();
+                it = devices.erase(it);
+            }
+        }
+
+        for (auto it = knownDevices.begin(); it != knownDevices.end();) {
+            if (connected.contains(*it)) {
+                ++it;
+            } else {
+                removed.append(QDBusObjectPath(*it));
+                it = knownDevices.erase(it);
+            }
+        }
+        for (const QDBusObjectPath &objectPath : objectPaths) {
+            if (!knownDevices.contains(objectPath.path())) {
+                knownDevices.insert(objectPath.path());
+                added.append(objectPath);
+            }
+        }
+    }
+
+    if (!notify)
+        return;
+    for (const QDBusObjectPath &objectPath : removed)
+        emit mParent->deviceRemoved(objectPath);
+    // Only the new devices are set up, the others stay untouched
+    for (const QDBusObjectPath &objectPath : added)
+        addDevice(objectPath);
+}
+
+void ManagerPrivate::daemonStopped()
+{
+    QSet<QString> removed;
+    {
+        QMutexLocker locker(&devicesMutex);
+        // The devices may have changed (e.g. a firmware update) once the daemon is back
+        for (const QSharedPointer<Device> &device : devices)
+            device->d->invalidateDescriptor();
+        devices.clear();
+        removed = knownDevices;
+        knownDevices.clear();
+    }
+    for (const QString &objectPath : removed)
+        emit mParent->deviceRemoved(QDBusObjectPath(objectPath));
+}
+
+void ManagerPrivate::daemonOwnerChanged()
+{
+    // The daemon has been restarted (or replaced), it might be a different version
+    QMutexLocker locker(&versionMutex);
+    versionValid = false;
+}
+
+QDBusMessage ManagerPrivate::call(const QString &interface, const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, "/org/razer", interface, method);
+    message.setArguments(arguments);
+    return dbusConnection().call(message);
+}
+
+AsyncCall ManagerPrivate::asyncCall(const QString &interface, const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, "/org/razer", interface, method);
+    message.setArguments(arguments);
+    return AsyncCall(dbusConnection(), message);
 }
 
 }
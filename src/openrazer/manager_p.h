@@ -6,25 +6,64 @@
 #define OPENRAZER_MANAGER_P_H
 
 #include "libopenrazer/manager.h"
+#include "libopenrazer_private.h"
 
-#include <QDBusInterface>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
 
 namespace libopenrazer {
 
 namespace openrazer {
 
-const char *OPENRAZER_SERVICE_NAME = "org.razer";
-QDBusConnection OPENRAZER_DBUS_BUS = QDBusConnection::sessionBus();
+class Device;
 
-class ManagerPrivate
+class ManagerPrivate : public QObject
 {
+    Q_OBJECT
 public:
     Manager *mParent = nullptr;
 
-    QDBusInterface *ifaceDaemon = nullptr;
-    QDBusInterface *ifaceDevices = nullptr;
-    QDBusInterface *managerDaemonIface();
-    QDBusInterface *managerDevicesIface();
+    QDBusMessage call(const QString &interface, const QString &method, const QVariantList &arguments = QVariantList());
+    AsyncCall asyncCall(const QString &interface, const QString &method, const QVariantList &arguments = QVariantList());
+
+    // Sets up the devices, from the introspection cache where possible
+    QList<Device *> createDevices(const QList<QDBusObjectPath> &objectPaths);
+
+    // Version of the running daemon, the key of the introspection cache. Only requested once per
+    // daemon lifetime, reset when the owner of the service changes. Guarded by versionMutex, as
+    // devices can be created from several threads.
+    QMutex versionMutex;
+    bool versionValid = false;
+    QString version;
+    bool daemonVersion(QString *result);
+
+    // Guards devices and knownDevices, getDevice() and getAllDevices() can be called from several
+    // threads. Not held while talking to the daemon or emitting signals.
+    QMutex devicesMutex;
+    // Devices handed out by the Manager by object path, until the daemon removes them
+    QHash<QString, QSharedPointer<Device>> devices;
+    QList<QSharedPointer<Device>> sharedDevices(const QList<QDBusObjectPath> &objectPaths);
+
+    // Object paths of the connected devices, kept up to date from the daemon signals
+    QSet<QString> knownDevices;
+    void refreshDevices(bool notify);
+    void updateDevices(const QList<QDBusObjectPath> &objectPaths, bool notify);
+    // Sets up a newly connected device, from the introspection cache or in the background, then emits deviceAdded()
+    void addDevice(const QDBusObjectPath &objectPath);
+    void finishAddDevice(const QDBusObjectPath &objectPath, const DeviceIntrospection &introspection);
+    // Introspects a device set up from the introspection cache in the background. If the data
+    // doesn't match the cached one anymore, the entry is replaced and the device is set up again.
+    void revalidateDevice(const QDBusObjectPath &objectPath, const QString &version, const QByteArray &xmlHash);
+
+public slots:
+    void devicesChanged();
+    void daemonStopped();
+    void daemonOwnerChanged();
 };
 
 }
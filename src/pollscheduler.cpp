@@ -0,0 +1,218 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/pollscheduler.h"
+
+#include "libopenrazer/dbusexception.h"
+#include "libopenrazer/device.h"
+
+#include <QFutureWatcher>
+#include <QSharedPointer>
+
+namespace libopenrazer {
+
+namespace {
+
+// Used for devices that can't report their threshold
+const double DefaultLowBatteryThreshold = 20.0;
+// Batteries closer than this to the threshold are polled at the minimum interval
+const double NearThresholdMargin = 5.0;
+
+}
+
+// Replies of one poll of a device
+struct PollScheduler::Poll {
+    int id = 0;
+    int pending = 0;
+    QFuture<double> percent;
+    QFuture<bool> charging;
+    bool hasThreshold = false;
+    QFuture<double> threshold;
+};
+
+PollScheduler::PollScheduler(QObject *parent)
+    : QObject(parent)
+{
+    // Intervals are seconds to minutes, there is no need to wake up exactly on time
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &PollScheduler::poll);
+    m_clock.start();
+}
+
+void PollScheduler::addDevice(Device *device)
+{
+    if (m_entries.contains(device) || !device->hasFeature(Device::Battery))
+        return;
+
+    Entry entry;
+    entry.id = m_nextId++;
+    entry.due = m_clock.elapsed();
+    entry.interval = m_minimumInterval;
+    entry.polling = false;
+    entry.hasValues = false;
+    entry.percent = 0;
+    entry.charging = false;
+    entry.thresholdKnown = false;
+    entry.threshold = DefaultLowBatteryThreshold;
+    entry.destroyedConnection = connect(device, &QObject::destroyed, this, [this, device]() {
+        removeDevice(device);
+    });
+    m_entries.insert(device, entry);
+
+    // Devices added together get their first poll together
+    schedule();
+}
+
+void PollScheduler::removeDevice(Device *device)
+{
+    auto it = m_entries.find(device);
+    if (it == m_entries.end())
+        return;
+    disconnect(it->destroyedConnection);
+    m_entries.erase(it);
+    schedule();
+}
+
+void PollScheduler::setIntervals(int minimum, int maximum)
+{
+    m_minimumInterval = qMax(1, minimum);
+    m_maximumInterval = qMax(m_minimumInterval, maximum);
+    // Very coarse timers are rounded to full seconds, shorter intervals would be polled right away
+    m_timer.setTimerType(m_minimumInterval < 1000 ? Qt::CoarseTimer : Qt::VeryCoarseTimer);
+    for (Entry &entry : m_entries)
+        entry.interval = qBound(m_minimumInterval, entry.interval, m_maximumInterval);
+}
+
+int PollScheduler::minimumInterval() const
+{
+    return m_minimumInterval;
+}
+
+int PollScheduler::maximumInterval() const
+{
+    return m_maximumInterval;
+}
+
+void PollScheduler::setBatchWindow(int msec)
+{
+    m_batchWindow = qMax(0, msec);
+}
+
+int PollScheduler::batchWindow() const
+{
+    return m_batchWindow;
+}
+
+int PollScheduler::interval(Device *device) const
+{
+    auto it = m_entries.constFind(device);
+    return it != m_entries.constEnd() ? it->interval : 0;
+}
+
+void PollScheduler::schedule()
+{
+    qint64 next = -1;
+    for (const Entry &entry : m_entries) {
+        if (!entry.polling && (next < 0 || entry.due < next))
+            next = entry.due;
+    }
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start(static_cast<int>(qMax<qint64>(0, next - m_clock.elapsed())));
+}
+
+void PollScheduler::poll()
+{
+    const qint64 due = m_clock.elapsed() + m_batchWindow;
+    QList<Device *> devices;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (!it->polling && it->due <= due) {
+            it->polling = true;
+            devices.append(it.key());
+        }
+    }
+
+    // All calls are sent before the first reply is handled
+    for (Device *device : devices) {
+        const Entry &entry = m_entries.value(device);
+        QSharedPointer<Poll> poll(new Poll);
+        poll->id = entry.id;
+        poll->percent = device->getBatteryPercentAsync();
+        poll->charging = device->isChargingAsync();
+        QList<QFuture<void>> futures { poll->percent, poll->charging };
+        if (!entry.thresholdKnown && device->hasFeature(Device::LowBatteryThreshold)) {
+            poll->hasThreshold = true;
+            poll->threshold = device->getLowBatteryThresholdAsync();
+            futures.append(poll->threshold);
+        }
+
+        poll->pending = futures.size();
+        for (const QFuture<void> &future : futures) {
+            auto *watcher = new QFutureWatcher<void>(this);
+            connect(watcher, &QFutureWatcher<void>::finished, this, [this, device, poll, watcher]() {
+                watcher->deleteLater();
+                if (--poll->pending == 0)
+                    pollFinished(device, *poll);
+            });
+            watcher->setFuture(future);
+        }
+    }
+
+    schedule();
+}
+
+void PollScheduler::pollFinished(Device *device, const Poll &poll)
+{
+    auto it = m_entries.find(device);
+    if (it == m_entries.end() || it->id != poll.id)
+        return;
+    Entry &entry = *it;
+    entry.polling = false;
+
+    double percent;
+    bool charging;
+    try {
+        percent = poll.percent.result();
+        charging = poll.charging.result();
+    } catch (const DBusException &) {
+        // Already printed by libopenrazer, back off like for a value that doesn't change
+        entry.interval = qMin(entry.interval * 2, m_maximumInterval);
+        entry.due = m_clock.elapsed() + entry.interval;
+        schedule();
+        return;
+    }
+    if (poll.hasThreshold) {
+        try {
+            entry.threshold = poll.threshold.result();
+            entry.thresholdKnown = true;
+        } catch (const DBusException &) {
+            // Already printed, asked again with the next poll
+        }
+    }
+
+    const bool newPercent = !entry.hasValues || percent != entry.percent;
+    const bool newCharging = !entry.hasValues || charging != entry.charging;
+    if (charging || percent <= entry.threshold + NearThresholdMargin)
+        entry.interval = m_minimumInterval;
+    else if (newPercent || newCharging)
+        entry.interval = qMax(m_minimumInterval, entry.interval / 2);
+    else
+        entry.interval = qMin(entry.interval * 2, m_maximumInterval);
+    entry.due = m_clock.elapsed() + entry.interval;
+    entry.hasValues = true;
+    entry.percent = percent;
+    entry.charging = charging;
+    schedule();
+
+    // Receivers might remove the device, so entry can't be used anymore
+    if (newCharging)
+        emit chargingChanged(device, charging);
+    if (newPercent)
+        emit batteryPercentChanged(device, percent);
+}
+
+}
@@ -8,22 +8,43 @@
 
 #include <QVector>
 
+#include <exception>
+
 namespace libopenrazer {
 
 namespace razer_test {
 
 Device::Device(QDBusObjectPath objectPath)
+    : Device(objectPath, DevicePrivate::requestSetup(objectPath))
+{
+}
+
+Device::Device(QDBusObjectPath objectPath, const DeviceSetup &setup)
 {
+    const QVariantMap properties = handleDBusReply(QDBusReply<QVariantMap>(setup.properties), Q_FUNC_INFO);
+    // Everything below is needed to set up the device, an older daemon might not have it
+    for (const QString &key : { QStringLiteral("SupportedFx"), QStringLiteral("SupportedFeatures"), QStringLiteral("Leds") }) {
+        if (!properties.contains(key)) {
+            QDBusError error(QDBusError::InvalidArgs, QStringLiteral("Property %1 of %2 is missing").arg(key, objectPath.path()));
+            printDBusError(error, Q_FUNC_INFO);
+            throw DBusException(error);
+        }
+    }
+
     d = new DevicePrivate();
     d->mParent = this;
     d->mObjectPath = objectPath;
-    d->supportedFx = d->getSupportedFx();
-    d->supportedFeatures = d->getSupportedFeatures();
+    d->supportedFx = qdbus_cast<QStringList>(properties.value(QStringLiteral("SupportedFx")));
+    d->supportedFeatures = qdbus_cast<QStringList>(properties.value(QStringLiteral("SupportedFeatures")));
+    d->features = featuresFromNames(d->supportedFeatures);
 
-    for (const QDBusObjectPath &ledPath : d->getLedObjectPaths()) {
+    for (const QDBusObjectPath &ledPath : qdbus_cast<QList<QDBusObjectPath>>(properties.value(QStringLiteral("Leds")))) {
         Led *led = new Led(this, ledPath);
         d->leds.append(led);
     }
+    // The properties of all LEDs are requested at once, without waiting for them here
+    for (::libopenrazer::Led *led : d->leds)
+        static_cast<Led *>(led)->d->loadProperties();
 }
 
 Device::~Device()
@@ -43,15 +64,14 @@ bool Device::hasFeature(const QString &featureStr)
     return d->supportedFeatures.contains(featureStr);
 }
 
-QString Device::getDeviceImageUrl()
+Device::Features Device::features()
 {
-    return ""; // TODO Needs implementation
+    return d->features;
 }
 
-QList<QDBusObjectPath> DevicePrivate::getLedObjectPaths()
+QString Device::getDeviceImageUrl()
 {
-    QVariant reply = deviceIface()->property("Leds");
-    return handleDBusVariant<QList<QDBusObjectPath>>(reply, deviceIface()->lastError(), Q_FUNC_INFO);
+    return ""; // TODO Needs implementation
 }
 
 QList<::libopenrazer::Led *> Device::getLeds()
@@ -59,18 +79,6 @@ QList<::libopenrazer::Led *> Device::getLeds()
     return d->leds;
 }
 
-QStringList DevicePrivate::getSupportedFx()
-{
-    QVariant reply = deviceIface()->property("SupportedFx");
-    return handleDBusVariant<QStringList>(reply, deviceIface()->lastError(), Q_FUNC_INFO);
-}
-
-QStringList DevicePrivate::getSupportedFeatures()
-{
-    QVariant reply = deviceIface()->property("SupportedFeatures");
-    return handleDBusVariant<QStringList>(reply, deviceIface()->lastError(), Q_FUNC_INFO);
-}
-
 QString Device::getDeviceMode()
 {
     return "error"; // TODO Needs implementation
@@ -78,43 +86,58 @@ QString Device::getDeviceMode()
 
 QString Device::getSerial()
 {
-    QDBusReply<QString> reply = d->deviceIface()->call("getSerial");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString serial;
+    if (d->descriptorCache->get(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, &serial))
+        return serial;
+    QDBusReply<QString> reply = d->call("getSerial");
+    return d->descriptorCache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QString Device::getDeviceName()
 {
-    QVariant reply = d->deviceIface()->property("Name");
-    return handleDBusVariant<QString>(reply, d->deviceIface()->lastError(), Q_FUNC_INFO);
+    QString deviceName;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, &deviceName))
+        return deviceName;
+    QDBusReply<QDBusVariant> reply = d->property("Name");
+    return d->descriptorCache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, handleDBusVariant<QString>(reply, Q_FUNC_INFO));
 }
 
 QString Device::getDeviceType()
 {
-    QVariant reply = d->deviceIface()->property("Type");
-    return handleDBusVariant<QString>(reply, d->deviceIface()->lastError(), Q_FUNC_INFO);
+    QString deviceType;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, &deviceType))
+        return deviceType;
+    QDBusReply<QDBusVariant> reply = d->property("Type");
+    return d->descriptorCache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, handleDBusVariant<QString>(reply, Q_FUNC_INFO));
 }
 
 QString Device::getFirmwareVersion()
 {
-    QDBusReply<QString> reply = d->deviceIface()->call("getFirmwareVersion");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString firmwareVersion;
+    if (d->descriptorCache->get(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, &firmwareVersion))
+        return firmwareVersion;
+    QDBusReply<QString> reply = d->call("getFirmwareVersion");
+    return d->descriptorCache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QString Device::getKeyboardLayout()
 {
-    QDBusReply<QString> reply = d->deviceIface()->call("getKeyboardLayout");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    QString keyboardLayout;
+    if (d->descriptorCache->get(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, &keyboardLayout))
+        return keyboardLayout;
+    QDBusReply<QString> reply = d->call("getKeyboardLayout");
+    return d->descriptorCache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 ushort Device::getPollRate()
 {
-    QDBusReply<ushort> reply = d->deviceIface()->call("getPollRate");
+    QDBusReply<ushort> reply = d->call("getPollRate");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::setPollRate(ushort pollrate)
 {
-    QDBusReply<bool> reply = d->deviceIface()->call("setPollRate", QVariant::fromValue(pollrate));
+    QDBusReply<bool> reply = d->call("setPollRate", { QVariant::fromValue(pollrate) });
     handleVoidDBusReply(reply, Q_FUNC_INFO);
 }
 
@@ -126,13 +149,13 @@ QVector<ushort> Device::getSupportedPollRates()
 
 void Device::setDPI(::openrazer::DPI dpi)
 {
-    QDBusReply<bool> reply = d->deviceIface()->call("setDPI", QVariant::fromValue(dpi));
+    QDBusReply<bool> reply = d->call("setDPI", { QVariant::fromValue(dpi) });
     handleVoidDBusReply(reply, Q_FUNC_INFO);
 }
 
 ::openrazer::DPI Device::getDPI()
 {
-    QDBusReply<::openrazer::DPI> reply = d->deviceIface()->call("getDPI");
+    QDBusReply<::openrazer::DPI> reply = d->call("getDPI");
     return handleDBusReply(reply, Q_FUNC_INFO);
 }
 
@@ -149,8 +172,11 @@ QPair<uchar, QVector<::openrazer::DPI>> Device::getDPIStages()
 
 ushort Device::maxDPI()
 {
-    QDBusReply<ushort> reply = d->deviceIface()->call("getMaxDPI");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    ushort dpi;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, &dpi))
+        return dpi;
+    QDBusReply<ushort> reply = d->call("getMaxDPI");
+    return d->descriptorCache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, handleDBusReply(reply, Q_FUNC_INFO));
 }
 
 QVector<ushort> Device::getAllowedDPI()
@@ -195,33 +221,422 @@ void Device::setLowBatteryThreshold(double threshold)
 
 void Device::displayCustomFrame()
 {
-    QDBusReply<bool> reply = d->deviceIface()->call("displayCustomFrame");
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    QDBusReply<bool> reply = d->frameCall(d->asyncCall("displayCustomFrame"), start);
+    d->frameStats->endFrame();
     handleVoidDBusReply(reply, Q_FUNC_INFO);
 }
 
 void Device::defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData)
 {
-    QDBusReply<bool> reply = d->deviceIface()->call("defineCustomFrame", QVariant::fromValue(row), QVariant::fromValue(startColumn), QVariant::fromValue(endColumn), QVariant::fromValue(colorData));
+    d->invalidateLedEffects();
+    // razer_test takes the colors as they are, so there's no packing stage
+    qint64 start = FrameStats::now();
+    QDBusReply<bool> reply = d->frameCall(d->asyncCall("defineCustomFrame", { QVariant::fromValue(row), QVariant::fromValue(startColumn), QVariant::fromValue(endColumn), QVariant::fromValue(colorData) }), start);
     handleVoidDBusReply(reply, Q_FUNC_INFO);
 }
 
 ::openrazer::MatrixDimensions Device::getMatrixDimensions()
 {
-    QVariant reply = d->deviceIface()->property("MatrixDimensions");
-    return handleDBusVariant<::openrazer::MatrixDimensions>(reply, d->deviceIface()->lastError(), Q_FUNC_INFO);
+    ::openrazer::MatrixDimensions dimensions;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, &dimensions))
+        return dimensions;
+    QDBusReply<QDBusVariant> reply = d->property("MatrixDimensions");
+    return d->descriptorCache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, handleDBusVariant<::openrazer::MatrixDimensions>(reply, Q_FUNC_INFO));
+}
+
+FrameStats *Device::frameStats()
+{
+    return d->frameStats.data();
+}
+
+DeviceDescriptor Device::getDescriptor()
+{
+    return d->getDescriptor();
+}
+
+DeviceDescriptor DevicePrivate::getDescriptor()
+{
+    // Cached fields aren't requested again. The lock of the cache isn't held while waiting for the
+    // daemon, at worst two threads fetch the same field.
+    return finishDescriptor(requestDescriptor());
+}
+
+DevicePrivate::PendingDescriptor DevicePrivate::requestDescriptor()
+{
+    PendingDescriptor pending;
+    // Fields of features the device doesn't have stay empty
+    auto request = [&pending, this](DeviceDescriptorCache::Field field, bool available) {
+        pending.requested[field] = available && !descriptorCache->has(field);
+        return pending.requested[field];
+    };
+
+    // Send all calls before waiting for the first reply, so this only takes one round trip
+    if (request(DeviceDescriptorCache::Serial, true))
+        pending.serial = asyncCall("getSerial");
+    if (request(DeviceDescriptorCache::DeviceName, true))
+        pending.deviceName = asyncProperty("Name");
+    if (request(DeviceDescriptorCache::DeviceType, true))
+        pending.deviceType = asyncProperty("Type");
+    if (request(DeviceDescriptorCache::FirmwareVersion, true))
+        pending.firmwareVersion = asyncCall("getFirmwareVersion");
+    if (request(DeviceDescriptorCache::KeyboardLayout, features.testFlag(Device::KeyboardLayout)))
+        pending.keyboardLayout = asyncCall("getKeyboardLayout");
+    if (request(DeviceDescriptorCache::MaxDPI, features.testFlag(Device::Dpi)))
+        pending.maxDPI = asyncCall("getMaxDPI");
+    if (request(DeviceDescriptorCache::MatrixDimensions, features.testFlag(Device::CustomFrame)))
+        pending.matrixDimensions = asyncProperty("MatrixDimensions");
+    return pending;
+}
+
+DeviceDescriptor DevicePrivate::finishDescriptor(const PendingDescriptor &pending)
+{
+    const char *functionname = Q_FUNC_INFO;
+    DeviceDescriptorCache *cache = descriptorCache.data();
+    // Every field is cached on its own, a failed call doesn't keep the others from being cached.
+    // The first error is thrown once all replies have been handled.
+    std::exception_ptr error;
+    auto finish = [&pending, &error](DeviceDescriptorCache::Field field, const std::function<void()> &store) {
+        if (!pending.requested[field])
+            return;
+        try {
+            store();
+        } catch (const DBusException &) {
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    finish(DeviceDescriptorCache::Serial, [&] {
+        cache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, handleDBusReply(QDBusReply<QString>(pending.serial), functionname));
+    });
+    finish(DeviceDescriptorCache::DeviceName, [&] {
+        cache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, handleDBusVariant<QString>(QDBusReply<QDBusVariant>(pending.deviceName), functionname));
+    });
+    finish(DeviceDescriptorCache::DeviceType, [&] {
+        cache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, handleDBusVariant<QString>(QDBusReply<QDBusVariant>(pending.deviceType), functionname));
+    });
+    finish(DeviceDescriptorCache::FirmwareVersion, [&] {
+        cache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, handleDBusReply(QDBusReply<QString>(pending.firmwareVersion), functionname));
+    });
+    finish(DeviceDescriptorCache::KeyboardLayout, [&] {
+        cache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, handleDBusReply(QDBusReply<QString>(pending.keyboardLayout), functionname));
+    });
+    finish(DeviceDescriptorCache::MaxDPI, [&] {
+        cache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, handleDBusReply(QDBusReply<ushort>(pending.maxDPI), functionname));
+    });
+    finish(DeviceDescriptorCache::MatrixDimensions, [&] {
+        cache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, handleDBusVariant<::openrazer::MatrixDimensions>(QDBusReply<QDBusVariant>(pending.matrixDimensions), functionname));
+    });
+    if (error)
+        std::rethrow_exception(error);
+
+    // razer_test doesn't report the image URL, the supported poll rates and the allowed DPI values,
+    // they come from the getters without asking the daemon
+    DeviceDescriptor result = cache->descriptor();
+    result.deviceImageUrl = mParent->getDeviceImageUrl();
+    result.supportedPollRates = mParent->getSupportedPollRates();
+    result.allowedDPI = mParent->getAllowedDPI();
+    return result;
+}
+
+DeviceSnapshot Device::snapshot()
+{
+    return d->finishSnapshot(d->requestSnapshot());
+}
+
+DevicePrivate::PendingSnapshot DevicePrivate::requestSnapshot()
+{
+    // Send all calls before waiting for the first reply, so this only takes one round trip
+    PendingSnapshot pending;
+    if (features.testFlag(Device::Dpi))
+        pending.dpi = asyncCall("getDPI");
+    if (features.testFlag(Device::PollRate))
+        pending.pollRate = asyncCall("getPollRate");
+    for (::libopenrazer::Led *led : leds)
+        pending.leds.append(static_cast<Led *>(led)->d->requestSnapshot());
+    return pending;
+}
+
+DeviceSnapshot DevicePrivate::finishSnapshot(const PendingSnapshot &pending)
+{
+    DeviceSnapshot snapshot;
+    if (features.testFlag(Device::Dpi))
+        snapshot.dpi = handleDBusReply(QDBusReply<::openrazer::DPI>(pending.dpi), Q_FUNC_INFO);
+    if (features.testFlag(Device::DpiStages)) {
+        QPair<uchar, QVector<::openrazer::DPI>> stages = mParent->getDPIStages();
+        snapshot.activeDPIStage = stages.first;
+        snapshot.dpiStages = stages.second;
+    }
+    if (features.testFlag(Device::PollRate))
+        snapshot.pollRate = handleDBusReply(QDBusReply<ushort>(pending.pollRate), Q_FUNC_INFO);
+    // Not provided by the daemon yet, these don't cause any D-Bus traffic
+    if (features.testFlag(Device::Battery)) {
+        snapshot.batteryPercent = mParent->getBatteryPercent();
+        snapshot.charging = mParent->isCharging();
+    }
+    if (features.testFlag(Device::IdleTime))
+        snapshot.idleTime = mParent->getIdleTime();
+    if (features.testFlag(Device::LowBatteryThreshold))
+        snapshot.lowBatteryThreshold = mParent->getLowBatteryThreshold();
+    for (int i = 0; i < leds.size(); i++)
+        snapshot.leds.append(static_cast<Led *>(leds.at(i))->d->finishSnapshot(pending.leds.at(i)));
+    return snapshot;
 }
 
-QDBusInterface *DevicePrivate::deviceIface()
+void DevicePrivate::invalidateDescriptor()
 {
-    if (iface == nullptr) {
-        iface = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Device",
-                                   OPENRAZER_DBUS_BUS, mParent);
-    }
-    if (!iface->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
-    }
-    return iface;
+    descriptorCache->invalidate();
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<QString> Device::getDeviceImageUrlAsync()
+{
+    return readyFuture(QString()); // TODO Needs implementation
+}
+
+QFuture<QString> Device::getDeviceModeAsync()
+{
+    return readyFuture(QStringLiteral("error")); // TODO Needs implementation
+}
+
+QFuture<QString> Device::getSerialAsync()
+{
+    QString serial;
+    if (d->descriptorCache->get(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, &serial))
+        return readyFuture(serial);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("getSerial"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::Serial, &DeviceDescriptor::serial, value);
+    });
+}
+
+QFuture<QString> Device::getDeviceNameAsync()
+{
+    QString deviceName;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, &deviceName))
+        return readyFuture(deviceName);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("Name"), Q_FUNC_INFO, [cache](const QDBusVariant &value) {
+        return cache->store(DeviceDescriptorCache::DeviceName, &DeviceDescriptor::deviceName, qdbus_cast<QString>(value.variant()));
+    });
+}
+
+QFuture<QString> Device::getDeviceTypeAsync()
+{
+    QString deviceType;
+    if (d->descriptorCache->get(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, &deviceType))
+        return readyFuture(deviceType);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("Type"), Q_FUNC_INFO, [cache](const QDBusVariant &value) {
+        return cache->store(DeviceDescriptorCache::DeviceType, &DeviceDescriptor::deviceType, qdbus_cast<QString>(value.variant()));
+    });
+}
+
+QFuture<QString> Device::getFirmwareVersionAsync()
+{
+    QString firmwareVersion;
+    if (d->descriptorCache->get(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, &firmwareVersion))
+        return readyFuture(firmwareVersion);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("getFirmwareVersion"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::FirmwareVersion, &DeviceDescriptor::firmwareVersion, value);
+    });
+}
+
+QFuture<QString> Device::getKeyboardLayoutAsync()
+{
+    QString keyboardLayout;
+    if (d->descriptorCache->get(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, &keyboardLayout))
+        return readyFuture(keyboardLayout);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QString>(d->asyncCall("getKeyboardLayout"), Q_FUNC_INFO, [cache](const QString &value) {
+        return cache->store(DeviceDescriptorCache::KeyboardLayout, &DeviceDescriptor::keyboardLayout, value);
+    });
+}
+
+QFuture<ushort> Device::getPollRateAsync()
+{
+    return handleDBusPendingReply<ushort>(d->asyncCall("getPollRate"), Q_FUNC_INFO);
+}
+
+QFuture<void> Device::setPollRateAsync(ushort pollrate)
+{
+    return handleVoidDBusPendingReply(d->asyncCall("setPollRate", { QVariant::fromValue(pollrate) }), Q_FUNC_INFO);
+}
+
+QFuture<QVector<ushort>> Device::getSupportedPollRatesAsync()
+{
+    return readyFuture(getSupportedPollRates());
+}
+
+QFuture<void> Device::setDPIAsync(::openrazer::DPI dpi)
+{
+    return handleVoidDBusPendingReply(d->asyncCall("setDPI", { QVariant::fromValue(dpi) }), Q_FUNC_INFO);
+}
+
+QFuture<::openrazer::DPI> Device::getDPIAsync()
+{
+    return handleDBusPendingReply<::openrazer::DPI>(d->asyncCall("getDPI"), Q_FUNC_INFO);
+}
+
+QFuture<void> Device::setDPIStagesAsync(uchar activeStage, QVector<::openrazer::DPI> dpiStages)
+{
+    setDPIStages(activeStage, dpiStages);
+    return readyFuture();
+}
+
+QFuture<QPair<uchar, QVector<::openrazer::DPI>>> Device::getDPIStagesAsync()
+{
+    return readyFuture(getDPIStages());
+}
+
+QFuture<ushort> Device::maxDPIAsync()
+{
+    ushort maxDPI;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, &maxDPI))
+        return readyFuture(maxDPI);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<ushort>(d->asyncCall("getMaxDPI"), Q_FUNC_INFO, [cache](const ushort &value) {
+        return cache->store(DeviceDescriptorCache::MaxDPI, &DeviceDescriptor::maxDPI, value);
+    });
+}
+
+QFuture<QVector<ushort>> Device::getAllowedDPIAsync()
+{
+    return readyFuture(getAllowedDPI());
+}
+
+QFuture<double> Device::getBatteryPercentAsync()
+{
+    return readyFuture(getBatteryPercent());
+}
+
+QFuture<bool> Device::isChargingAsync()
+{
+    return readyFuture(isCharging());
+}
+
+QFuture<ushort> Device::getIdleTimeAsync()
+{
+    return readyFuture(getIdleTime());
+}
+
+QFuture<void> Device::setIdleTimeAsync(ushort idleTime)
+{
+    setIdleTime(idleTime);
+    return readyFuture();
+}
+
+QFuture<double> Device::getLowBatteryThresholdAsync()
+{
+    return readyFuture(getLowBatteryThreshold());
+}
+
+QFuture<void> Device::setLowBatteryThresholdAsync(double threshold)
+{
+    setLowBatteryThreshold(threshold);
+    return readyFuture();
+}
+
+QFuture<void> Device::displayCustomFrameAsync()
+{
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    AsyncCall call = d->asyncCall("displayCustomFrame");
+    d->watchFrameCall(call, start, true);
+    return handleVoidDBusPendingReply(call, Q_FUNC_INFO);
+}
+
+QFuture<void> Device::defineCustomFrameAsync(uchar row, uchar startColumn, uchar endColumn, QVector<::openrazer::RGB> colorData)
+{
+    d->invalidateLedEffects();
+    qint64 start = FrameStats::now();
+    AsyncCall call = d->asyncCall("defineCustomFrame", { QVariant::fromValue(row), QVariant::fromValue(startColumn), QVariant::fromValue(endColumn), QVariant::fromValue(colorData) });
+    d->watchFrameCall(call, start, false);
+    return handleVoidDBusPendingReply(call, Q_FUNC_INFO);
+}
+
+QFuture<::openrazer::MatrixDimensions> Device::getMatrixDimensionsAsync()
+{
+    ::openrazer::MatrixDimensions matrixDimensions;
+    if (d->descriptorCache->get(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, &matrixDimensions))
+        return readyFuture(matrixDimensions);
+    QSharedPointer<DeviceDescriptorCache> cache = d->descriptorCache;
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("MatrixDimensions"), Q_FUNC_INFO, [cache](const QDBusVariant &value) {
+        return cache->store(DeviceDescriptorCache::MatrixDimensions, &DeviceDescriptor::matrixDimensions, qdbus_cast<::openrazer::MatrixDimensions>(value.variant()));
+    });
+}
+
+DeviceSetup DevicePrivate::requestSetup(const QDBusObjectPath &objectPath)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, objectPath.path(), "org.freedesktop.DBus.Properties", "GetAll");
+    message << QStringLiteral("io.github.openrazer1.Device");
+    return { dbusConnection().asyncCall(message) };
+}
+
+QDBusMessage DevicePrivate::call(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Device", method);
+    message.setArguments(arguments);
+    return dbusConnection().call(message);
+}
+
+AsyncCall DevicePrivate::asyncCall(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Device", method);
+    message.setArguments(arguments);
+    return AsyncCall(dbusConnection(), message);
+}
+
+void DevicePrivate::invalidateLedEffects()
+{
+    for (::libopenrazer::Led *led : leds)
+        static_cast<Led *>(led)->d->state->invalidateEffect();
+}
+
+QDBusPendingCall DevicePrivate::frameCall(const AsyncCall &call, qint64 start)
+{
+    QDBusPendingCall pending = call.send();
+    const qint64 sent = call.sentAt();
+    frameStats->record(FrameStats::Marshal, start, sent);
+    pending.waitForFinished();
+    frameStats->record(FrameStats::DBusWait, sent, FrameStats::now());
+    return pending;
+}
+
+void DevicePrivate::watchFrameCall(const AsyncCall &call, qint64 start, bool endFrame)
+{
+    QSharedPointer<FrameStats> stats = frameStats;
+    watchPendingCall(call, [stats, call, start, endFrame](const QDBusPendingCall &) {
+        const qint64 sent = call.sentAt();
+        stats->record(FrameStats::Marshal, start, sent);
+        stats->record(FrameStats::DBusWait, sent, FrameStats::now());
+        // The frame is only shown once the daemon has replied
+        if (endFrame)
+            stats->endFrame();
+    });
+}
+
+QDBusMessage DevicePrivate::property(const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Device") << name;
+    return dbusConnection().call(message);
+}
+
+AsyncCall DevicePrivate::asyncProperty(const QString &name)
+{
+    return asyncProperty(mObjectPath, name);
+}
+
+AsyncCall DevicePrivate::asyncProperty(const QDBusObjectPath &objectPath, const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, objectPath.path(), "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Device") << name;
+    return AsyncCall(dbusConnection(), message);
 }
 
 }
@@ -5,33 +5,85 @@
 #ifndef RAZER_TEST_DEVICE_P_H
 #define RAZER_TEST_DEVICE_P_H
 
+#include "devicedescriptorcache_p.h"
 #include "libopenrazer/device.h"
 #include "libopenrazer/led.h"
+#include "libopenrazer_private.h"
+#include "led_p.h"
 
-#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusPendingReply>
+#include <QSharedPointer>
 
 namespace libopenrazer {
 
 namespace razer_test {
 
+// Properties a Device is constructed from, requested with one GetAll before the Device exists
+struct DeviceSetup {
+    QDBusPendingCall properties;
+};
+
 class DevicePrivate
 {
 public:
     Device *mParent = nullptr;
 
-    QDBusInterface *iface = nullptr;
-    QDBusInterface *deviceIface();
+    QDBusMessage call(const QString &method, const QVariantList &arguments = QVariantList());
+    QDBusMessage property(const QString &name);
+    AsyncCall asyncCall(const QString &method, const QVariantList &arguments = QVariantList());
+    AsyncCall asyncProperty(const QString &name);
+    static AsyncCall asyncProperty(const QDBusObjectPath &objectPath, const QString &name);
+
+    static DeviceSetup requestSetup(const QDBusObjectPath &objectPath);
 
     QDBusObjectPath mObjectPath;
 
     QStringList supportedFx;
     QStringList supportedFeatures;
+    Device::Features features;
 
     QList<::libopenrazer::Led *> leds;
-    QList<QDBusObjectPath> getLedObjectPaths();
 
-    QStringList getSupportedFx();
-    QStringList getSupportedFeatures();
+    // Shared with the callbacks of async custom frame calls which can outlive the Device
+    QSharedPointer<FrameStats> frameStats { new FrameStats };
+    // Record the Marshal stage from start until the call has been sent and DBusWait until its reply
+    // has arrived. frameCall() waits for the reply, watchFrameCall() records once it arrives.
+    QDBusPendingCall frameCall(const AsyncCall &call, qint64 start);
+    void watchFrameCall(const AsyncCall &call, qint64 start, bool endFrame);
+    // Custom frames replace the effect of every LED, their state caches don't know the new one
+    void invalidateLedEffects();
+
+    // Immutable metadata, each field is fetched on first use
+    QSharedPointer<DeviceDescriptorCache> descriptorCache { new DeviceDescriptorCache };
+    DeviceDescriptor getDescriptor();
+    // Called when the device is removed or the daemon has stopped, the data may be different
+    // once it is back
+    void invalidateDescriptor();
+
+    // Descriptor calls that have been sent, but whose replies haven't been waited for yet. Only
+    // fields that aren't cached and whose feature the device has are requested.
+    struct PendingDescriptor {
+        bool requested[DeviceDescriptorCache::FieldCount] = {};
+        QDBusPendingReply<QString> serial;
+        QDBusPendingReply<QDBusVariant> deviceName;
+        QDBusPendingReply<QDBusVariant> deviceType;
+        QDBusPendingReply<QString> firmwareVersion;
+        QDBusPendingReply<QString> keyboardLayout;
+        QDBusPendingReply<ushort> maxDPI;
+        QDBusPendingReply<QDBusVariant> matrixDimensions;
+    };
+    PendingDescriptor requestDescriptor();
+    DeviceDescriptor finishDescriptor(const PendingDescriptor &pending);
+
+    // Snapshot calls that have been sent, but whose replies haven't been waited for yet
+    struct PendingSnapshot {
+        QDBusPendingReply<::openrazer::DPI> dpi;
+        QDBusPendingReply<ushort> pollRate;
+        QList<LedPrivate::PendingSnapshot> leds;
+    };
+    PendingSnapshot requestSnapshot();
+    DeviceSnapshot finishSnapshot(const PendingSnapshot &pending);
 };
 
 }
@@ -7,6 +7,8 @@
 #include "libopenrazer.h"
 #include "libopenrazer_private.h"
 
+#include <QPointer>
+
 namespace libopenrazer {
 
 namespace razer_test {
@@ -15,8 +17,12 @@ Led::Led(Device *device, QDBusObjectPath objectPath)
 {
     d = new LedPrivate();
     d->mParent = this;
+    d->setParent(this);
     d->device = device;
     d->mObjectPath = objectPath;
+
+    // Keeps the cached properties up to date, also for changes made by other applications
+    dbusConnection().connect(OPENRAZER_SERVICE_NAME, objectPath.path(), "org.freedesktop.DBus.Properties", "PropertiesChanged", d, SLOT(propertiesChanged(QString,QVariantMap,QStringList)));
 }
 
 Led::~Led() = default;
@@ -26,6 +32,11 @@ QDBusObjectPath Led::getObjectPath()
     return d->mObjectPath;
 }
 
+::libopenrazer::Device *Led::getDevice()
+{
+    return d->device;
+}
+
 bool Led::hasBrightness()
 {
     return d->hasFx("brightness");
@@ -77,61 +88,82 @@ bool Led::hasFx(::openrazer::Effect fx)
 
 ::openrazer::Effect Led::getCurrentEffect()
 {
-    QVariant reply = d->ledIface()->property("CurrentEffect");
-    return handleDBusVariant<::openrazer::Effect>(reply, d->ledIface()->lastError(), Q_FUNC_INFO);
+    ::openrazer::Effect effect;
+    if (d->state->effect(&effect))
+        return effect;
+    if (d->waitForProperties() && d->state->effect(&effect))
+        return effect;
+    quint64 generation = d->state->generation();
+    QDBusReply<QDBusVariant> reply = d->property("CurrentEffect");
+    effect = handleDBusVariant<::openrazer::Effect>(reply, Q_FUNC_INFO);
+    d->state->storeEffect(effect, generation);
+    return effect;
 }
 
 QVector<::openrazer::RGB> Led::getCurrentColors()
 {
-    QVariant reply = d->ledIface()->property("CurrentColors");
-    return handleDBusVariant<QVector<::openrazer::RGB>>(reply, d->ledIface()->lastError(), Q_FUNC_INFO);
+    QVector<::openrazer::RGB> colors;
+    if (d->state->colors(&colors))
+        return colors;
+    if (d->waitForProperties() && d->state->colors(&colors))
+        return colors;
+    quint64 generation = d->state->generation();
+    QDBusReply<QDBusVariant> reply = d->property("CurrentColors");
+    colors = handleDBusVariant<QVector<::openrazer::RGB>>(reply, Q_FUNC_INFO);
+    d->state->storeColors(colors, generation);
+    return colors;
 }
 
 ::openrazer::WaveDirection Led::getWaveDirection()
 {
+    // The daemon doesn't report it, but the last written one is known
+    ::openrazer::WaveDirection direction;
+    if (d->state->waveDirection(&direction))
+        return direction;
     return ::openrazer::WaveDirection::RIGHT_TO_LEFT; // TODO Needs implementation
 }
 
 ::openrazer::LedId Led::getLedId()
 {
-    QVariant reply = d->ledIface()->property("LedId");
-    return handleDBusVariant<::openrazer::LedId>(reply, d->ledIface()->lastError(), Q_FUNC_INFO);
+    ::openrazer::LedId ledId;
+    if (d->cachedLedId(&ledId))
+        return ledId;
+    if (d->waitForProperties() && d->cachedLedId(&ledId))
+        return ledId;
+    QDBusReply<QDBusVariant> reply = d->property("LedId");
+    ledId = handleDBusVariant<::openrazer::LedId>(reply, Q_FUNC_INFO);
+    d->storeLedId(ledId);
+    return ledId;
 }
 
 void Led::setOff()
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setOff");
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Off), "setOff", {}, Q_FUNC_INFO);
 }
 
 void Led::setOn()
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setOn");
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::On), "setOn", {}, Q_FUNC_INFO);
 }
 
 void Led::setStatic(::openrazer::RGB color)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setStatic", QVariant::fromValue(color));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Static, { color }), "setStatic", { QVariant::fromValue(color) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathing(::openrazer::RGB color)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setBreathing", QVariant::fromValue(color));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Breathing, { color }), "setBreathing", { QVariant::fromValue(color) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathingDual(::openrazer::RGB color, ::openrazer::RGB color2)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setBreathingDual", QVariant::fromValue(color), QVariant::fromValue(color2));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::BreathingDual, { color, color2 }), "setBreathingDual", { QVariant::fromValue(color), QVariant::fromValue(color2) }, Q_FUNC_INFO);
 }
 
 void Led::setBreathingRandom()
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setBreathingRandom");
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::BreathingRandom), "setBreathingRandom", {}, Q_FUNC_INFO);
 }
 
 void Led::setBreathingMono()
@@ -141,20 +173,17 @@ void Led::setBreathingMono()
 
 void Led::setBlinking(::openrazer::RGB color)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setBlinking", QVariant::fromValue(color));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Blinking, { color }), "setBlinking", { QVariant::fromValue(color) }, Q_FUNC_INFO);
 }
 
 void Led::setSpectrum()
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setSpectrum");
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Spectrum), "setSpectrum", {}, Q_FUNC_INFO);
 }
 
 void Led::setWave(::openrazer::WaveDirection direction)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setWave", QVariant::fromValue(direction));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Wave, {}, static_cast<int>(direction)), "setWave", { QVariant::fromValue(direction) }, Q_FUNC_INFO);
 }
 
 void Led::setWheel(::openrazer::WheelDirection direction)
@@ -164,8 +193,7 @@ void Led::setWheel(::openrazer::WheelDirection direction)
 
 void Led::setReactive(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setReactive", QVariant::fromValue(speed), QVariant::fromValue(color));
-    handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->write(LedStateCache::effectWrite(::openrazer::Effect::Reactive, { color }, static_cast<int>(speed)), "setReactive", { QVariant::fromValue(speed), QVariant::fromValue(color) }, Q_FUNC_INFO);
 }
 
 void Led::setRipple(::openrazer::RGB color)
@@ -180,32 +208,400 @@ void Led::setRippleRandom()
 
 void Led::setBrightness(uchar brightness)
 {
-    QDBusReply<bool> reply = d->ledIface()->call("setBrightness", QVariant::fromValue(brightness));
+    quint64 generation;
+    if (!d->state->beginWrite(brightness, &generation))
+        return;
+    QDBusReply<bool> reply = d->call("setBrightness", { QVariant::fromValue(brightness) });
     handleVoidDBusReply(reply, Q_FUNC_INFO);
+    d->state->written(brightness, generation);
 }
 
 uchar Led::getBrightness()
 {
-    QDBusReply<uchar> reply = d->ledIface()->call("getBrightness");
-    return handleDBusReply(reply, Q_FUNC_INFO);
+    uchar brightness;
+    if (d->state->brightness(&brightness))
+        return brightness;
+    quint64 generation = d->state->brightnessGeneration();
+    QDBusReply<uchar> reply = d->call("getBrightness");
+    brightness = handleDBusReply(reply, Q_FUNC_INFO);
+    d->state->storeBrightness(brightness, generation);
+    return brightness;
 }
 
-bool LedPrivate::hasFx(const QString &fxStr)
+void Led::setStateCacheEnabled(bool enabled)
 {
-    return device->d->supportedFx.contains(fxStr);
+    d->state->setEnabled(enabled);
+}
+
+bool Led::isStateCacheEnabled()
+{
+    return d->state->isEnabled();
+}
+
+quint64 Led::suppressedWrites()
+{
+    return d->state->suppressedWrites();
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<::openrazer::Effect> Led::getCurrentEffectAsync()
+{
+    ::openrazer::Effect effect;
+    if (d->state->effect(&effect))
+        return readyFuture(effect);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->generation();
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("CurrentEffect"), Q_FUNC_INFO, [state, generation](const QDBusVariant &value) {
+        auto effect = qdbus_cast<::openrazer::Effect>(value.variant());
+        state->storeEffect(effect, generation);
+        return effect;
+    });
+}
+
+QFuture<QVector<::openrazer::RGB>> Led::getCurrentColorsAsync()
+{
+    QVector<::openrazer::RGB> colors;
+    if (d->state->colors(&colors))
+        return readyFuture(colors);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->generation();
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("CurrentColors"), Q_FUNC_INFO, [state, generation](const QDBusVariant &value) {
+        auto colors = qdbus_cast<QVector<::openrazer::RGB>>(value.variant());
+        state->storeColors(colors, generation);
+        return colors;
+    });
+}
+
+QFuture<::openrazer::WaveDirection> Led::getWaveDirectionAsync()
+{
+    return readyFuture(getWaveDirection());
+}
+
+QFuture<::openrazer::LedId> Led::getLedIdAsync()
+{
+    ::openrazer::LedId ledId;
+    if (d->cachedLedId(&ledId))
+        return readyFuture(ledId);
+    // The Led might be gone once the reply arrives
+    QPointer<LedPrivate> priv(d);
+    return handleDBusPendingReply<QDBusVariant>(d->asyncProperty("LedId"), Q_FUNC_INFO, [priv](const QDBusVariant &value) {
+        auto ledId = qdbus_cast<::openrazer::LedId>(value.variant());
+        if (priv)
+            priv->storeLedId(ledId);
+        return ledId;
+    });
 }
 
-QDBusInterface *LedPrivate::ledIface()
+QFuture<void> Led::setOffAsync()
 {
-    if (iface == nullptr) {
-        iface = new QDBusInterface(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Led",
-                                   OPENRAZER_DBUS_BUS, mParent);
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Off), "setOff", {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setOnAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::On), "setOn", {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setStaticAsync(::openrazer::RGB color)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Static, { color }), "setStatic", { QVariant::fromValue(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingAsync(::openrazer::RGB color)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Breathing, { color }), "setBreathing", { QVariant::fromValue(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingDualAsync(::openrazer::RGB color, ::openrazer::RGB color2)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::BreathingDual, { color, color2 }), "setBreathingDual", { QVariant::fromValue(color), QVariant::fromValue(color2) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingRandomAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::BreathingRandom), "setBreathingRandom", {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setBreathingMonoAsync()
+{
+    // TODO Needs implementation
+    return readyFuture();
+}
+
+QFuture<void> Led::setBlinkingAsync(::openrazer::RGB color)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Blinking, { color }), "setBlinking", { QVariant::fromValue(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setSpectrumAsync()
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Spectrum), "setSpectrum", {}, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setWaveAsync(::openrazer::WaveDirection direction)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Wave, {}, static_cast<int>(direction)), "setWave", { QVariant::fromValue(direction) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setWheelAsync(::openrazer::WheelDirection direction)
+{
+    Q_UNUSED(direction)
+    // TODO Needs implementation
+    return readyFuture();
+}
+
+QFuture<void> Led::setReactiveAsync(::openrazer::RGB color, ::openrazer::ReactiveSpeed speed)
+{
+    return d->asyncWrite(LedStateCache::effectWrite(::openrazer::Effect::Reactive, { color }, static_cast<int>(speed)), "setReactive", { QVariant::fromValue(speed), QVariant::fromValue(color) }, Q_FUNC_INFO);
+}
+
+QFuture<void> Led::setRippleAsync(::openrazer::RGB color)
+{
+    Q_UNUSED(color)
+    // TODO Needs implementation
+    return readyFuture();
+}
+
+QFuture<void> Led::setRippleRandomAsync()
+{
+    // TODO Needs implementation
+    return readyFuture();
+}
+
+QFuture<void> Led::setBrightnessAsync(uchar brightness)
+{
+    quint64 generation;
+    if (!d->state->beginWrite(brightness, &generation))
+        return readyFuture();
+    AsyncCall call = d->asyncCall("setBrightness", { QVariant::fromValue(brightness) });
+    LedStateCache::watchWrite(d->state, call, brightness, generation);
+    return handleVoidDBusPendingReply(call, Q_FUNC_INFO);
+}
+
+QFuture<uchar> Led::getBrightnessAsync()
+{
+    uchar brightness;
+    if (d->state->brightness(&brightness))
+        return readyFuture(brightness);
+    QSharedPointer<LedStateCache> state = d->state;
+    quint64 generation = state->brightnessGeneration();
+    return handleDBusPendingReply<uchar>(d->asyncCall("getBrightness"), Q_FUNC_INFO, [state, generation](uchar brightness) {
+        state->storeBrightness(brightness, generation);
+        return brightness;
+    });
+}
+
+LedPrivate::PendingSnapshot LedPrivate::requestSnapshot()
+{
+    // Only properties that aren't cached need a call
+    PendingSnapshot pending;
+    pending.hasBrightness = mParent->hasBrightness();
+    pending.generation = state->generation();
+    pending.ledIdCached = cachedLedId(&pending.cached.ledId);
+    pending.effectCached = state->effect(&pending.cached.effect);
+    pending.colorsCached = state->colors(&pending.cached.colors);
+    if (!pending.ledIdCached)
+        pending.ledId = asyncProperty("LedId");
+    if (!pending.effectCached)
+        pending.effect = asyncProperty("CurrentEffect");
+    if (!pending.colorsCached)
+        pending.colors = asyncProperty("CurrentColors");
+    if (pending.hasBrightness)
+        pending.brightness = asyncCall("getBrightness");
+    return pending;
+}
+
+LedSnapshot LedPrivate::finishSnapshot(const PendingSnapshot &pending)
+{
+    LedSnapshot snapshot = pending.cached;
+    if (!pending.ledIdCached) {
+        snapshot.ledId = handleDBusVariant<::openrazer::LedId>(QDBusReply<QDBusVariant>(pending.ledId), Q_FUNC_INFO);
+        storeLedId(snapshot.ledId);
+    }
+    if (!pending.effectCached) {
+        snapshot.effect = handleDBusVariant<::openrazer::Effect>(QDBusReply<QDBusVariant>(pending.effect), Q_FUNC_INFO);
+        state->storeEffect(snapshot.effect, pending.generation);
+    }
+    if (!pending.colorsCached) {
+        snapshot.colors = handleDBusVariant<QVector<::openrazer::RGB>>(QDBusReply<QDBusVariant>(pending.colors), Q_FUNC_INFO);
+        state->storeColors(snapshot.colors, pending.generation);
     }
-    if (!iface->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    snapshot.waveDirection = mParent->getWaveDirection();
+    if (pending.hasBrightness)
+        snapshot.brightness = handleDBusReply(QDBusReply<uchar>(pending.brightness), Q_FUNC_INFO);
+    return snapshot;
+}
+
+bool LedPrivate::cachedLedId(::openrazer::LedId *result)
+{
+    QMutexLocker locker(&cacheMutex);
+    if (ledIdValid)
+        *result = ledId;
+    return ledIdValid;
+}
+
+void LedPrivate::storeLedId(::openrazer::LedId value)
+{
+    QMutexLocker locker(&cacheMutex);
+    ledId = value;
+    ledIdValid = true;
+}
+
+void LedPrivate::write(const LedStateCache::EffectWrite &write, const QString &method, const QVariantList &arguments, const char *functionname)
+{
+    quint64 generation;
+    if (!state->beginWrite(write, &generation))
+        return;
+    QDBusReply<bool> reply = call(method, arguments);
+    handleVoidDBusReply(reply, functionname);
+    state->written(write, generation);
+}
+
+QFuture<void> LedPrivate::asyncWrite(const LedStateCache::EffectWrite &write, const QString &method, const QVariantList &arguments, const char *functionname)
+{
+    quint64 generation;
+    if (!state->beginWrite(write, &generation))
+        return readyFuture();
+    AsyncCall pending = asyncCall(method, arguments);
+    LedStateCache::watchWrite(state, pending, write, generation);
+    return handleVoidDBusPendingReply(pending, functionname);
+}
+
+void LedPrivate::propertiesChanged(const QString &interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties)
+{
+    if (interfaceName != QLatin1String("io.github.openrazer1.Led"))
+        return;
+
+    bool effectChanged = false;
+    bool colorsChanged = false;
+    ::openrazer::Effect newEffect = ::openrazer::Effect::Off;
+    QVector<::openrazer::RGB> newColors;
+    auto it = changedProperties.constFind(QStringLiteral("CurrentEffect"));
+    if (it != changedProperties.constEnd()) {
+        newEffect = qdbus_cast<::openrazer::Effect>(it.value());
+        effectChanged = state->changeEffect(newEffect);
     }
-    return iface;
+    it = changedProperties.constFind(QStringLiteral("CurrentColors"));
+    if (it != changedProperties.constEnd()) {
+        newColors = qdbus_cast<QVector<::openrazer::RGB>>(it.value());
+        colorsChanged = state->changeColors(newColors);
+    }
+    // Only the names are sent, fetch the values again with one call
+    if (invalidatedProperties.contains(QStringLiteral("CurrentEffect")) || invalidatedProperties.contains(QStringLiteral("CurrentColors"))) {
+        state->invalidateEffect();
+        loadProperties();
+    }
+
+    if (effectChanged)
+        emit mParent->currentEffectChanged(newEffect);
+    if (colorsChanged)
+        emit mParent->currentColorsChanged(newColors);
+}
+
+void LedPrivate::loadProperties()
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "org.freedesktop.DBus.Properties", "GetAll");
+    message << QStringLiteral("io.github.openrazer1.Led");
+    // Taken before sending, a change reported while the call is on its way makes the reply outdated
+    quint64 generation = state->generation();
+    QDBusPendingCall pending = dbusConnection().asyncCall(message);
+
+    quint64 load;
+    {
+        QMutexLocker locker(&cacheMutex);
+        load = ++propertiesLoad;
+        pendingProperties = pending;
+        propertiesPending = true;
+        propertiesGeneration = generation;
+    }
+
+    // The Led might be gone once the reply arrives
+    QPointer<LedPrivate> priv(this);
+    watchPendingCall(pending, [priv, generation, load](const QDBusPendingCall &call) {
+        if (priv)
+            priv->applyProperties(call, generation, load);
+    });
+}
+
+bool LedPrivate::waitForProperties()
+{
+    QDBusPendingReply<QVariantMap> pending;
+    quint64 generation;
+    quint64 load;
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (!propertiesPending)
+            return false;
+        pending = pendingProperties;
+        generation = propertiesGeneration;
+        load = propertiesLoad;
+    }
+    pending.waitForFinished();
+    applyProperties(pending, generation, load);
+    return true;
+}
+
+void LedPrivate::applyProperties(const QDBusPendingCall &call, quint64 generation, quint64 load)
+{
+    {
+        // Both the watcher and a waiting getter apply the reply, only the first one does the work
+        QMutexLocker locker(&cacheMutex);
+        if (!propertiesPending || load != propertiesLoad)
+            return;
+        propertiesPending = false;
+        pendingProperties = QDBusPendingReply<QVariantMap>();
+    }
+
+    QDBusPendingReply<QVariantMap> reply = call;
+    if (reply.isError()) {
+        // Getters fall back to asking for the single property
+        printDBusError(reply.error(), Q_FUNC_INFO);
+        return;
+    }
+    const QVariantMap properties = reply.value();
+    auto it = properties.constFind(QStringLiteral("LedId"));
+    if (it != properties.constEnd())
+        storeLedId(qdbus_cast<::openrazer::LedId>(it.value()));
+    it = properties.constFind(QStringLiteral("CurrentEffect"));
+    if (it != properties.constEnd())
+        state->storeEffect(qdbus_cast<::openrazer::Effect>(it.value()), generation);
+    it = properties.constFind(QStringLiteral("CurrentColors"));
+    if (it != properties.constEnd())
+        state->storeColors(qdbus_cast<QVector<::openrazer::RGB>>(it.value()), generation);
+}
+
+bool LedPrivate::hasFx(const QString &fxStr)
+{
+    return device->d->supportedFx.contains(fxStr);
+}
+
+QDBusMessage LedPrivate::call(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Led", method);
+    message.setArguments(arguments);
+    return dbusConnection().call(message);
+}
+
+AsyncCall LedPrivate::asyncCall(const QString &method, const QVariantList &arguments)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "io.github.openrazer1.Led", method);
+    message.setArguments(arguments);
+    return AsyncCall(dbusConnection(), message);
+}
+
+QDBusMessage LedPrivate::property(const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Led") << name;
+    return dbusConnection().call(message);
+}
+
+AsyncCall LedPrivate::asyncProperty(const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, mObjectPath.path(), "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Led") << name;
+    return AsyncCall(dbusConnection(), message);
 }
 
 }
@@ -5,26 +5,82 @@
 #ifndef RAZER_TEST_LED_P_H
 #define RAZER_TEST_LED_P_H
 
+#include "ledstatecache_p.h"
 #include "libopenrazer/led.h"
+#include "libopenrazer_private.h"
 
-#include <QDBusInterface>
+#include <QDBusMessage>
+#include <QDBusPendingReply>
+#include <QMutex>
+#include <QVariantMap>
 
 namespace libopenrazer {
 
 namespace razer_test {
 
-class LedPrivate
+class LedPrivate : public QObject
 {
+    Q_OBJECT
 public:
     Led *mParent = nullptr;
 
     bool hasFx(const QString &fxStr);
 
-    QDBusInterface *iface = nullptr;
-    QDBusInterface *ledIface();
+    QDBusMessage call(const QString &method, const QVariantList &arguments = QVariantList());
+    QDBusMessage property(const QString &name);
+    AsyncCall asyncCall(const QString &method, const QVariantList &arguments = QVariantList());
+    AsyncCall asyncProperty(const QString &name);
 
     Device *device;
     QDBusObjectPath mObjectPath;
+
+    // Last known effect, colors and brightness, kept up to date through PropertiesChanged and
+    // successful writes. The daemon doesn't emit PropertiesChanged for every change, so values
+    // expire after LedStateCache::Lifetime and are read again. Shared with the callbacks of async
+    // calls which can outlive the Led.
+    QSharedPointer<LedStateCache> state { new LedStateCache };
+    // Setters go through the state cache, identical writes are skipped
+    void write(const LedStateCache::EffectWrite &write, const QString &method, const QVariantList &arguments, const char *functionname);
+    QFuture<void> asyncWrite(const LedStateCache::EffectWrite &write, const QString &method, const QVariantList &arguments, const char *functionname);
+
+    // The LED id never changes. Guarded by cacheMutex together with the GetAll state below, as the
+    // Led can be used from several threads.
+    QMutex cacheMutex;
+    bool ledIdValid = false;
+    ::openrazer::LedId ledId;
+    bool cachedLedId(::openrazer::LedId *result);
+    void storeLedId(::openrazer::LedId value);
+
+    // All properties are requested with one GetAll when the Led is set up and when the daemon has
+    // invalidated some of them. Getters wait for a running GetAll instead of sending their own Get.
+    QDBusPendingReply<QVariantMap> pendingProperties;
+    bool propertiesPending = false;
+    quint64 propertiesGeneration = 0;
+    // Identifies the latest GetAll, replies of older ones are dropped
+    quint64 propertiesLoad = 0;
+    void loadProperties();
+    bool waitForProperties();
+    void applyProperties(const QDBusPendingCall &call, quint64 generation, quint64 load);
+
+    // Snapshot calls that have been sent, but whose replies haven't been waited for yet
+    struct PendingSnapshot {
+        bool hasBrightness = false;
+        quint64 generation = 0;
+        // Cached properties are taken from here instead of being requested
+        LedSnapshot cached;
+        bool ledIdCached = false;
+        bool effectCached = false;
+        bool colorsCached = false;
+        QDBusPendingReply<QDBusVariant> ledId;
+        QDBusPendingReply<QDBusVariant> effect;
+        QDBusPendingReply<QDBusVariant> colors;
+        QDBusPendingReply<uchar> brightness;
+    };
+    PendingSnapshot requestSnapshot();
+    LedSnapshot finishSnapshot(const PendingSnapshot &pending);
+
+public slots:
+    void propertiesChanged(const QString &interfaceName, const QVariantMap &changedProperties, const QStringList &invalidatedProperties);
 };
 
 }
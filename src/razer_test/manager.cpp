@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include "device_p.h"
 #include "libopenrazer.h"
 #include "libopenrazer_private.h"
 #include "manager_p.h"
@@ -14,18 +15,36 @@ namespace libopenrazer {
 
 namespace razer_test {
 
+const char *OPENRAZER_SERVICE_NAME = "io.github.openrazer1";
+
+QDBusConnection dbusConnection()
+{
+    static const QDBusConnection connection = IoThread::isEnabled()
+            ? QDBusConnection::connectToBus(RAZER_TEST_DBUS_BUS_TYPE, QStringLiteral("libopenrazer-razer_test"))
+            : RAZER_TEST_DBUS_BUS;
+    return connection;
+}
+
 Manager::Manager()
 {
     d = new ManagerPrivate();
     d->mParent = this;
+    d->setParent(this);
 
     // Register the enums with the Qt system
     ::openrazer::registerMetaTypes();
+
+    // Track the connected devices for deviceAdded() and deviceRemoved(), this also drops removed shared devices
+    dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "io.github.openrazer1.Manager", "devicesChanged", d, SLOT(devicesChanged()));
+    auto *watcher = new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, dbusConnection(), QDBusServiceWatcher::WatchForRegistration | QDBusServiceWatcher::WatchForUnregistration, d);
+    QObject::connect(watcher, &QDBusServiceWatcher::serviceRegistered, d, &ManagerPrivate::devicesChanged);
+    QObject::connect(watcher, &QDBusServiceWatcher::serviceUnregistered, d, &ManagerPrivate::daemonStopped);
+    d->refreshDevices(false);
 }
 
 bool Manager::isDaemonRunning()
 {
-    QVariant reply = d->managerIface()->property("Version");
+    QDBusReply<QDBusVariant> reply = d->property("Version");
     return reply.isValid();
 }
 
@@ -36,13 +55,55 @@ QVariantHash Manager::getSupportedDevices()
 
 QList<QDBusObjectPath> Manager::getDevices()
 {
-    QVariant reply = d->managerIface()->property("Devices");
-    return handleDBusVariant<QList<QDBusObjectPath>>(reply, d->managerIface()->lastError(), Q_FUNC_INFO);
+    QDBusReply<QDBusVariant> reply = d->property("Devices");
+    return handleDBusVariant<QList<QDBusObjectPath>>(reply, Q_FUNC_INFO);
+}
+
+QSharedPointer<::libopenrazer::Device> Manager::getDevice(QDBusObjectPath objectPath)
+{
+    {
+        QMutexLocker locker(&d->devicesMutex);
+        auto it = d->devices.constFind(objectPath.path());
+        if (it != d->devices.constEnd())
+            return it.value();
+    }
+    return d->sharedDevices({ objectPath }).first();
+}
+
+QList<QSharedPointer<::libopenrazer::Device>> Manager::getAllDevices()
+{
+    const QList<QSharedPointer<Device>> devices = d->sharedDevices(getDevices());
+
+    // Request the metadata all devices don't have yet before waiting for the first reply
+    QList<DevicePrivate::PendingDescriptor> descriptors;
+    for (const QSharedPointer<Device> &device : devices)
+        descriptors.append(device->d->requestDescriptor());
+    for (int i = 0; i < devices.size(); i++) {
+        try {
+            devices.at(i)->d->finishDescriptor(descriptors.at(i));
+        } catch (const DBusException &) {
+            // Already printed, failed fields get requested again on first use
+        }
+    }
+
+    QList<QSharedPointer<::libopenrazer::Device>> ret;
+    for (const QSharedPointer<Device> &device : devices)
+        ret.append(device);
+    return ret;
 }
 
-Device *Manager::getDevice(QDBusObjectPath objectPath)
+QVector<DeviceSnapshot> Manager::snapshotAll(const QList<QSharedPointer<::libopenrazer::Device>> &devices)
 {
-    return new Device(objectPath);
+    // Send the calls of all devices before waiting for the first reply
+    QList<DevicePrivate::PendingSnapshot> pending;
+    for (const QSharedPointer<::libopenrazer::Device> &device : devices)
+        pending.append(static_cast<Device *>(device.data())->d->requestSnapshot());
+
+    QVector<DeviceSnapshot> snapshots;
+    snapshots.reserve(devices.size());
+    for (int i = 0; i < devices.size(); i++)
+        snapshots.append(static_cast<Device *>(devices.at(i).data())->d->finishSnapshot(pending.at(i)));
+    return snapshots;
 }
 
 void Manager::syncEffects(bool yes)
@@ -57,8 +118,8 @@ bool Manager::getSyncEffects()
 
 QString Manager::getDaemonVersion()
 {
-    QVariant reply = d->managerIface()->property("Version");
-    return handleDBusVariant<QString>(reply, d->managerIface()->lastError(), Q_FUNC_INFO);
+    QDBusReply<QDBusVariant> reply = d->property("Version");
+    return handleDBusVariant<QString>(reply, Q_FUNC_INFO);
 }
 
 void Manager::setTurnOffOnScreensaver(bool turnOffOnScreensaver)
@@ -127,25 +188,225 @@ bool Manager::enableDaemon()
 // TODO New Qt5 connect style syntax - maybe https://stackoverflow.com/a/35501065/3527128
 bool Manager::connectDevicesChanged(QObject *receiver, const char *slot)
 {
-    return OPENRAZER_DBUS_BUS.connect(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "io.github.openrazer1.Manager", "devicesChanged", receiver, slot);
+    return dbusConnection().connect(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "io.github.openrazer1.Manager", "devicesChanged", receiver, slot);
 }
 
 QDBusServiceWatcher *Manager::getServiceWatcher()
 {
-    return new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, OPENRAZER_DBUS_BUS);
+    return new QDBusServiceWatcher(OPENRAZER_SERVICE_NAME, dbusConnection());
+}
+
+// ----- ASYNC DBUS METHODS -----
+
+QFuture<QList<QDBusObjectPath>> Manager::getDevicesAsync()
+{
+    return handleDBusPendingVariant<QList<QDBusObjectPath>>(d->asyncProperty("Devices"), Q_FUNC_INFO);
+}
+
+QFuture<QString> Manager::getDaemonVersionAsync()
+{
+    return handleDBusPendingVariant<QString>(d->asyncProperty("Version"), Q_FUNC_INFO);
+}
+
+QFuture<bool> Manager::isDaemonRunningAsync()
+{
+    // Not running is a valid result here and not an error
+    QFutureInterface<bool> future(QFutureInterfaceBase::Started);
+    watchPendingCall(d->asyncProperty("Version"), [future](const QDBusPendingCall &call) mutable {
+        bool running = !call.isError();
+        future.reportFinished(&running);
+    });
+    return future.future();
+}
+
+QFuture<QVariantHash> Manager::getSupportedDevicesAsync()
+{
+    return readyFuture(getSupportedDevices());
+}
+
+QFuture<void> Manager::syncEffectsAsync(bool yes)
+{
+    syncEffects(yes);
+    return readyFuture();
 }
 
-QDBusInterface *ManagerPrivate::managerIface()
+QFuture<bool> Manager::getSyncEffectsAsync()
 {
-    if (iface == nullptr) {
-        iface = new QDBusInterface(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "io.github.openrazer1.Manager",
-                                   OPENRAZER_DBUS_BUS, mParent);
+    return readyFuture(getSyncEffects());
+}
+
+QFuture<void> Manager::setTurnOffOnScreensaverAsync(bool turnOffOnScreensaver)
+{
+    setTurnOffOnScreensaver(turnOffOnScreensaver);
+    return readyFuture();
+}
+
+QFuture<bool> Manager::getTurnOffOnScreensaverAsync()
+{
+    return readyFuture(getTurnOffOnScreensaver());
+}
+
+QList<QSharedPointer<Device>> ManagerPrivate::sharedDevices(const QList<QDBusObjectPath> &objectPaths)
+{
+    // Request the properties of all devices that aren't cached yet before waiting for the first reply
+    QList<QDBusObjectPath> missing;
+    {
+        QMutexLocker locker(&devicesMutex);
+        for (const QDBusObjectPath &objectPath : objectPaths) {
+            if (!devices.contains(objectPath.path()) && !missing.contains(objectPath))
+                missing.append(objectPath);
+        }
     }
-    if (!iface->isValid()) {
-        fprintf(stderr, "%s\n",
-                qPrintable(OPENRAZER_DBUS_BUS.lastError().message()));
+    QList<DeviceSetup> setups;
+    for (const QDBusObjectPath &objectPath : missing)
+        setups.append(DevicePrivate::requestSetup(objectPath));
+
+    QList<Device *> created;
+    try {
+        for (int i = 0; i < missing.size(); i++)
+            created.append(new Device(missing.at(i), setups.at(i)));
+    } catch (const DBusException &) {
+        qDeleteAll(created);
+        throw;
+    }
+
+    QMutexLocker locker(&devicesMutex);
+    for (int i = 0; i < missing.size(); i++) {
+        // Another thread might have been faster, all callers get the same device
+        if (devices.contains(missing.at(i).path()))
+            delete created.at(i);
+        else
+            devices.insert(missing.at(i).path(), QSharedPointer<Device>(created.at(i)));
     }
-    return iface;
+
+    QList<QSharedPointer<Device>> ret;
+    for (const QDBusObjectPath &objectPath : objectPaths)
+        ret.append(devices.value(objectPath.path()));
+    return ret;
+}
+
+void ManagerPrivate::refreshDevices(bool notify)
+{
+    auto *watcher = new QDBusPendingCallWatcher(asyncProperty("Devices"), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, notify](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QDBusVariant> reply = *watcher;
+        watcher->deleteLater();
+        // Not running, devices get reported once it has started
+        if (reply.isError())
+            return;
+        updateDevices(qdbus_cast<QList<QDBusObjectPath>>(reply.value().variant()), notify);
+    });
+}
+
+void ManagerPrivate::addDevice(const QDBusObjectPath &objectPath)
+{
+    DeviceSetup setup = DevicePrivate::requestSetup(objectPath);
+    // Once the reply is there the device can be set up without waiting
+    auto *watcher = new QDBusPendingCallWatcher(setup.properties, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, objectPath, setup](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QSharedPointer<Device> device;
+        {
+            QMutexLocker locker(&devicesMutex);
+            // Removed again in the meantime
+            if (!knownDevices.contains(objectPath.path()))
+                return;
+            // getDevice() might have been faster
+            device = devices.value(objectPath.path());
+            if (device.isNull()) {
+                try {
+                    // The properties have already arrived, so this doesn't wait for the daemon
+                    device = QSharedPointer<Device>(new Device(objectPath, setup));
+                } catch (const DBusException &) {
+                    // Already printed
+                    return;
+                }
+                devices.insert(objectPath.path(), device);
+            }
+        }
+        emit mParent->deviceAdded(device);
+    });
+}
+
+void ManagerPrivate::devicesChanged()
+{
+    refreshDevices(true);
+}
+
+void ManagerPrivate::updateDevices(const QList<QDBusObjectPath> &objectPaths, bool notify)
+{
+    QSet<QString> connected;
+    for (const QDBusObjectPath &objectPath : objectPaths)
+        connected.insert(objectPath.path());
+
+    QList<QDBusObjectPath> removed;
+    QList<QDBusObjectPath> added;
+    {
+        QMutexLocker locker(&devicesMutex);
+        // Shared devices can also be created before the initial list has arrived, so check all of them
+        for (auto it = devices.begin(); it != devices.end();) {
+            if (connected.contains(it.key())) {
+                ++it;
+            } else {
+                // Applications can still hold the device, don't let them see data of the old connection
+                it.value()->d->invalidateDescriptor();
+                it = devices.erase(it);
+            }
+        }
+
+        for (auto it = knownDevices.begin(); it != knownDevices.end();) {
+            if (connected.contains(*it)) {
+                ++it;
+            } else {
+                removed.append(QDBusObjectPath(*it));
+                it = knownDevices.erase(it);
+            }
+        }
+        for (const QDBusObjectPath &objectPath : objectPaths) {
+            if (!knownDevices.contains(objectPath.path())) {
+                knownDevices.insert(objectPath.path());
+                added.append(objectPath);
+            }
+        }
+    }
+
+    if (!notify)
+        return;
+    for (const QDBusObjectPath &objectPath : removed)
+        emit mParent->deviceRemoved(objectPath);
+    // Only the new devices are set up, the others stay untouched
+    for (const QDBusObjectPath &objectPath : added)
+        addDevice(objectPath);
+}
+
+void ManagerPrivate::daemonStopped()
+{
+    QSet<QString> removed;
+    {
+        QMutexLocker locker(&devicesMutex);
+        // The devices may have changed (e.g. a firmware update) once the daemon is back
+        for (const QSharedPointer<Device> &device : devices)
+            device->d->invalidateDescriptor();
+        devices.clear();
+        removed = knownDevices;
+        knownDevices.clear();
+    }
+    for (const QString &objectPath : removed)
+        emit mParent->deviceRemoved(QDBusObjectPath(objectPath));
+}
+
+QDBusMessage ManagerPrivate::property(const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Manager") << name;
+    return dbusConnection().call(message);
+}
+
+AsyncCall ManagerPrivate::asyncProperty(const QString &name)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(OPENRAZER_SERVICE_NAME, "/io/github/openrazer1", "org.freedesktop.DBus.Properties", "Get");
+    message << QStringLiteral("io.github.openrazer1.Manager") << name;
+    return AsyncCall(dbusConnection(), message);
 }
 
 }
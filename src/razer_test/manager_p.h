@@ -6,13 +6,22 @@
 #define RAZER_TEST_MANAGER_P_H
 
 #include "libopenrazer/manager.h"
+#include "libopenrazer_private.h"
 
-#include <QDBusInterface>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
 
 #if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
 #define RAZER_TEST_DBUS_BUS QDBusConnection::systemBus()
+#define RAZER_TEST_DBUS_BUS_TYPE QDBusConnection::SystemBus
 #elif defined(Q_OS_DARWIN) || defined(Q_OS_WIN)
 #define RAZER_TEST_DBUS_BUS QDBusConnection::sessionBus()
+#define RAZER_TEST_DBUS_BUS_TYPE QDBusConnection::SessionBus
 #else
 #error "Please choose a RAZER_TEST_DBUS_BUS for this platform!"
 #endif
@@ -21,16 +30,34 @@ namespace libopenrazer {
 
 namespace razer_test {
 
-const char *OPENRAZER_SERVICE_NAME = "io.github.openrazer1";
-QDBusConnection OPENRAZER_DBUS_BUS = RAZER_TEST_DBUS_BUS;
+class Device;
 
-class ManagerPrivate
+class ManagerPrivate : public QObject
 {
+    Q_OBJECT
 public:
     Manager *mParent = nullptr;
 
-    QDBusInterface *iface = nullptr;
-    QDBusInterface *managerIface();
+    QDBusMessage property(const QString &name);
+    AsyncCall asyncProperty(const QString &name);
+
+    // Guards devices and knownDevices, getDevice() and getAllDevices() can be called from several
+    // threads. Not held while talking to the daemon or emitting signals.
+    QMutex devicesMutex;
+    // Devices handed out by the Manager by object path, until the daemon removes them
+    QHash<QString, QSharedPointer<Device>> devices;
+    QList<QSharedPointer<Device>> sharedDevices(const QList<QDBusObjectPath> &objectPaths);
+
+    // Object paths of the connected devices, kept up to date from the daemon signals
+    QSet<QString> knownDevices;
+    void refreshDevices(bool notify);
+    void updateDevices(const QList<QDBusObjectPath> &objectPaths, bool notify);
+    // Sets up a newly connected device in the background, then emits deviceAdded()
+    void addDevice(const QDBusObjectPath &objectPath);
+
+public slots:
+    void devicesChanged();
+    void daemonStopped();
 };
 
 }
@@ -0,0 +1,142 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/reactiveengine.h"
+
+#include "libopenrazer/dbusexception.h"
+#include "libopenrazer/device.h"
+#include "libopenrazer/effects.h"
+#include "libopenrazer/geometry.h"
+#include "libopenrazer/keyeventsource.h"
+#include "libopenrazer/tickscheduler.h"
+
+namespace libopenrazer {
+
+// KEY_MAX from linux/input-event-codes.h
+static const int KeyCodeCount = 0x2ff + 1;
+
+ReactiveEngine::ReactiveEngine(Device *device, const DeviceGeometry *geometry, KeyEventSource *source, QObject *parent)
+    : QObject(parent), m_device(device), m_source(source),
+      m_frame(geometry != nullptr ? geometry->dimensions : ::openrazer::MatrixDimensions { 0, 0 }),
+      m_keyIndex(KeyCodeCount, -1), m_intensity(m_frame.rows() * m_frame.columns(), 0)
+{
+    if (geometry == nullptr || geometry->keyCodes == nullptr)
+        return;
+
+    // Build the layout index once, key presses are a plain array access afterwards
+    for (int i = 0; i < m_intensity.size(); i++) {
+        ushort code = geometry->keyCodes[i];
+        if (code != 0 && code < KeyCodeCount)
+            m_keyIndex[code] = static_cast<short>(i);
+    }
+}
+
+ReactiveEngine::~ReactiveEngine()
+{
+    stop();
+}
+
+void ReactiveEngine::setColors(::openrazer::RGB color, ::openrazer::RGB background)
+{
+    m_color = color;
+    m_background = background;
+}
+
+void ReactiveEngine::setFadeDuration(int msec)
+{
+    m_fadeDuration = qMax(1, msec);
+}
+
+void ReactiveEngine::start()
+{
+    if (m_connection)
+        return;
+    m_connection = connect(m_source, &KeyEventSource::keyPressed, this, &ReactiveEngine::keyPressed);
+    m_frame.markDirty();
+    render();
+    upload();
+}
+
+void ReactiveEngine::stop()
+{
+    disconnect(m_connection);
+    m_connection = QMetaObject::Connection();
+    if (m_subscription != 0) {
+        TickScheduler::instance()->unsubscribe(m_subscription);
+        m_subscription = 0;
+    }
+}
+
+const Histogram &ReactiveEngine::latency() const
+{
+    return m_latency;
+}
+
+void ReactiveEngine::keyPressed(ushort code, qint64 timestamp)
+{
+    if (code >= KeyCodeCount || m_keyIndex.at(code) < 0)
+        return;
+
+    uchar &intensity = m_intensity[m_keyIndex.at(code)];
+    if (intensity == 0)
+        m_litCells++;
+    intensity = 255;
+
+    // Send the key press right away instead of waiting for the next tick
+    render();
+    m_latency.record(FrameStats::now() - timestamp);
+    upload();
+
+    if (m_subscription == 0) {
+        m_subscription = TickScheduler::instance()->subscribe(this, 1, [this](quint64) {
+            tick();
+        });
+    }
+}
+
+void ReactiveEngine::tick()
+{
+    int step = qMax(1, 255 * TickScheduler::instance()->baseInterval() / m_fadeDuration);
+    for (uchar &intensity : m_intensity) {
+        if (intensity == 0)
+            continue;
+        if (intensity <= step) {
+            intensity = 0;
+            m_litCells--;
+        } else {
+            intensity -= step;
+        }
+    }
+
+    render();
+    upload();
+
+    // Nothing left to fade, let the scheduler go idle
+    if (m_litCells == 0) {
+        TickScheduler::instance()->unsubscribe(m_subscription);
+        m_subscription = 0;
+    }
+}
+
+void ReactiveEngine::render()
+{
+    int i = 0;
+    for (uchar row = 0; row < m_frame.rows(); row++) {
+        for (uchar column = 0; column < m_frame.columns(); column++, i++) {
+            m_frame.setPixel(row, column, blendColors(m_background, m_color, m_intensity.at(i)));
+        }
+    }
+}
+
+void ReactiveEngine::upload()
+{
+    try {
+        m_frame.upload(m_device);
+    } catch (const DBusException &) {
+        // Already printed by libopenrazer, try again with the next frame
+        m_frame.markDirty();
+    }
+}
+
+}
@@ -0,0 +1,164 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/scrollingtext.h"
+
+#include "libopenrazer/customframe.h"
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPainter>
+
+namespace libopenrazer {
+
+static int horizontalAdvance(const QFontMetrics &metrics, QChar c)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    return metrics.horizontalAdvance(c);
+#else
+    return metrics.width(c);
+#endif
+}
+
+const GlyphAtlas *GlyphAtlas::forHeight(int height)
+{
+    static QMutex mutex;
+    static QHash<int, GlyphAtlas *> atlases;
+
+    height = qBound(1, height, 32);
+    QMutexLocker locker(&mutex);
+    GlyphAtlas *atlas = atlases.value(height);
+    if (atlas == nullptr) {
+        atlas = new GlyphAtlas(height);
+        atlases.insert(height, atlas);
+    }
+    return atlas;
+}
+
+GlyphAtlas::GlyphAtlas(int height)
+    : m_height(height)
+{
+    QFont font;
+    font.setStyleStrategy(QFont::NoAntialias);
+    // Use the largest font that still fits into the matrix
+    int pixelSize = height;
+    font.setPixelSize(pixelSize);
+    while (pixelSize > 1 && QFontMetrics(font).height() > height) {
+        font.setPixelSize(--pixelSize);
+    }
+    QFontMetrics metrics(font);
+
+    for (ushort c = FirstChar; c <= LastChar; c++) {
+        QChar ch(c);
+        int width = qMax(1, horizontalAdvance(metrics, ch));
+
+        QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(0, metrics.ascent(), QString(ch));
+        painter.end();
+
+        m_offsets[c - FirstChar] = m_columns.size();
+        for (int x = 0; x < width; x++) {
+            quint32 column = 0;
+            for (int y = 0; y < height; y++) {
+                if (qAlpha(image.pixel(x, y)) >= 128)
+                    column |= 1u << y;
+            }
+            m_columns.append(column);
+        }
+    }
+    m_offsets[LastChar - FirstChar + 1] = m_columns.size();
+}
+
+int GlyphAtlas::glyphIndex(QChar c) const
+{
+    ushort unicode = c.unicode();
+    if (unicode < FirstChar || unicode > LastChar)
+        unicode = '?';
+    return unicode - FirstChar;
+}
+
+int GlyphAtlas::height() const
+{
+    return m_height;
+}
+
+int GlyphAtlas::glyphWidth(QChar c) const
+{
+    int index = glyphIndex(c);
+    return m_offsets[index + 1] - m_offsets[index];
+}
+
+const quint32 *GlyphAtlas::glyphColumns(QChar c) const
+{
+    return m_columns.constData() + m_offsets[glyphIndex(c)];
+}
+
+ScrollingText::ScrollingText(const GlyphAtlas *atlas)
+    : m_atlas(atlas), m_foreground { 255, 255, 255 }, m_background { 0, 0, 0 }, m_offset(0)
+{
+}
+
+void ScrollingText::setText(const QString &text, int gap)
+{
+    m_strip.clear();
+    for (const QChar &c : text) {
+        const quint32 *columns = m_atlas->glyphColumns(c);
+        int width = m_atlas->glyphWidth(c);
+        for (int i = 0; i < width; i++)
+            m_strip.append(columns[i]);
+    }
+    for (int i = 0; i < gap; i++)
+        m_strip.append(0);
+    m_offset = 0;
+}
+
+void ScrollingText::setColors(::openrazer::RGB foreground, ::openrazer::RGB background)
+{
+    m_foreground = foreground;
+    m_background = background;
+}
+
+int ScrollingText::length() const
+{
+    return m_strip.size();
+}
+
+void ScrollingText::setOffset(int offset)
+{
+    m_offset = m_strip.isEmpty() ? 0 : ((offset % m_strip.size()) + m_strip.size()) % m_strip.size();
+}
+
+int ScrollingText::offset() const
+{
+    return m_offset;
+}
+
+void ScrollingText::advance(int columns)
+{
+    setOffset(m_offset + columns);
+}
+
+void ScrollingText::render(CustomFrame *frame) const
+{
+    const int rows = qMin<int>(frame->rows(), m_atlas->height());
+    const int length = m_strip.size();
+    int index = m_offset;
+    for (uchar column = 0; column < frame->columns(); column++) {
+        quint32 bits = length == 0 ? 0 : m_strip.at(index);
+        for (int row = 0; row < rows; row++) {
+            frame->setPixel(row, column, (bits & (1u << row)) ? m_foreground : m_background);
+        }
+        if (++index >= length)
+            index = 0;
+    }
+}
+
+}
@@ -0,0 +1,473 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/systemmetrics.h"
+
+#include "libopenrazer/customframe.h"
+#include "libopenrazer/dbusexception.h"
+#include "libopenrazer/effects.h"
+#include "libopenrazer/framestats.h"
+#include "libopenrazer/led.h"
+
+#include <QByteArray>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace libopenrazer {
+
+namespace {
+
+// Zone colors are only written when they change by more than this
+const int ZoneColorStep = 16;
+
+const char *const procFiles[] = {
+    "/stat",
+    "/meminfo",
+    "/diskstats",
+    "/net/dev",
+};
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p))
+        p++;
+    return p;
+}
+
+const char *skipField(const char *p, const char *end)
+{
+    p = skipSpaces(p, end);
+    while (p < end && !isSpace(*p) && *p != '\n')
+        p++;
+    return p;
+}
+
+const char *lineEnd(const char *p, const char *end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    return p;
+}
+
+const char *nextLine(const char *p, const char *end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    return p < end ? p + 1 : end;
+}
+
+const char *parseNumber(const char *p, const char *end, quint64 *value)
+{
+    p = skipSpaces(p, end);
+    quint64 result = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        result = result * 10 + static_cast<quint64>(*p++ - '0');
+    *value = result;
+    return p;
+}
+
+bool startsWith(const char *p, const char *end, const char *prefix)
+{
+    while (*prefix != '\0') {
+        if (p == end || *p++ != *prefix++)
+            return false;
+    }
+    return true;
+}
+
+// Block devices that aren't disks: loop devices (major 7, their partitions have other majors), RAM
+// disks (major 1) and zram. Snap based systems have dozens of loop devices, which are listed before
+// the real disks.
+bool isVirtualDisk(quint64 major, const char *name, const char *nameEnd)
+{
+    return major == 7 || major == 1 || startsWith(name, nameEnd, "loop") || startsWith(name, nameEnd, "ram") || startsWith(name, nameEnd, "zram");
+}
+
+// Returns if name is a partition of disk, e.g. sda1 of sda or nvme0n1p1 of nvme0n1
+bool isPartition(const char *disk, int diskLength, const char *name, const char *nameEnd)
+{
+    if (diskLength == 0 || nameEnd - name <= diskLength || std::memcmp(disk, name, diskLength) != 0)
+        return false;
+    const char *p = name + diskLength;
+    // Disks whose name ends with a number separate the partition number with a p
+    if (disk[diskLength - 1] >= '0' && disk[diskLength - 1] <= '9' && *p++ != 'p')
+        return false;
+    if (p == nameEnd)
+        return false;
+    for (; p < nameEnd; p++) {
+        if (*p < '0' || *p > '9')
+            return false;
+    }
+    return true;
+}
+
+uchar ratio(quint64 part, quint64 total)
+{
+    if (total == 0)
+        return 0;
+    return static_cast<uchar>(qMin<quint64>(part, total) * 255 / total);
+}
+
+}
+
+SystemMetrics::SystemMetrics()
+    : SystemMetrics("/proc")
+{
+}
+
+SystemMetrics::SystemMetrics(const char *procPath)
+{
+    for (int i = 0; i < FileCount; i++) {
+#ifdef Q_OS_LINUX
+        m_fds[i] = ::open((QByteArray(procPath) + procFiles[i]).constData(), O_RDONLY | O_CLOEXEC);
+#else
+        Q_UNUSED(procPath)
+        Q_UNUSED(procFiles)
+        m_fds[i] = -1;
+#endif
+    }
+}
+
+SystemMetrics::~SystemMetrics()
+{
+#ifdef Q_OS_LINUX
+    for (int fd : m_fds) {
+        if (fd >= 0)
+            ::close(fd);
+    }
+#endif
+}
+
+bool SystemMetrics::sample()
+{
+    qint64 now = FrameStats::now();
+    qint64 elapsed = m_lastSample != 0 ? now - m_lastSample : 0;
+    m_lastSample = now;
+
+    bool ok = sampleCpu();
+    ok &= sampleMemory();
+    ok &= sampleDisk(elapsed);
+    ok &= sampleNetwork(elapsed);
+    return ok;
+}
+
+int SystemMetrics::coreCount() const
+{
+    return m_coreCount;
+}
+
+uchar SystemMetrics::coreLoad(int core) const
+{
+    return core >= 0 && core < m_coreCount ? m_coreLoad[core] : 0;
+}
+
+uchar SystemMetrics::value(Metric metric) const
+{
+    return m_values[metric];
+}
+
+void SystemMetrics::setNetworkCapacity(quint64 bytesPerSecond)
+{
+    m_networkCapacity = qMax<quint64>(1, bytesPerSecond);
+}
+
+quint64 SystemMetrics::networkCapacity() const
+{
+    return m_networkCapacity;
+}
+
+void SystemMetrics::setColors(::openrazer::RGB low, ::openrazer::RGB high, ::openrazer::RGB background)
+{
+    m_low = low;
+    m_high = high;
+    m_background = background;
+}
+
+int SystemMetrics::readFile(File file, bool complete)
+{
+#ifdef Q_OS_LINUX
+    // /proc files are generated on read, reading from offset 0 of the open descriptor gets fresh values.
+    // They are read in pieces of at most a page, so read until the end of the file.
+    if (m_fds[file] < 0)
+        return -1;
+    int size = 0;
+    while (size < static_cast<int>(sizeof(m_buffer))) {
+        ssize_t count = ::pread(m_fds[file], m_buffer + size, sizeof(m_buffer) - size, size);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return -1;
+        if (count == 0)
+            return size;
+        size += static_cast<int>(count);
+    }
+    // The buffer is full, the rest of the file doesn't fit
+    return complete ? -1 : size;
+#else
+    Q_UNUSED(file)
+    Q_UNUSED(complete)
+    return -1;
+#endif
+}
+
+void SystemMetrics::beginCounters(CounterSet *set)
+{
+    for (int i = 0; i < set->count; i++)
+        set->counters[i].seen = false;
+}
+
+bool SystemMetrics::updateCounter(CounterSet *set, const char *name, int nameLength, quint64 value, quint64 *delta)
+{
+    if (nameLength <= 0 || nameLength > static_cast<int>(sizeof(Counter::name)))
+        return false;
+
+    for (int i = 0; i < set->count; i++) {
+        Counter &counter = set->counters[i];
+        if (counter.nameLength == nameLength && std::memcmp(counter.name, name, nameLength) == 0) {
+            // Counters can wrap or get reset
+            *delta = value >= counter.value ? value - counter.value : 0;
+            counter.value = value;
+            counter.seen = true;
+            return true;
+        }
+    }
+
+    // New device, it gets a delta with the next sample
+    if (set->count < MaxCounters) {
+        Counter &counter = set->counters[set->count++];
+        std::memcpy(counter.name, name, nameLength);
+        counter.nameLength = nameLength;
+        counter.value = value;
+        counter.seen = true;
+    }
+    return false;
+}
+
+void SystemMetrics::endCounters(CounterSet *set)
+{
+    // Forget removed devices, so their slots can be reused
+    int count = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (set->counters[i].seen)
+            set->counters[count++] = set->counters[i];
+    }
+    set->count = count;
+}
+
+bool SystemMetrics::sampleCpu()
+{
+    // Only the cpu lines at the start are needed, a cut off line is skipped below
+    int size = readFile(Stat, false);
+    if (size <= 0)
+        return false;
+    const char *p = m_buffer;
+    const char *end = m_buffer + size;
+
+    quint64 busySum = 0;
+    quint64 totalSum = 0;
+    int core = 0;
+    // The first line is the sum of all cores, which is calculated from the cores instead
+    for (p = nextLine(p, end); core < MaxCores && startsWith(p, end, "cpu"); p = nextLine(p, end)) {
+        const char *line = lineEnd(p, end);
+        // Line got cut off by the buffer size
+        if (line == end)
+            break;
+
+        // cpuN user nice system idle iowait irq softirq steal
+        const char *field = skipField(p, line);
+        quint64 total = 0;
+        quint64 idle = 0;
+        for (int i = 0; i < 8; i++) {
+            quint64 value;
+            field = parseNumber(field, line, &value);
+            total += value;
+            if (i == 3 || i == 4)
+                idle += value;
+        }
+        quint64 busy = total - idle;
+
+        quint64 busyDelta = busy - m_coreBusy[core];
+        quint64 totalDelta = total - m_coreTotal[core];
+        m_coreLoad[core] = core < m_coreCount ? ratio(busyDelta, totalDelta) : 0;
+        m_coreBusy[core] = busy;
+        m_coreTotal[core] = total;
+        busySum += busyDelta;
+        totalSum += totalDelta;
+        core++;
+    }
+    m_values[Cpu] = core == m_coreCount ? ratio(busySum, totalSum) : 0;
+    m_coreCount = core;
+    return core > 0;
+}
+
+bool SystemMetrics::sampleMemory()
+{
+    int size = readFile(MemInfo, true);
+    if (size <= 0)
+        return false;
+    const char *p = m_buffer;
+    const char *end = m_buffer + size;
+
+    quint64 total = 0;
+    quint64 available = 0;
+    for (int found = 0; p < end && found < 2; p = nextLine(p, end)) {
+        if (startsWith(p, end, "MemTotal:")) {
+            parseNumber(p + 9, end, &total);
+            found++;
+        } else if (startsWith(p, end, "MemAvailable:")) {
+            parseNumber(p + 13, end, &available);
+            found++;
+        }
+    }
+    m_values[Memory] = ratio(total - qMin(available, total), total);
+    return total != 0;
+}
+
+bool SystemMetrics::sampleDisk(qint64 elapsed)
+{
+    int size = readFile(DiskStats, true);
+    if (size <= 0)
+        return false;
+    const char *p = m_buffer;
+    const char *end = m_buffer + size;
+
+    // major minor name, followed by the stats of which the 10th is the time spent doing I/O in ms.
+    // Only disks get a counter, partitions are never busier than their disk and follow right after it.
+    quint64 busiest = 0;
+    const char *disk = nullptr;
+    int diskLength = 0;
+    beginCounters(&m_disks);
+    for (; p < end; p = nextLine(p, end)) {
+        const char *line = lineEnd(p, end);
+        quint64 major;
+        const char *name = skipSpaces(skipField(parseNumber(p, line, &major), line), line);
+        const char *nameEnd = skipField(name, line);
+        if (name == nameEnd || isVirtualDisk(major, name, nameEnd) || isPartition(disk, diskLength, name, nameEnd))
+            continue;
+        disk = name;
+        diskLength = static_cast<int>(nameEnd - name);
+        const char *field = nameEnd;
+        quint64 ticks = 0;
+        for (int i = 0; i < 10; i++)
+            field = parseNumber(field, line, &ticks);
+
+        quint64 delta;
+        if (updateCounter(&m_disks, name, static_cast<int>(nameEnd - name), ticks, &delta) && elapsed > 0)
+            busiest = qMax(busiest, delta);
+    }
+    endCounters(&m_disks);
+    m_values[Disk] = ratio(busiest, static_cast<quint64>(elapsed / 1000000));
+    return true;
+}
+
+bool SystemMetrics::sampleNetwork(qint64 elapsed)
+{
+    int size = readFile(NetDev, true);
+    if (size <= 0)
+        return false;
+    const char *p = m_buffer;
+    const char *end = m_buffer + size;
+
+    // Two header lines, then "name: rx_bytes <7 rx fields> tx_bytes ..."
+    p = nextLine(nextLine(p, end), end);
+    quint64 delta = 0;
+    beginCounters(&m_interfaces);
+    for (; p < end; p = nextLine(p, end)) {
+        const char *line = lineEnd(p, end);
+        const char *name = skipSpaces(p, line);
+        const char *field = name;
+        while (field < line && *field != ':')
+            field++;
+        if (field == line || startsWith(name, line, "lo:"))
+            continue;
+        const int nameLength = static_cast<int>(field - name);
+        field++;
+
+        quint64 value;
+        field = parseNumber(field, line, &value);
+        quint64 bytes = value;
+        for (int i = 0; i < 8; i++)
+            field = parseNumber(field, line, &value);
+        bytes += value;
+
+        quint64 interfaceDelta;
+        if (updateCounter(&m_interfaces, name, nameLength, bytes, &interfaceDelta) && elapsed > 0)
+            delta += interfaceDelta;
+    }
+    endCounters(&m_interfaces);
+
+    // Capacity per sampling interval
+    quint64 capacity = static_cast<quint64>(static_cast<double>(m_networkCapacity) * elapsed / 1e9);
+    m_values[Network] = ratio(delta, capacity);
+    return true;
+}
+
+::openrazer::RGB SystemMetrics::color(uchar value) const
+{
+    return blendColors(m_low, m_high, value);
+}
+
+void SystemMetrics::render(CustomFrame *frame) const
+{
+    const int rows = frame->rows();
+    const int columns = frame->columns();
+    if (rows == 0 || columns == 0)
+        return;
+
+    const int metricColumns = qMin(columns, MetricCount - 1);
+    const int coreColumns = columns - metricColumns;
+
+    for (int column = 0; column < columns; column++) {
+        uchar value;
+        if (column < coreColumns) {
+            // Spread the cores evenly over the available columns
+            int first = column * m_coreCount / coreColumns;
+            int last = qMax(first + 1, (column + 1) * m_coreCount / coreColumns);
+            int sum = 0;
+            for (int core = first; core < last && core < m_coreCount; core++)
+                sum += m_coreLoad[core];
+            value = static_cast<uchar>(sum / (last - first));
+        } else {
+            value = m_values[Memory + column - coreColumns];
+        }
+
+        int height = (value * rows + 127) / 255;
+        ::openrazer::RGB barColor = color(value);
+        for (int row = 0; row < rows; row++) {
+            frame->setPixel(row, column, rows - row <= height ? barColor : m_background);
+        }
+    }
+}
+
+void SystemMetrics::updateZone(Led *led, Metric metric)
+{
+    ::openrazer::RGB newColor = color(m_values[metric]);
+    if (m_zoneValid[metric]) {
+        const ::openrazer::RGB &old = m_zoneColors[metric];
+        if (qAbs(newColor.r - old.r) < ZoneColorStep && qAbs(newColor.g - old.g) < ZoneColorStep && qAbs(newColor.b - old.b) < ZoneColorStep)
+            return;
+    }
+
+    try {
+        led->setStatic(newColor);
+    } catch (const DBusException &) {
+        // Already printed by libopenrazer, try again with the next sample
+        m_zoneValid[metric] = false;
+        return;
+    }
+    m_zoneColors[metric] = newColor;
+    m_zoneValid[metric] = true;
+}
+
+}
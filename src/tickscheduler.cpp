@@ -0,0 +1,100 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/tickscheduler.h"
+
+namespace libopenrazer {
+
+TickScheduler *TickScheduler::instance()
+{
+    static TickScheduler *scheduler = new TickScheduler();
+    return scheduler;
+}
+
+TickScheduler::TickScheduler()
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(16);
+    connect(&m_timer, &QTimer::timeout, this, &TickScheduler::tick);
+}
+
+void TickScheduler::setBaseInterval(int msec)
+{
+    m_timer.setInterval(msec);
+}
+
+int TickScheduler::baseInterval() const
+{
+    return m_timer.interval();
+}
+
+int TickScheduler::subscribe(QObject *context, int divisor, const std::function<void(quint64)> &callback)
+{
+    Subscription subscription;
+    subscription.id = m_nextId++;
+    subscription.divisor = qMax(1, divisor);
+    subscription.callback = callback;
+    if (context != nullptr) {
+        int id = subscription.id;
+        subscription.destroyedConnection = connect(context, &QObject::destroyed, this, [this, id]() {
+            unsubscribe(id);
+        });
+    }
+    m_subscriptions.append(subscription);
+
+    if (!m_timer.isActive())
+        m_timer.start();
+    return subscription.id;
+}
+
+void TickScheduler::unsubscribe(int id)
+{
+    for (int i = 0; i < m_subscriptions.size(); i++) {
+        Subscription &subscription = m_subscriptions[i];
+        if (subscription.id != id)
+            continue;
+        disconnect(subscription.destroyedConnection);
+        if (m_dispatching) {
+            // Removed after the current tick, see tick()
+            subscription.id = 0;
+            subscription.callback = nullptr;
+        } else {
+            m_subscriptions.remove(i);
+        }
+        break;
+    }
+
+    if (m_subscriptions.isEmpty())
+        m_timer.stop();
+}
+
+bool TickScheduler::isActive() const
+{
+    return m_timer.isActive();
+}
+
+void TickScheduler::tick()
+{
+    m_tick++;
+
+    m_dispatching = true;
+    // Subscriptions added by a callback have to wait for the next tick
+    const int count = m_subscriptions.size();
+    for (int i = 0; i < count; i++) {
+        // Copy, the callback may add subscriptions and reallocate the vector
+        std::function<void(quint64)> callback = m_subscriptions.at(i).callback;
+        if (callback && m_tick % m_subscriptions.at(i).divisor == 0)
+            callback(m_tick);
+    }
+    m_dispatching = false;
+
+    for (int i = m_subscriptions.size() - 1; i >= 0; i--) {
+        if (m_subscriptions.at(i).id == 0)
+            m_subscriptions.remove(i);
+    }
+    if (m_subscriptions.isEmpty())
+        m_timer.stop();
+}
+
+}
@@ -0,0 +1,218 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+
+#include <QDBusMessage>
+
+static const char *const deviceInterfaces =
+        "  <interface name=\"razer.device.misc\">\n"
+        "    <method name=\"getSerial\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getDeviceName\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getDeviceType\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getFirmware\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getKeyboardLayout\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getRazerUrls\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getMatrixDimensions\"><arg direction=\"out\" type=\"ai\"/></method>\n"
+        "  </interface>\n"
+        "  <interface name=\"razer.device.lighting.chroma\">\n"
+        "    <method name=\"setNone\"/>\n"
+        "    <method name=\"setStatic\"><arg direction=\"in\" type=\"y\"/><arg direction=\"in\" type=\"y\"/><arg direction=\"in\" type=\"y\"/></method>\n"
+        "    <method name=\"setBreathSingle\"><arg direction=\"in\" type=\"y\"/><arg direction=\"in\" type=\"y\"/><arg direction=\"in\" type=\"y\"/></method>\n"
+        "    <method name=\"setSpectrum\"/>\n"
+        "    <method name=\"setCustom\"/>\n"
+        "    <method name=\"setKeyRow\"><arg direction=\"in\" type=\"ay\"/></method>\n"
+        "    <method name=\"getEffect\"><arg direction=\"out\" type=\"s\"/></method>\n"
+        "    <method name=\"getEffectColors\"><arg direction=\"out\" type=\"ay\"/></method>\n"
+        "  </interface>\n"
+        "  <interface name=\"razer.device.lighting.brightness\">\n"
+        "    <method name=\"setBrightness\"><arg direction=\"in\" type=\"d\"/></method>\n"
+        "    <method name=\"getBrightness\"><arg direction=\"out\" type=\"d\"/></method>\n"
+        "  </interface>\n";
+
+static const char *const powerInterface =
+        "  <interface name=\"razer.device.power\">\n"
+        "    <method name=\"getBattery\"><arg direction=\"out\" type=\"d\"/></method>\n"
+        "    <method name=\"isCharging\"><arg direction=\"out\" type=\"b\"/></method>\n"
+        "    <method name=\"getLowBatteryThreshold\"><arg direction=\"out\" type=\"y\"/></method>\n"
+        "  </interface>\n";
+
+FakeOpenRazer::FakeOpenRazer()
+    : m_connection(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("fakeopenrazer"))), m_version(QStringLiteral("3.0.0"))
+{
+    // Replies are sent from this thread, the test thread can block on its calls meanwhile
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+FakeOpenRazer::~FakeOpenRazer()
+{
+    m_connection.unregisterObject(QStringLiteral("/org/razer"));
+    m_connection.unregisterService(QStringLiteral("org.razer"));
+    m_thread.quit();
+    m_thread.wait();
+    QDBusConnection::disconnectFromBus(QStringLiteral("fakeopenrazer"));
+}
+
+bool FakeOpenRazer::start()
+{
+    m_started = m_connection.isConnected()
+            && m_connection.registerVirtualObject(QStringLiteral("/org/razer"), this, QDBusConnection::SubPath)
+            && m_connection.registerService(QStringLiteral("org.razer"));
+    return m_started;
+}
+
+void FakeOpenRazer::addDevice(const QString &serial)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_serials.append(serial);
+    }
+    emitDevicesSignal(QStringLiteral("device_added"));
+}
+
+void FakeOpenRazer::removeDevice(const QString &serial)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_serials.removeAll(serial);
+    }
+    emitDevicesSignal(QStringLiteral("device_removed"));
+}
+
+void FakeOpenRazer::emitDevicesSignal(const QString &name)
+{
+    if (!m_started)
+        return;
+    m_connection.send(QDBusMessage::createSignal(QStringLiteral("/org/razer"), QStringLiteral("razer.devices"), name));
+}
+
+void FakeOpenRazer::setVersion(const QString &version)
+{
+    QMutexLocker locker(&m_mutex);
+    m_version = version;
+}
+
+void FakeOpenRazer::setExtraInterfaces(const QString &xml)
+{
+    QMutexLocker locker(&m_mutex);
+    m_extraInterfaces = xml;
+}
+
+void FakeOpenRazer::setBattery(const QString &serial, double percent, bool charging)
+{
+    QMutexLocker locker(&m_mutex);
+    m_batteries.insert(serial, { percent, charging });
+}
+
+QByteArray FakeOpenRazer::keyRow(const QString &serial, int row) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_keyRows.value(serial).value(row);
+}
+
+int FakeOpenRazer::calls(const QString &method) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_calls.value(method);
+}
+
+int FakeOpenRazer::totalCalls() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalCalls;
+}
+
+void FakeOpenRazer::resetCalls()
+{
+    QMutexLocker locker(&m_mutex);
+    m_calls.clear();
+    m_totalCalls = 0;
+}
+
+QString FakeOpenRazer::introspect(const QString &path) const
+{
+    QMutexLocker locker(&m_mutex);
+    return interfaces(path);
+}
+
+// Called with the mutex held
+QString FakeOpenRazer::interfaces(const QString &path) const
+{
+    const QString serial = path.section('/', -1);
+    if (!path.startsWith(QLatin1String("/org/razer/device/")) || !m_serials.contains(serial))
+        return QString();
+    QString xml = QLatin1String(deviceInterfaces) + m_extraInterfaces;
+    if (m_batteries.contains(serial))
+        xml += QLatin1String(powerInterface);
+    return xml;
+}
+
+bool FakeOpenRazer::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    const QString method = message.member();
+    const QString serial = message.path().section('/', -1);
+
+    QMutexLocker locker(&m_mutex);
+    m_calls[method]++;
+    m_totalCalls++;
+
+    // Like a disconnected device, which the daemon doesn't serve anymore
+    if (message.path().startsWith(QLatin1String("/org/razer/device/")) && !m_serials.contains(serial)) {
+        connection.send(message.createErrorReply(QStringLiteral("org.freedesktop.DBus.Error.UnknownObject"), message.path()));
+        return true;
+    }
+
+    QVariantList reply;
+    if (method == QLatin1String("Introspect")) {
+        // Like dbus-python, the root node is named after the object path
+        reply << QStringLiteral("<node name=\"%1\">\n").arg(message.path()) + interfaces(message.path()) + QStringLiteral("</node>\n");
+    } else if (method == QLatin1String("version")) {
+        reply << m_version;
+    } else if (method == QLatin1String("getDevices")) {
+        reply << m_serials;
+    } else if (method == QLatin1String("getSerial")) {
+        reply << serial;
+    } else if (method == QLatin1String("getDeviceName")) {
+        reply << QStringLiteral("Razer Fake Keyboard");
+    } else if (method == QLatin1String("getDeviceType")) {
+        reply << QStringLiteral("keyboard");
+    } else if (method == QLatin1String("getFirmware")) {
+        reply << QStringLiteral("v1.0");
+    } else if (method == QLatin1String("getKeyboardLayout")) {
+        reply << QStringLiteral("en_US");
+    } else if (method == QLatin1String("getRazerUrls")) {
+        reply << QStringLiteral("{\"top_img\": \"https://example.org/top.png\"}");
+    } else if (method == QLatin1String("getMatrixDimensions")) {
+        reply << QVariant::fromValue(QList<int> { 6, 22 });
+    } else if (method == QLatin1String("getEffect")) {
+        reply << QStringLiteral("static");
+    } else if (method == QLatin1String("getEffectColors")) {
+        reply << QByteArray("\xff\x00\x00", 3);
+    } else if (method == QLatin1String("getBrightness")) {
+        reply << 100.0;
+    } else if (method == QLatin1String("getBattery")) {
+        reply << m_batteries.value(serial).percent;
+    } else if (method == QLatin1String("isCharging")) {
+        reply << m_batteries.value(serial).charging;
+    } else if (method == QLatin1String("getLowBatteryThreshold")) {
+        reply << QVariant::fromValue(static_cast<uchar>(20));
+    } else if (method == QLatin1String("setKeyRow")) {
+        // Row, start column, end column and the colors from the start column on
+        const QByteArray data = message.arguments().value(0).toByteArray();
+        if (data.size() >= 3) {
+            QByteArray &row = m_keyRows[serial][static_cast<uchar>(data.at(0))];
+            const int offset = static_cast<uchar>(data.at(1)) * 3;
+            if (row.size() < offset + data.size() - 3)
+                row.resize(offset + data.size() - 3);
+            row.replace(offset, data.size() - 3, data.mid(3));
+        }
+    } else if (!method.startsWith(QLatin1String("set"))) {
+        connection.send(message.createErrorReply(QStringLiteral("org.freedesktop.DBus.Error.UnknownMethod"), method));
+        return true;
+    }
+    // Setters don't return anything
+    connection.send(message.createReply(reply));
+    return true;
+}
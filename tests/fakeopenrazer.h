@@ -0,0 +1,72 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FAKEOPENRAZER_H
+#define FAKEOPENRAZER_H
+
+#include <QDBusConnection>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+// Minimal openrazer daemon (org.razer) on the session bus, serving keyboards with a Chroma LED.
+//
+// It runs on its own connection and thread, so the blocking calls of the library get their replies
+// while the test waits for them. Every call it receives is counted, which makes the number of
+// round trips of an operation visible. Run the tests with dbus-run-session.
+class FakeOpenRazer : public QDBusVirtualObject
+{
+public:
+    FakeOpenRazer();
+    ~FakeOpenRazer() override;
+
+    // Registers org.razer, returns false if there is no session bus or the name is taken
+    bool start();
+
+    // Adding and removing devices emits device_added and device_removed once the daemon has been started
+    void addDevice(const QString &serial);
+    void removeDevice(const QString &serial);
+    void setVersion(const QString &version);
+    // Appended to the introspection data of every device, like new features after a firmware update
+    void setExtraInterfaces(const QString &xml);
+    // Gives the device a battery (razer.device.power) with a low battery threshold of 20 %
+    void setBattery(const QString &serial, double percent, bool charging);
+
+    // Colors last sent for row of the custom frame of the device, three bytes per column
+    QByteArray keyRow(const QString &serial, int row) const;
+
+    // Number of calls of method (e.g. "Introspect" or "setStatic") since the last resetCalls()
+    int calls(const QString &method) const;
+    int totalCalls() const;
+    void resetCalls();
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+private:
+    struct Battery {
+        double percent;
+        bool charging;
+    };
+
+    QString interfaces(const QString &path) const;
+    void emitDevicesSignal(const QString &name);
+
+    QThread m_thread;
+    QDBusConnection m_connection;
+    bool m_started = false;
+
+    mutable QMutex m_mutex;
+    QString m_version;
+    QString m_extraInterfaces;
+    QStringList m_serials;
+    QHash<QString, Battery> m_batteries;
+    QHash<QString, QHash<int, QByteArray>> m_keyRows;
+    QHash<QString, int> m_calls;
+    int m_totalCalls = 0;
+};
+
+#endif // FAKEOPENRAZER_H
@@ -0,0 +1,227 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakerazertest.h"
+
+static const char *const ManagerPath = "/io/github/openrazer1";
+static const char *const DevicesPath = "/io/github/openrazer1/devices/";
+
+FakeRazerTest::FakeRazerTest()
+    : m_connection(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("fakerazertest")))
+{
+    // The properties carry the custom types of libopenrazer
+    ::openrazer::registerMetaTypes();
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+FakeRazerTest::~FakeRazerTest()
+{
+    m_connection.unregisterObject(QLatin1String(ManagerPath));
+    m_connection.unregisterService(QStringLiteral("io.github.openrazer1"));
+    m_thread.quit();
+    m_thread.wait();
+    QDBusConnection::disconnectFromBus(QStringLiteral("fakerazertest"));
+}
+
+void FakeRazerTest::useSessionBusAsSystemBus()
+{
+    qputenv("DBUS_SYSTEM_BUS_ADDRESS", qgetenv("DBUS_SESSION_BUS_ADDRESS"));
+}
+
+bool FakeRazerTest::start()
+{
+    m_started = m_connection.isConnected()
+            && m_connection.registerVirtualObject(QLatin1String(ManagerPath), this, QDBusConnection::SubPath)
+            && m_connection.registerService(QStringLiteral("io.github.openrazer1"));
+    return m_started;
+}
+
+QDBusObjectPath FakeRazerTest::devicePath(const QString &serial)
+{
+    return QDBusObjectPath(QLatin1String(DevicesPath) + serial);
+}
+
+QDBusObjectPath FakeRazerTest::ledPath(const QString &serial)
+{
+    return QDBusObjectPath(QLatin1String(DevicesPath) + serial + QStringLiteral("/led0"));
+}
+
+void FakeRazerTest::addDevice(const QString &serial)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_serials.append(serial);
+        m_leds.insert(serial, { ::openrazer::Effect::Static, { { 0xff, 0x00, 0x00 }, { 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x00 } } });
+    }
+    emitDevicesChanged();
+}
+
+void FakeRazerTest::removeDevice(const QString &serial)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_serials.removeAll(serial);
+        m_leds.remove(serial);
+    }
+    emitDevicesChanged();
+}
+
+void FakeRazerTest::setMissingDeviceProperties(const QStringList &names)
+{
+    QMutexLocker locker(&m_mutex);
+    m_missingProperties = names;
+}
+
+void FakeRazerTest::emitDevicesChanged()
+{
+    if (!m_started)
+        return;
+    m_connection.send(QDBusMessage::createSignal(QLatin1String(ManagerPath), QStringLiteral("io.github.openrazer1.Manager"), QStringLiteral("devicesChanged")));
+}
+
+void FakeRazerTest::changeEffect(const QString &serial, ::openrazer::Effect effect, const QVector<::openrazer::RGB> &colors)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_leds[serial] = { effect, colors };
+    }
+    QVariantMap changed;
+    changed.insert(QStringLiteral("CurrentEffect"), QVariant::fromValue(effect));
+    changed.insert(QStringLiteral("CurrentColors"), QVariant::fromValue(colors));
+    QDBusMessage signal = QDBusMessage::createSignal(ledPath(serial).path(), QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("PropertiesChanged"));
+    signal << QStringLiteral("io.github.openrazer1.Led") << changed << QStringList();
+    m_connection.send(signal);
+}
+
+void FakeRazerTest::holdLedProperties(bool hold)
+{
+    QMutexLocker locker(&m_mutex);
+    m_holdLedProperties = hold;
+}
+
+void FakeRazerTest::releaseReplies()
+{
+    QList<QDBusMessage> replies;
+    {
+        QMutexLocker locker(&m_mutex);
+        replies.swap(m_heldReplies);
+    }
+    for (const QDBusMessage &reply : replies)
+        m_connection.send(reply);
+}
+
+int FakeRazerTest::calls(const QString &method) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_calls.value(method);
+}
+
+int FakeRazerTest::totalCalls() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_totalCalls;
+}
+
+void FakeRazerTest::resetCalls()
+{
+    QMutexLocker locker(&m_mutex);
+    m_calls.clear();
+    m_totalCalls = 0;
+}
+
+QString FakeRazerTest::introspect(const QString &path) const
+{
+    Q_UNUSED(path)
+    // libopenrazer calls the methods directly, without introspecting razer_test
+    return QString();
+}
+
+// Called with the mutex held, returns an empty map for unknown objects
+QVariantMap FakeRazerTest::properties(const QString &path, const QString &interface) const
+{
+    QVariantMap properties;
+    if (path == QLatin1String(ManagerPath) && interface == QLatin1String("io.github.openrazer1.Manager")) {
+        QList<QDBusObjectPath> devices;
+        for (const QString &serial : m_serials)
+            devices.append(devicePath(serial));
+        properties.insert(QStringLiteral("Version"), QStringLiteral("1.0.0"));
+        properties.insert(QStringLiteral("Devices"), QVariant::fromValue(devices));
+        return properties;
+    }
+
+    const QString serial = path.mid(static_cast<int>(qstrlen(DevicesPath))).section('/', 0, 0);
+    if (!path.startsWith(QLatin1String(DevicesPath)) || !m_serials.contains(serial))
+        return properties;
+
+    if (path == devicePath(serial).path() && interface == QLatin1String("io.github.openrazer1.Device")) {
+        properties.insert(QStringLiteral("Name"), QStringLiteral("Razer Fake Keyboard"));
+        properties.insert(QStringLiteral("Type"), QStringLiteral("keyboard"));
+        properties.insert(QStringLiteral("SupportedFx"), QStringList { QStringLiteral("off"), QStringLiteral("on"), QStringLiteral("static"), QStringLiteral("spectrum"), QStringLiteral("brightness") });
+        properties.insert(QStringLiteral("SupportedFeatures"), QStringList { QStringLiteral("custom_frame") });
+        properties.insert(QStringLiteral("Leds"), QVariant::fromValue(QList<QDBusObjectPath> { ledPath(serial) }));
+        for (const QString &name : m_missingProperties)
+            properties.remove(name);
+    } else if (path == ledPath(serial).path() && interface == QLatin1String("io.github.openrazer1.Led")) {
+        const LedState &state = m_leds[serial];
+        properties.insert(QStringLiteral("LedId"), QVariant::fromValue(::openrazer::LedId::Unspecified));
+        properties.insert(QStringLiteral("CurrentEffect"), QVariant::fromValue(state.effect));
+        properties.insert(QStringLiteral("CurrentColors"), QVariant::fromValue(state.colors));
+    }
+    return properties;
+}
+
+bool FakeRazerTest::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    const QString method = message.member();
+
+    QMutexLocker locker(&m_mutex);
+    m_calls[method]++;
+    m_totalCalls++;
+
+    if (message.interface() == QLatin1String("org.freedesktop.DBus.Properties")) {
+        const QVariantList arguments = message.arguments();
+        const QString interface = arguments.value(0).toString();
+        const QVariantMap values = properties(message.path(), interface);
+        if (method == QLatin1String("GetAll") && !values.isEmpty()) {
+            QDBusMessage reply = message.createReply(QVariantList { values });
+            if (m_holdLedProperties && interface == QLatin1String("io.github.openrazer1.Led"))
+                m_heldReplies.append(reply);
+            else
+                connection.send(reply);
+            return true;
+        }
+        if (method == QLatin1String("Get") && values.contains(arguments.value(1).toString())) {
+            connection.send(message.createReply(QVariant::fromValue(QDBusVariant(values.value(arguments.value(1).toString())))));
+            return true;
+        }
+        connection.send(message.createErrorReply(QStringLiteral("org.freedesktop.DBus.Error.InvalidArgs"), message.path()));
+        return true;
+    }
+
+    const QString serial = message.path().mid(static_cast<int>(qstrlen(DevicesPath))).section('/', 0, 0);
+    if (!m_serials.contains(serial)) {
+        connection.send(message.createErrorReply(QStringLiteral("org.freedesktop.DBus.Error.UnknownObject"), message.path()));
+        return true;
+    }
+
+    QVariantList reply;
+    if (method == QLatin1String("getSerial")) {
+        reply << serial;
+    } else if (method == QLatin1String("getFirmwareVersion")) {
+        reply << QStringLiteral("v1.0");
+    } else if (method == QLatin1String("getKeyboardLayout")) {
+        reply << QStringLiteral("en_US");
+    } else if (method == QLatin1String("getBrightness")) {
+        reply << QVariant::fromValue(static_cast<uchar>(100));
+    } else if (method.startsWith(QLatin1String("set")) || method.endsWith(QLatin1String("CustomFrame"))) {
+        // Setters report success
+        reply << true;
+    } else {
+        connection.send(message.createErrorReply(QStringLiteral("org.freedesktop.DBus.Error.UnknownMethod"), method));
+        return true;
+    }
+    connection.send(message.createReply(reply));
+    return true;
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FAKERAZERTEST_H
+#define FAKERAZERTEST_H
+
+#include "libopenrazer/openrazer.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusObjectPath>
+#include <QDBusVirtualObject>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVariantMap>
+
+// Minimal razer_test daemon (io.github.openrazer1) on the session bus, serving keyboards with one LED.
+//
+// Like FakeOpenRazer it runs on its own connection and thread and counts every call it receives.
+// razer_test uses the system bus on Linux, so tests point DBUS_SYSTEM_BUS_ADDRESS at the session bus
+// of dbus-run-session with useSessionBusAsSystemBus() before the library connects.
+class FakeRazerTest : public QDBusVirtualObject
+{
+public:
+    FakeRazerTest();
+    ~FakeRazerTest() override;
+
+    // Has to be called before the first connection to the system bus
+    static void useSessionBusAsSystemBus();
+
+    // Registers io.github.openrazer1, returns false if there is no session bus or the name is taken
+    bool start();
+
+    static QDBusObjectPath devicePath(const QString &serial);
+    static QDBusObjectPath ledPath(const QString &serial);
+
+    // Adding and removing devices emits devicesChanged once the daemon has been started
+    void addDevice(const QString &serial);
+    void removeDevice(const QString &serial);
+    // Leaves the properties out of the device properties, like a daemon that doesn't have them
+    void setMissingDeviceProperties(const QStringList &names);
+
+    // Changes the effect of the LED of the device with serial and emits PropertiesChanged for it
+    void changeEffect(const QString &serial, ::openrazer::Effect effect, const QVector<::openrazer::RGB> &colors);
+
+    // While held, the replies to GetAll of LEDs are only sent by releaseReplies(). They keep the
+    // properties the LED had when the call arrived.
+    void holdLedProperties(bool hold);
+    void releaseReplies();
+
+    // Number of calls of method (e.g. "GetAll" or "setStatic") since the last resetCalls()
+    int calls(const QString &method) const;
+    int totalCalls() const;
+    void resetCalls();
+
+    QString introspect(const QString &path) const override;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override;
+
+private:
+    struct LedState {
+        ::openrazer::Effect effect;
+        QVector<::openrazer::RGB> colors;
+    };
+
+    QVariantMap properties(const QString &path, const QString &interface) const;
+    void emitDevicesChanged();
+
+    QThread m_thread;
+    QDBusConnection m_connection;
+    bool m_started = false;
+
+    mutable QMutex m_mutex;
+    QStringList m_serials;
+    QStringList m_missingProperties;
+    QHash<QString, LedState> m_leds;
+    bool m_holdLedProperties = false;
+    QList<QDBusMessage> m_heldReplies;
+    QHash<QString, int> m_calls;
+    int m_totalCalls = 0;
+};
+
+#endif // FAKERAZERTEST_H
@@ -0,0 +1,120 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QtTest>
+
+// Failures of a Batch over the devices of the fake daemon.
+class TestBatch : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+    libopenrazer::Manager *manager = nullptr;
+    QSharedPointer<libopenrazer::Device> first;
+    QSharedPointer<libopenrazer::Device> second;
+
+    // Fails once the event loop runs, after operations that were added later might have finished
+    static QFuture<void> failLater(const QException &exception)
+    {
+        QFutureInterface<void> future(QFutureInterfaceBase::Started);
+        QSharedPointer<QException> error(exception.clone());
+        QTimer::singleShot(50, [future, error]() mutable {
+            future.reportException(*error);
+            future.reportFinished();
+        });
+        return future.future();
+    }
+
+    static libopenrazer::BatchResult wait(const QFuture<libopenrazer::BatchResult> &future)
+    {
+        QFutureWatcher<libopenrazer::BatchResult> watcher;
+        QEventLoop loop;
+        connect(&watcher, &QFutureWatcher<libopenrazer::BatchResult>::finished, &loop, &QEventLoop::quit);
+        watcher.setFuture(future);
+        if (!future.isFinished())
+            loop.exec();
+        return future.result();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+        daemon.addDevice(QStringLiteral("FAKE0001"));
+        manager = new libopenrazer::openrazer::Manager();
+        first = manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000")));
+        second = manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0001")));
+        QVERIFY(first);
+        QVERIFY(second);
+    }
+
+    void cleanupTestCase()
+    {
+        first.reset();
+        second.reset();
+        delete manager;
+    }
+
+    void failures()
+    {
+        libopenrazer::Batch batch;
+        libopenrazer::Led *firstLed = first->getLeds().first();
+        libopenrazer::Led *secondLed = second->getLeds().first();
+        batch.setStatic(firstLed, { 255, 0, 0 });
+        batch.add(first.data(), QStringLiteral("broken"), []() {
+            return failLater(libopenrazer::DBusException(QStringLiteral("org.razer.Error"), QStringLiteral("Device is gone")));
+        });
+        batch.setStatic(secondLed, { 0, 255, 0 });
+        // Fails before the first failure of the other device
+        batch.add(secondLed, QStringLiteral("unhandled"), []() {
+            QFutureInterface<void> future(QFutureInterfaceBase::Started);
+            future.reportException(QUnhandledException());
+            future.reportFinished();
+            return future.future();
+        });
+        batch.setSpectrum(firstLed);
+        QCOMPARE(batch.size(), 5);
+
+        const libopenrazer::BatchResult result = wait(batch.exec());
+        QVERIFY(!result.ok());
+        // A failure doesn't stop the operations after it
+        QCOMPARE(result.succeeded, 3);
+        QCOMPARE(result.failures.size(), 2);
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 2);
+        QCOMPARE(daemon.calls(QStringLiteral("setSpectrum")), 1);
+
+        // In the order the operations were added
+        const libopenrazer::BatchFailure &broken = result.failures.at(0);
+        QCOMPARE(broken.operation, QStringLiteral("broken"));
+        QVERIFY(broken.device == first.data());
+        QVERIFY(broken.led == nullptr);
+        QCOMPARE(broken.errorName, QStringLiteral("org.razer.Error"));
+        QCOMPARE(broken.errorMessage, QStringLiteral("Device is gone"));
+
+        const libopenrazer::BatchFailure &unhandled = result.failures.at(1);
+        QCOMPARE(unhandled.operation, QStringLiteral("unhandled"));
+        QVERIFY(unhandled.device == second.data());
+        QVERIFY(unhandled.led == secondLed);
+        QCOMPARE(unhandled.errorName, QStringLiteral("org.freedesktop.DBus.Error.Failed"));
+    }
+
+    void empty()
+    {
+        libopenrazer::Batch batch;
+        const libopenrazer::BatchResult result = wait(batch.exec());
+        QVERIFY(result.ok());
+        QCOMPARE(result.succeeded, 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestBatch)
+
+#include "tst_batch.moc"
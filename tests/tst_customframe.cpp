@@ -0,0 +1,118 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QtTest>
+
+// Effect writes the LED state cache skips, and the ones it must not skip after a custom frame has
+// replaced the effect of the LEDs.
+class TestCustomFrame : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+    libopenrazer::openrazer::Manager *manager = nullptr;
+    QSharedPointer<libopenrazer::Device> device;
+    libopenrazer::Led *led = nullptr;
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+
+        manager = new libopenrazer::openrazer::Manager;
+        device = manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000")));
+        QVERIFY(device);
+        QVERIFY(!device->getLeds().isEmpty());
+        led = device->getLeds().first();
+    }
+
+    void cleanupTestCase()
+    {
+        device.clear();
+        delete manager;
+    }
+
+    void repeatedWriteSkipped()
+    {
+        led->setStatic({ 0x00, 0xff, 0x00 });
+        daemon.resetCalls();
+        const quint64 suppressed = led->suppressedWrites();
+
+        led->setStatic({ 0x00, 0xff, 0x00 });
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 0);
+        QCOMPARE(led->suppressedWrites(), suppressed + 1);
+    }
+
+    void writeAfterCustomFrame()
+    {
+        daemon.resetCalls();
+        led->setStatic({ 0xff, 0x00, 0x00 });
+        device->displayCustomFrame();
+        led->setStatic({ 0xff, 0x00, 0x00 });
+        // The LED shows the custom frame, the second write must reach the daemon
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 2);
+    }
+
+    void writeAfterDefinedFrame()
+    {
+        daemon.resetCalls();
+        led->setStatic({ 0x00, 0x00, 0xff });
+        device->defineCustomFrame(0, 0, 1, { { 0xff, 0x00, 0x00 }, { 0x00, 0xff, 0x00 } });
+        led->setStatic({ 0x00, 0x00, 0xff });
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 2);
+    }
+
+    void writeAfterAsyncFrame()
+    {
+        daemon.resetCalls();
+        led->setStatic({ 0xff, 0xff, 0x00 });
+        // The reply is delivered through the event loop of this thread
+        QFuture<void> frame = device->displayCustomFrameAsync();
+        QTRY_VERIFY(frame.isFinished());
+        led->setStatic({ 0xff, 0xff, 0x00 });
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 2);
+    }
+
+    void frameStages()
+    {
+        libopenrazer::FrameStats *stats = device->frameStats();
+        stats->reset();
+
+        device->defineCustomFrame(0, 0, 1, { { 0xff, 0x00, 0x00 }, { 0x00, 0xff, 0x00 } });
+        device->displayCustomFrame();
+        QCOMPARE(stats->stage(libopenrazer::FrameStats::Pack).count(), static_cast<quint64>(1));
+        QCOMPARE(stats->stage(libopenrazer::FrameStats::Marshal).count(), static_cast<quint64>(2));
+        QCOMPARE(stats->stage(libopenrazer::FrameStats::DBusWait).count(), static_cast<quint64>(2));
+        QCOMPARE(stats->frames().count(), static_cast<quint64>(1));
+
+        // Async frames record both stages once the reply has arrived
+        QFuture<void> define = device->defineCustomFrameAsync(0, 0, 1, { { 0xff, 0x00, 0x00 }, { 0x00, 0xff, 0x00 } });
+        QFuture<void> display = device->displayCustomFrameAsync();
+        QTRY_VERIFY(define.isFinished() && display.isFinished());
+        QTRY_COMPARE(stats->frames().count(), static_cast<quint64>(2));
+        QCOMPARE(stats->stage(libopenrazer::FrameStats::Marshal).count(), static_cast<quint64>(4));
+        QCOMPARE(stats->stage(libopenrazer::FrameStats::DBusWait).count(), static_cast<quint64>(4));
+    }
+
+    void cacheDisabled()
+    {
+        led->setStateCacheEnabled(false);
+        daemon.resetCalls();
+        led->setStatic({ 0x00, 0xff, 0xff });
+        led->setStatic({ 0x00, 0xff, 0xff });
+        QCOMPARE(daemon.calls(QStringLiteral("setStatic")), 2);
+        led->setStateCacheEnabled(true);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestCustomFrame)
+
+#include "tst_customframe.moc"
@@ -0,0 +1,163 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "effects_p.h"
+#include "libopenrazer.h"
+
+#include <QtTest>
+
+using namespace libopenrazer;
+
+// Compares the fixed-point effect kernels against the floating point ones. The fixed-point ones
+// may differ by one step of rounding, everything more than that is visible on the LEDs.
+class TestEffects : public QObject
+{
+    Q_OBJECT
+
+private:
+    static int difference(::openrazer::RGB a, ::openrazer::RGB b)
+    {
+        return qMax(qAbs(a.r - b.r), qMax(qAbs(a.g - b.g), qAbs(a.b - b.b)));
+    }
+
+private slots:
+    void breathingIntensity()
+    {
+        int maxDifference = 0;
+        for (uint period : { 1u, 7u, 1000u, 3000u, 4096u, 7777u }) {
+            for (uint time = 0; time < period; time++) {
+                int d = qAbs(fixedpoint::breathingIntensity(time, period) - floatingpoint::breathingIntensity(time, period));
+                maxDifference = qMax(maxDifference, d);
+            }
+        }
+        QVERIFY(maxDifference <= 1);
+        QCOMPARE(fixedpoint::breathingIntensity(100, 0), floatingpoint::breathingIntensity(100, 0));
+    }
+
+    void hsvToRgb()
+    {
+        int maxDifference = 0;
+        for (int hue = 0; hue < 720; hue++) {
+            for (int saturation = 0; saturation < 256; saturation++) {
+                for (int value = 0; value < 256; value++) {
+                    ::openrazer::RGB a = fixedpoint::hsvToRgb(hue, saturation, value);
+                    ::openrazer::RGB b = floatingpoint::hsvToRgb(hue, saturation, value);
+                    maxDifference = qMax(maxDifference, difference(a, b));
+                }
+            }
+        }
+        QVERIFY(maxDifference <= 1);
+    }
+
+    void scaleColor()
+    {
+        for (int channel = 0; channel < 256; channel++) {
+            for (int factor = 0; factor < 256; factor++) {
+                ::openrazer::RGB color { uchar(channel), uchar(255 - channel), uchar(channel / 2) };
+                QVERIFY(difference(fixedpoint::scaleColor(color, factor), floatingpoint::scaleColor(color, factor)) <= 1);
+            }
+        }
+    }
+
+    void blendColors()
+    {
+        int maxDifference = 0;
+        for (int a = 0; a < 256; a++) {
+            for (int b = 0; b < 256; b++) {
+                for (int alpha = 0; alpha < 256; alpha++) {
+                    ::openrazer::RGB from { uchar(a), uchar(b), 0 };
+                    ::openrazer::RGB to { uchar(b), uchar(a), 255 };
+                    maxDifference = qMax(maxDifference, difference(fixedpoint::blendColors(from, to, alpha), floatingpoint::blendColors(from, to, alpha)));
+                }
+            }
+        }
+        QVERIFY(maxDifference <= 1);
+    }
+
+    void blendRow()
+    {
+        QVector<::openrazer::RGB> src(256);
+        for (int i = 0; i < src.size(); i++)
+            src[i] = { uchar(i), uchar(255 - i), uchar(i * 7) };
+
+        for (int alpha = 0; alpha < 256; alpha += 17) {
+            QVector<::openrazer::RGB> fixedRow(src.size(), { 10, 200, 30 });
+            QVector<::openrazer::RGB> floatRow = fixedRow;
+            fixedpoint::blendRow(fixedRow.data(), src.constData(), src.size(), alpha);
+            floatingpoint::blendRow(floatRow.data(), src.constData(), src.size(), alpha);
+            for (int i = 0; i < src.size(); i++)
+                QVERIFY(difference(fixedRow[i], floatRow[i]) <= 1);
+        }
+    }
+
+    void publicKernels()
+    {
+        // The public functions forward to the variant selected at build time
+        for (uint time = 0; time < 3000; time += 13) {
+            uchar expected = effectsUseFixedPoint() ? fixedpoint::breathingIntensity(time, 3000) : floatingpoint::breathingIntensity(time, 3000);
+            QCOMPARE(::libopenrazer::breathingIntensity(time, 3000), expected);
+        }
+    }
+
+    void benchmarkBreathing_data()
+    {
+        QTest::addColumn<bool>("fixed");
+        QTest::newRow("float") << false;
+        QTest::newRow("fixed") << true;
+    }
+
+    void benchmarkBreathing()
+    {
+        QFETCH(bool, fixed);
+        uint sum = 0;
+        QBENCHMARK {
+            for (uint time = 0; time < 10000; time++)
+                sum += fixed ? fixedpoint::breathingIntensity(time, 3000) : floatingpoint::breathingIntensity(time, 3000);
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkHsvToRgb_data()
+    {
+        benchmarkBreathing_data();
+    }
+
+    void benchmarkHsvToRgb()
+    {
+        QFETCH(bool, fixed);
+        uint sum = 0;
+        QBENCHMARK {
+            for (int hue = 0; hue < 360; hue++) {
+                for (int value = 0; value < 256; value += 8)
+                    sum += fixed ? fixedpoint::hsvToRgb(hue, 200, value).g : floatingpoint::hsvToRgb(hue, 200, value).g;
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkBlendRow_data()
+    {
+        benchmarkBreathing_data();
+    }
+
+    void benchmarkBlendRow()
+    {
+        QFETCH(bool, fixed);
+        // A full keyboard matrix (6 x 22), 16 times per frame as for a layered effect
+        QVector<::openrazer::RGB> dst(6 * 22 * 16, { 0, 0, 0 });
+        QVector<::openrazer::RGB> src(dst.size(), { 10, 200, 30 });
+        QBENCHMARK {
+            for (int alpha = 0; alpha < 256; alpha += 16) {
+                if (fixed)
+                    fixedpoint::blendRow(dst.data(), src.constData(), dst.size(), alpha);
+                else
+                    floatingpoint::blendRow(dst.data(), src.constData(), dst.size(), alpha);
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestEffects)
+
+#include "tst_effects.moc"
@@ -0,0 +1,74 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QUuid>
+#include <QtTest>
+
+// Devices connected and disconnected while the openrazer backend is running.
+class TestHotplug : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+
+    static QDBusObjectPath devicePath(const QString &serial)
+    {
+        return QDBusObjectPath(QStringLiteral("/org/razer/device/") + serial);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        // A version the introspection cache hasn't seen, so new devices are introspected
+        daemon.setVersion(QUuid::createUuid().toString());
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+    }
+
+    void addAndRemove()
+    {
+        libopenrazer::openrazer::Manager manager;
+        QList<QSharedPointer<libopenrazer::Device>> added;
+        QList<QDBusObjectPath> removed;
+        connect(&manager, &libopenrazer::Manager::deviceAdded, this, [&added](QSharedPointer<libopenrazer::Device> device) { added.append(device); });
+        connect(&manager, &libopenrazer::Manager::deviceRemoved, this, [&removed](const QDBusObjectPath &objectPath) { removed.append(objectPath); });
+
+        QSharedPointer<libopenrazer::Device> connected = manager.getDevice(devicePath(QStringLiteral("FAKE0000")));
+        QVERIFY(connected);
+        // The initial device list doesn't report the devices that were already there
+        QTRY_COMPARE(daemon.calls(QStringLiteral("getDevices")), 1);
+        daemon.resetCalls();
+
+        daemon.addDevice(QStringLiteral("FAKE0001"));
+        QTRY_COMPARE(added.size(), 1);
+        QTest::qWait(100);
+        QCOMPARE(added.size(), 1);
+        QCOMPARE(removed.size(), 0);
+        QCOMPARE(added.first()->objectPath().path(), devicePath(QStringLiteral("FAKE0001")).path());
+        // Only the new device is set up, the connected one stays untouched
+        QCOMPARE(daemon.calls(QStringLiteral("Introspect")), 1);
+        QVERIFY(manager.getDevice(devicePath(QStringLiteral("FAKE0001"))) == added.first());
+        QVERIFY(manager.getDevice(devicePath(QStringLiteral("FAKE0000"))) == connected);
+
+        daemon.removeDevice(QStringLiteral("FAKE0001"));
+        QTRY_COMPARE(removed.size(), 1);
+        QTest::qWait(100);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(added.size(), 1);
+        QCOMPARE(removed.first().path(), devicePath(QStringLiteral("FAKE0001")).path());
+        // The removed device isn't handed out anymore, the other one is still shared
+        QVERIFY(manager.getDevice(devicePath(QStringLiteral("FAKE0001"))) != added.first());
+        QVERIFY(manager.getDevice(devicePath(QStringLiteral("FAKE0000"))) == connected);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestHotplug)
+
+#include "tst_hotplug.moc"
@@ -0,0 +1,121 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "openrazer/device_p.h"
+
+#include <QtTest>
+
+using namespace libopenrazer::openrazer;
+
+// Parses the introspection data of a large keyboard, like the openrazer daemon sends it for e.g.
+// a BlackWidow Chroma with its macro, game mode and per-zone lighting interfaces.
+class TestIntrospection : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString xml;
+
+    static void addInterface(QString *xml, const QString &name, const QStringList &methods)
+    {
+        *xml += QStringLiteral("  <interface name=\"%1\">\n").arg(name);
+        for (const QString &method : methods) {
+            // Every method of the daemon has the same shape: a few input arguments and one output
+            *xml += QStringLiteral("    <method name=\"%1\">\n"
+                                   "      <arg direction=\"in\" type=\"y\" name=\"red\"/>\n"
+                                   "      <arg direction=\"in\" type=\"y\" name=\"green\"/>\n"
+                                   "      <arg direction=\"in\" type=\"y\" name=\"blue\"/>\n"
+                                   "      <arg direction=\"out\" type=\"s\"/>\n"
+                                   "    </method>\n")
+                            .arg(method);
+        }
+        *xml += QStringLiteral("  </interface>\n");
+    }
+
+    static QStringList zoneMethods(const QString &zone)
+    {
+        QStringList methods;
+        for (const char *effect : { "Static", "Spectrum", "None", "On", "BreathSingle", "BreathDual", "BreathRandom", "Blinking", "Pulsate", "Reactive", "Wave", "Active", "Brightness" }) {
+            methods << QStringLiteral("set%1%2").arg(zone, effect);
+            methods << QStringLiteral("get%1%2").arg(zone, effect);
+        }
+        return methods;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        xml = QStringLiteral("<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
+                             "\"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
+                             "<node name=\"/org/razer/device/XX0000000000\">\n");
+        addInterface(&xml, QStringLiteral("org.freedesktop.DBus.Introspectable"), { QStringLiteral("Introspect") });
+        addInterface(&xml, QStringLiteral("org.freedesktop.DBus.Properties"), { QStringLiteral("Get"), QStringLiteral("GetAll"), QStringLiteral("Set") });
+        addInterface(&xml, QStringLiteral("razer.device.misc"),
+                     { QStringLiteral("getSerial"), QStringLiteral("getDeviceName"), QStringLiteral("getDeviceType"),
+                       QStringLiteral("getFirmware"), QStringLiteral("getKeyboardLayout"), QStringLiteral("getDeviceMode"),
+                       QStringLiteral("setDeviceMode"), QStringLiteral("getVidPid"), QStringLiteral("getDriverVersion"),
+                       QStringLiteral("getRazerUrls"), QStringLiteral("getMatrixDimensions"), QStringLiteral("hasMatrix"),
+                       QStringLiteral("getPollRate"), QStringLiteral("setPollRate"), QStringLiteral("getSupportedPollRates"),
+                       QStringLiteral("suspendDevice"), QStringLiteral("resumeDevice") });
+        addInterface(&xml, QStringLiteral("razer.device.lighting.chroma"),
+                     { QStringLiteral("setNone"), QStringLiteral("setStatic"), QStringLiteral("setSpectrum"),
+                       QStringLiteral("setWave"), QStringLiteral("setReactive"), QStringLiteral("setBreathSingle"),
+                       QStringLiteral("setBreathDual"), QStringLiteral("setBreathRandom"), QStringLiteral("setStarlightSingle"),
+                       QStringLiteral("setStarlightDual"), QStringLiteral("setStarlightRandom"), QStringLiteral("setRipple"),
+                       QStringLiteral("setRippleRandomColour"), QStringLiteral("setCustom"), QStringLiteral("setKeyRow"),
+                       QStringLiteral("getEffect"), QStringLiteral("getEffectColors"), QStringLiteral("getEffectSpeed"),
+                       QStringLiteral("getWaveDir") });
+        addInterface(&xml, QStringLiteral("razer.device.lighting.brightness"), { QStringLiteral("getBrightness"), QStringLiteral("setBrightness") });
+        for (const QString &zone : { QStringLiteral("Logo"), QStringLiteral("Scroll"), QStringLiteral("Backlight"), QStringLiteral("Left"), QStringLiteral("Right") })
+            addInterface(&xml, QStringLiteral("razer.device.lighting.") + zone.toLower(), zoneMethods(zone));
+        addInterface(&xml, QStringLiteral("razer.device.lighting.profile_led"),
+                     { QStringLiteral("getRedLED"), QStringLiteral("setRedLED"), QStringLiteral("getGreenLED"),
+                       QStringLiteral("setGreenLED"), QStringLiteral("getBlueLED"), QStringLiteral("setBlueLED") });
+        addInterface(&xml, QStringLiteral("razer.device.led.gamemode"), { QStringLiteral("getGameMode"), QStringLiteral("setGameMode") });
+        addInterface(&xml, QStringLiteral("razer.device.led.macromode"), { QStringLiteral("getMacroMode"), QStringLiteral("setMacroMode"), QStringLiteral("getMacroEffect"), QStringLiteral("setMacroEffect") });
+        addInterface(&xml, QStringLiteral("razer.device.macro"),
+                     { QStringLiteral("getMacros"), QStringLiteral("deleteMacro"), QStringLiteral("addMacro"),
+                       QStringLiteral("startMacroRecording"), QStringLiteral("stopMacroRecording"),
+                       QStringLiteral("getModeModifier"), QStringLiteral("setModeModifier") });
+        // Child objects have interfaces of their own, which must not end up in the ones of the device
+        xml += QStringLiteral("  <node name=\"child\">\n");
+        addInterface(&xml, QStringLiteral("razer.device.child"), { QStringLiteral("setSomething") });
+        xml += QStringLiteral("  </node>\n"
+                              "</node>\n");
+    }
+
+    void parse()
+    {
+        const DeviceIntrospection introspection = DevicePrivate::parseIntrospection(xml);
+        QCOMPARE(introspection.size(), 14);
+        QVERIFY(introspection.value(QStringLiteral("razer.device.lighting.chroma")).contains(QStringLiteral("setCustom")));
+        QVERIFY(introspection.value(QStringLiteral("razer.device.lighting.logo")).contains(QStringLiteral("setLogoStatic")));
+        QCOMPARE(introspection.value(QStringLiteral("razer.device.misc")).size(), 17);
+        // Argument names are not methods
+        QVERIFY(!introspection.value(QStringLiteral("razer.device.lighting.chroma")).contains(QStringLiteral("red")));
+        QVERIFY(!introspection.contains(QStringLiteral("razer.device.child")));
+    }
+
+    void parseUnnamedRoot()
+    {
+        // QtDBus doesn't name the root node, dbus-python does
+        QString unnamed = xml;
+        unnamed.replace(QStringLiteral("<node name=\"/org/razer/device/XX0000000000\">"), QStringLiteral("<node>"));
+        QVERIFY(unnamed != xml);
+        QVERIFY(DevicePrivate::parseIntrospection(unnamed) == DevicePrivate::parseIntrospection(xml));
+    }
+
+    void parseBenchmark()
+    {
+        qInfo("%d bytes of introspection data", xml.toUtf8().size());
+        QBENCHMARK {
+            DeviceIntrospection introspection = DevicePrivate::parseIntrospection(xml);
+            Q_UNUSED(introspection)
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestIntrospection)
+
+#include "tst_introspection.moc"
@@ -0,0 +1,94 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QtConcurrent>
+#include <QtTest>
+
+// Async calls with the IoThread enabled, from threads with and without a running event loop.
+class TestIoThread : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+    libopenrazer::openrazer::Manager *manager = nullptr;
+    QSharedPointer<libopenrazer::Device> device;
+    libopenrazer::Led *led = nullptr;
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+
+        // Before the first Manager, so the private connection is used
+        libopenrazer::IoThread::enable();
+        QVERIFY(libopenrazer::IoThread::isEnabled());
+        manager = new libopenrazer::openrazer::Manager;
+        device = manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000")));
+        QVERIFY(device);
+        QVERIFY(!device->getLeds().isEmpty());
+        led = device->getLeds().first();
+    }
+
+    void cleanupTestCase()
+    {
+        device.clear();
+        delete manager;
+    }
+
+    void poolWorker()
+    {
+        // Pool workers have an event dispatcher but never run its loop, the replies are completed on
+        // the I/O thread instead of waiting forever for it
+        libopenrazer::Led *led = this->led;
+        QFuture<bool> result = QtConcurrent::run([led]() {
+            for (int i = 0; i < 10; i++) {
+                led->setStaticAsync({ static_cast<uchar>(i % 2 ? 0xff : 0x00), 0x00, 0x00 }).waitForFinished();
+                led->getBrightnessAsync().waitForFinished();
+            }
+            return true;
+        });
+        // QTest's own timeout would only kill the whole test, fail with a message instead
+        QTRY_VERIFY_WITH_TIMEOUT(result.isFinished(), 10000);
+        QVERIFY(result.result());
+    }
+
+    void customThread()
+    {
+        QAtomicInt finished(0);
+        libopenrazer::Device *device = this->device.data();
+        QThread *thread = QThread::create([device, &finished]() {
+            device->displayCustomFrameAsync().waitForFinished();
+            finished.ref();
+        });
+        thread->start();
+        QTRY_VERIFY_WITH_TIMEOUT(finished.load() == 1, 10000);
+        thread->wait();
+        delete thread;
+    }
+
+    void eventLoop()
+    {
+        // Called from inside a running event loop, the reply is handed back to it
+        QEventLoop loop;
+        QFutureWatcher<uchar> watcher;
+        connect(&watcher, &QFutureWatcher<uchar>::finished, &loop, &QEventLoop::quit);
+        QTimer::singleShot(0, [this, &watcher]() {
+            watcher.setFuture(led->getBrightnessAsync());
+        });
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+        QVERIFY(watcher.isFinished());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestIoThread)
+
+#include "tst_iothread.moc"
@@ -0,0 +1,152 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ledstatecache_p.h"
+
+#include <QtTest>
+
+using namespace libopenrazer;
+
+// Write suppression, counters, expiry and the opt-out of the LED state cache shared by both backends.
+class TestLedStateCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    static LedStateCache::EffectWrite staticWrite(uchar red)
+    {
+        return LedStateCache::effectWrite(::openrazer::Effect::Static, { { red, 0x00, 0x00 } });
+    }
+
+    // Runs a write through the cache like the Led setters do, returns false if it was skipped
+    static bool write(LedStateCache *cache, const LedStateCache::EffectWrite &effectWrite)
+    {
+        quint64 generation;
+        if (!cache->beginWrite(effectWrite, &generation))
+            return false;
+        cache->written(effectWrite, generation);
+        return true;
+    }
+
+private slots:
+    void suppressesRepeatedWrites()
+    {
+        LedStateCache cache;
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QVERIFY(!write(&cache, staticWrite(0xff)));
+        QVERIFY(!write(&cache, staticWrite(0xff)));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(2));
+
+        // A different color or effect reaches the daemon
+        QVERIFY(write(&cache, staticWrite(0x80)));
+        QVERIFY(write(&cache, LedStateCache::effectWrite(::openrazer::Effect::Spectrum)));
+        QVERIFY(!write(&cache, LedStateCache::effectWrite(::openrazer::Effect::Spectrum)));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(3));
+
+        ::openrazer::Effect effect;
+        QVERIFY(cache.effect(&effect));
+        QVERIFY(effect == ::openrazer::Effect::Spectrum);
+    }
+
+    void suppressesRepeatedBrightness()
+    {
+        LedStateCache cache;
+        quint64 generation;
+        QVERIFY(cache.beginWrite(static_cast<uchar>(100), &generation));
+        cache.written(static_cast<uchar>(100), generation);
+        QVERIFY(!cache.beginWrite(static_cast<uchar>(100), &generation));
+        QVERIFY(cache.beginWrite(static_cast<uchar>(50), &generation));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(1));
+    }
+
+    void failedWriteIsNotSuppressed()
+    {
+        LedStateCache cache;
+        quint64 generation;
+        QVERIFY(cache.beginWrite(staticWrite(0xff), &generation));
+        // No written(), the call has failed
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(0));
+    }
+
+    void invalidatedWriteIsNotSuppressed()
+    {
+        // Custom frames change the LED without the cache knowing the new effect
+        LedStateCache cache;
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        cache.invalidateEffect();
+        QVERIFY(write(&cache, staticWrite(0xff)));
+
+        // Replies to calls sent before the change are outdated
+        quint64 generation = cache.generation();
+        cache.invalidateEffect();
+        cache.storeEffect(::openrazer::Effect::Static, generation);
+        ::openrazer::Effect effect;
+        QVERIFY(!cache.effect(&effect));
+    }
+
+    void expires()
+    {
+        LedStateCache cache;
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        cache.setLifetime(0);
+
+        ::openrazer::Effect effect;
+        QVERIFY(!cache.effect(&effect));
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(0));
+
+        cache.setLifetime(LedStateCache::Lifetime);
+        QVERIFY(cache.effect(&effect));
+        QVERIFY(!write(&cache, staticWrite(0xff)));
+    }
+
+    void disabled()
+    {
+        LedStateCache cache;
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        cache.setEnabled(false);
+        QVERIFY(!cache.isEnabled());
+
+        ::openrazer::Effect effect;
+        QVERIFY(!cache.effect(&effect));
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QCOMPARE(cache.suppressedWrites(), static_cast<quint64>(0));
+
+        // Nothing stored while disabled is used afterwards
+        cache.setEnabled(true);
+        QVERIFY(!cache.effect(&effect));
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QVERIFY(!write(&cache, staticWrite(0xff)));
+    }
+
+    void colorsOfWrites()
+    {
+        LedStateCache cache;
+        QVector<::openrazer::RGB> colors;
+
+        // The daemon reports three colors, a static write only knows the first one
+        QVERIFY(write(&cache, staticWrite(0xff)));
+        QVERIFY(!cache.colors(&colors));
+
+        // Fetched on demand and cached from then on
+        const QVector<::openrazer::RGB> reported { { 0xff, 0x00, 0x00 }, { 0x12, 0x34, 0x56 }, { 0x00, 0x00, 0x00 } };
+        cache.storeColors(reported, cache.generation());
+        QVERIFY(cache.colors(&colors));
+        QVERIFY(colors == reported);
+        // The reported colors match the write, so repeating it is still skipped
+        QVERIFY(!write(&cache, staticWrite(0xff)));
+
+        // An effect using all colors fills the cache itself
+        const QVector<::openrazer::RGB> all { { 0x01, 0x02, 0x03 }, { 0x04, 0x05, 0x06 }, { 0x07, 0x08, 0x09 } };
+        QVERIFY(write(&cache, LedStateCache::effectWrite(::openrazer::Effect::Static, all)));
+        QVERIFY(cache.colors(&colors));
+        QVERIFY(colors == all);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestLedStateCache)
+
+#include "tst_ledstatecache.moc"
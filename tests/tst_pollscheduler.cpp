@@ -0,0 +1,140 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QUuid>
+#include <QtTest>
+
+// Battery polling of the PollScheduler, with intervals of milliseconds instead of seconds.
+class TestPollScheduler : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+    libopenrazer::Manager *manager = nullptr;
+
+    QSharedPointer<libopenrazer::Device> getDevice(const QString &serial)
+    {
+        return manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/") + serial));
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        // A version the introspection cache hasn't seen, the batteries are part of the introspection data
+        daemon.setVersion(QUuid::createUuid().toString());
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+        daemon.addDevice(QStringLiteral("FAKE0001"));
+        daemon.addDevice(QStringLiteral("FAKE0002"));
+        manager = new libopenrazer::openrazer::Manager();
+    }
+
+    void cleanupTestCase()
+    {
+        delete manager;
+    }
+
+    void init()
+    {
+        daemon.setBattery(QStringLiteral("FAKE0000"), 80, false);
+        daemon.setBattery(QStringLiteral("FAKE0001"), 60, false);
+        daemon.resetCalls();
+    }
+
+    void batching()
+    {
+        QSharedPointer<libopenrazer::Device> first = getDevice(QStringLiteral("FAKE0000"));
+        QSharedPointer<libopenrazer::Device> second = getDevice(QStringLiteral("FAKE0001"));
+        QSharedPointer<libopenrazer::Device> noBattery = getDevice(QStringLiteral("FAKE0002"));
+        daemon.resetCalls();
+
+        libopenrazer::PollScheduler scheduler;
+        scheduler.setIntervals(60000, 60000);
+        scheduler.setBatchWindow(120000);
+        int percentChanges = 0;
+        connect(&scheduler, &libopenrazer::PollScheduler::batteryPercentChanged, this, [&percentChanges]() { percentChanges++; });
+
+        scheduler.addDevice(noBattery.data());
+        QCOMPARE(scheduler.interval(noBattery.data()), 0);
+
+        scheduler.addDevice(first.data());
+        QTRY_COMPARE(percentChanges, 1);
+        QCOMPARE(daemon.calls(QStringLiteral("getBattery")), 1);
+
+        // The first device is due within the batch window, so it's polled together with the new one
+        scheduler.addDevice(second.data());
+        QTRY_COMPARE(percentChanges, 2);
+        QTest::qWait(200);
+        QCOMPARE(daemon.calls(QStringLiteral("getBattery")), 3);
+        QCOMPARE(daemon.calls(QStringLiteral("isCharging")), 3);
+        // The threshold is only read with the first poll of a device
+        QCOMPARE(daemon.calls(QStringLiteral("getLowBatteryThreshold")), 2);
+    }
+
+    void intervals()
+    {
+        QSharedPointer<libopenrazer::Device> device = getDevice(QStringLiteral("FAKE0000"));
+        libopenrazer::Device *polled = device.data();
+
+        libopenrazer::PollScheduler scheduler;
+        scheduler.setIntervals(200, 1600);
+        scheduler.setBatchWindow(0);
+        QList<double> percents;
+        QList<bool> charging;
+        connect(&scheduler, &libopenrazer::PollScheduler::batteryPercentChanged, this, [&percents](libopenrazer::Device *, double percent) { percents.append(percent); });
+        connect(&scheduler, &libopenrazer::PollScheduler::chargingChanged, this, [&charging](libopenrazer::Device *, bool value) { charging.append(value); });
+
+        // The first poll reports both values
+        scheduler.addDevice(polled);
+        QTRY_COMPARE(percents.size(), 1);
+        QCOMPARE(percents.first(), 80.0);
+        QCOMPARE(charging, QList<bool> { false });
+        QCOMPARE(scheduler.interval(polled), 200);
+
+        // Unchanged values double the interval up to the maximum
+        QTRY_COMPARE_WITH_TIMEOUT(scheduler.interval(polled), 400, 10000);
+        QTRY_COMPARE_WITH_TIMEOUT(scheduler.interval(polled), 800, 10000);
+        QTRY_COMPARE_WITH_TIMEOUT(scheduler.interval(polled), 1600, 10000);
+        QCOMPARE(percents.size(), 1);
+        QCOMPARE(charging.size(), 1);
+
+        // A changed value halves it
+        daemon.setBattery(QStringLiteral("FAKE0000"), 70, false);
+        QTRY_COMPARE_WITH_TIMEOUT(percents.size(), 2, 10000);
+        QCOMPARE(percents.last(), 70.0);
+        QCOMPARE(scheduler.interval(polled), 800);
+        QCOMPARE(charging.size(), 1);
+
+        // While charging the minimum is used
+        daemon.setBattery(QStringLiteral("FAKE0000"), 70, true);
+        QTRY_COMPARE_WITH_TIMEOUT(charging.size(), 2, 10000);
+        QCOMPARE(charging.last(), true);
+        QCOMPARE(scheduler.interval(polled), 200);
+        QCOMPARE(percents.size(), 2);
+        int calls = daemon.calls(QStringLiteral("getBattery"));
+        QTRY_VERIFY_WITH_TIMEOUT(daemon.calls(QStringLiteral("getBattery")) > calls, 10000);
+        QCOMPARE(scheduler.interval(polled), 200);
+
+        // Also close to the low battery threshold of 20 %
+        daemon.setBattery(QStringLiteral("FAKE0000"), 24, false);
+        QTRY_COMPARE_WITH_TIMEOUT(charging.size(), 3, 10000);
+        QCOMPARE(percents.last(), 24.0);
+        QCOMPARE(scheduler.interval(polled), 200);
+        calls = daemon.calls(QStringLiteral("getBattery"));
+        QTRY_VERIFY_WITH_TIMEOUT(daemon.calls(QStringLiteral("getBattery")) > calls, 10000);
+        QCOMPARE(scheduler.interval(polled), 200);
+        QCOMPARE(percents.size(), 3);
+        QCOMPARE(charging.size(), 3);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPollScheduler)
+
+#include "tst_pollscheduler.moc"
@@ -0,0 +1,155 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakerazertest.h"
+#include "libopenrazer.h"
+
+#include <QtTest>
+
+using ::openrazer::Effect;
+
+// Device setup and the property cache of the razer_test backend.
+class TestRazerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeRazerTest daemon;
+
+    QSharedPointer<libopenrazer::Device> getDevice(libopenrazer::razer_test::Manager *manager)
+    {
+        return manager->getDevice(FakeRazerTest::devicePath(QStringLiteral("FAKE0000")));
+    }
+
+private slots:
+    void initTestCase()
+    {
+        FakeRazerTest::useSessionBusAsSystemBus();
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+    }
+
+    void init()
+    {
+        daemon.setMissingDeviceProperties(QStringList());
+        daemon.changeEffect(QStringLiteral("FAKE0000"), Effect::Static, { { 0xff, 0x00, 0x00 } });
+        daemon.resetCalls();
+    }
+
+    void roundTrips()
+    {
+        libopenrazer::razer_test::Manager manager;
+        QSharedPointer<libopenrazer::Device> device = getDevice(&manager);
+        QVERIFY(device);
+        QCOMPARE(device->getLeds().size(), 1);
+        QVERIFY(device->getLeds().first()->getCurrentEffect() == Effect::Static);
+
+        // One GetAll for the device and one for its LED, the effect comes from the LED properties.
+        // The only Get is the device list the Manager requests on construction.
+        QCOMPARE(daemon.calls(QStringLiteral("GetAll")), 2);
+        QCOMPARE(daemon.calls(QStringLiteral("Get")), 1);
+        QCOMPARE(daemon.totalCalls(), 3);
+    }
+
+    void missingLeds()
+    {
+        daemon.setMissingDeviceProperties({ QStringLiteral("Leds") });
+
+        libopenrazer::razer_test::Manager manager;
+        QVERIFY_EXCEPTION_THROWN(getDevice(&manager), libopenrazer::DBusException);
+        // The LEDs of a device that failed to set up aren't requested
+        QCOMPARE(daemon.calls(QStringLiteral("GetAll")), 1);
+    }
+
+    void propertiesChanged()
+    {
+        libopenrazer::razer_test::Manager manager;
+        QSharedPointer<libopenrazer::Device> device = getDevice(&manager);
+        QVERIFY(device);
+        libopenrazer::Led *led = device->getLeds().first();
+        QVERIFY(led->getCurrentEffect() == Effect::Static);
+
+        int effectChanges = 0;
+        connect(led, &libopenrazer::Led::currentEffectChanged, this, [&effectChanges](Effect) {
+            effectChanges++;
+        });
+        daemon.resetCalls();
+        daemon.changeEffect(QStringLiteral("FAKE0000"), Effect::Spectrum, {});
+        QTRY_COMPARE(effectChanges, 1);
+
+        // Served from the values of the signal
+        QVERIFY(led->getCurrentEffect() == Effect::Spectrum);
+        QVERIFY(led->getCurrentColors().isEmpty());
+        QCOMPARE(daemon.totalCalls(), 0);
+    }
+
+    void outdatedProperties()
+    {
+        daemon.holdLedProperties(true);
+
+        libopenrazer::razer_test::Manager manager;
+        QSharedPointer<libopenrazer::Device> device = getDevice(&manager);
+        QVERIFY(device);
+        libopenrazer::Led *led = device->getLeds().first();
+        int effectChanges = 0;
+        connect(led, &libopenrazer::Led::currentEffectChanged, this, [&effectChanges](Effect) {
+            effectChanges++;
+        });
+
+        // The held reply still has the static effect once the change is reported
+        QTRY_COMPARE(daemon.calls(QStringLiteral("GetAll")), 2);
+        daemon.changeEffect(QStringLiteral("FAKE0000"), Effect::Spectrum, {});
+        QTRY_COMPARE(effectChanges, 1);
+        QVERIFY(led->getCurrentEffect() == Effect::Spectrum);
+
+        daemon.holdLedProperties(false);
+        daemon.releaseReplies();
+        // Replies arrive in order, so the held one is handled once the version is there
+        QCOMPARE(manager.getDaemonVersion(), QStringLiteral("1.0.0"));
+        QCoreApplication::processEvents();
+
+        QVERIFY(led->getCurrentEffect() == Effect::Spectrum);
+        QCOMPARE(daemon.calls(QStringLiteral("GetAll")), 2);
+    }
+
+    void addAndRemove()
+    {
+        libopenrazer::razer_test::Manager manager;
+        QList<QSharedPointer<libopenrazer::Device>> added;
+        QList<QDBusObjectPath> removed;
+        connect(&manager, &libopenrazer::Manager::deviceAdded, this, [&added](QSharedPointer<libopenrazer::Device> device) { added.append(device); });
+        connect(&manager, &libopenrazer::Manager::deviceRemoved, this, [&removed](const QDBusObjectPath &objectPath) { removed.append(objectPath); });
+
+        QSharedPointer<libopenrazer::Device> connected = getDevice(&manager);
+        QVERIFY(connected);
+        // The initial device list doesn't report the devices that were already there
+        QTRY_COMPARE(daemon.calls(QStringLiteral("Get")), 1);
+        daemon.resetCalls();
+
+        daemon.addDevice(QStringLiteral("FAKE0001"));
+        QTRY_COMPARE(added.size(), 1);
+        QTest::qWait(100);
+        QCOMPARE(added.size(), 1);
+        QCOMPARE(removed.size(), 0);
+        QCOMPARE(added.first()->objectPath().path(), FakeRazerTest::devicePath(QStringLiteral("FAKE0001")).path());
+        // Only the properties of the new device and its LED are requested
+        QCOMPARE(daemon.calls(QStringLiteral("GetAll")), 2);
+        QVERIFY(getDevice(&manager) == connected);
+
+        daemon.removeDevice(QStringLiteral("FAKE0001"));
+        QTRY_COMPARE(removed.size(), 1);
+        QTest::qWait(100);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(added.size(), 1);
+        QCOMPARE(removed.first().path(), FakeRazerTest::devicePath(QStringLiteral("FAKE0001")).path());
+        // The daemon doesn't know the removed device anymore, so it isn't handed out again
+        QVERIFY_EXCEPTION_THROWN(manager.getDevice(FakeRazerTest::devicePath(QStringLiteral("FAKE0001"))), libopenrazer::DBusException);
+        QVERIFY(getDevice(&manager) == connected);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRazerTest)
+
+#include "tst_razertest.moc"
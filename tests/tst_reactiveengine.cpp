@@ -0,0 +1,121 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QtTest>
+
+// KEY_Q, KEY_W, KEY_A, KEY_S and KEY_Z from linux/input-event-codes.h
+static const ushort KeyQ = 16;
+static const ushort KeyW = 17;
+static const ushort KeyA = 30;
+static const ushort KeyS = 31;
+static const ushort KeyZ = 44;
+
+// Two rows of three cells, the last cell doesn't have a key
+static const ushort keyCodes[] = {
+    KeyQ, KeyW, 0,
+    KeyA, KeyS, 0,
+};
+
+// Key presses from a FakeKeyEventSource lighting up the custom frame of the fake daemon.
+class TestReactiveEngine : public QObject
+{
+    Q_OBJECT
+
+private:
+    FakeOpenRazer daemon;
+    libopenrazer::openrazer::Manager *manager = nullptr;
+    QSharedPointer<libopenrazer::Device> device;
+    libopenrazer::DeviceGeometry geometry {};
+
+    static QByteArray colors(std::initializer_list<::openrazer::RGB> pixels)
+    {
+        QByteArray data;
+        for (const ::openrazer::RGB &pixel : pixels) {
+            data.append(static_cast<char>(pixel.r));
+            data.append(static_cast<char>(pixel.g));
+            data.append(static_cast<char>(pixel.b));
+        }
+        return data;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+
+        manager = new libopenrazer::openrazer::Manager;
+        device = manager->getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000")));
+        QVERIFY(device);
+
+        geometry.dimensions = { 2, 3 };
+        geometry.keyCodes = keyCodes;
+    }
+
+    void cleanupTestCase()
+    {
+        device.clear();
+        delete manager;
+    }
+
+    void pressAndFade()
+    {
+        const ::openrazer::RGB color { 0x00, 0xff, 0x00 };
+        const ::openrazer::RGB background { 0x00, 0x00, 0x10 };
+        libopenrazer::FakeKeyEventSource source;
+        libopenrazer::ReactiveEngine engine(device.data(), &geometry, &source);
+        engine.setColors(color, background);
+        engine.setFadeDuration(100);
+
+        // Starting shows the background
+        engine.start();
+        QCOMPARE(daemon.keyRow(QStringLiteral("FAKE0000"), 0), colors({ background, background, background }));
+        QCOMPARE(daemon.keyRow(QStringLiteral("FAKE0000"), 1), colors({ background, background, background }));
+        QVERIFY(!libopenrazer::TickScheduler::instance()->isActive());
+
+        // The press is sent right away, only the row of the key is sent again
+        daemon.resetCalls();
+        source.press(KeyS);
+        QCOMPARE(daemon.calls(QStringLiteral("setKeyRow")), 1);
+        QCOMPARE(daemon.keyRow(QStringLiteral("FAKE0000"), 1), colors({ background, color, background }));
+        QCOMPARE(engine.latency().count(), static_cast<quint64>(1));
+        QVERIFY(libopenrazer::TickScheduler::instance()->isActive());
+
+        // Back to the background once faded out, then the scheduler isn't needed anymore
+        QTRY_VERIFY(!libopenrazer::TickScheduler::instance()->isActive());
+        QCOMPARE(daemon.keyRow(QStringLiteral("FAKE0000"), 1), colors({ background, background, background }));
+        QCOMPARE(daemon.keyRow(QStringLiteral("FAKE0000"), 0), colors({ background, background, background }));
+
+        // Keys that aren't part of the layout are ignored
+        daemon.resetCalls();
+        source.press(KeyZ);
+        QCOMPARE(daemon.totalCalls(), 0);
+        QVERIFY(!libopenrazer::TickScheduler::instance()->isActive());
+    }
+
+    void stop()
+    {
+        libopenrazer::FakeKeyEventSource source;
+        libopenrazer::ReactiveEngine engine(device.data(), &geometry, &source);
+        engine.start();
+        source.press(KeyQ);
+        QVERIFY(libopenrazer::TickScheduler::instance()->isActive());
+
+        // Stopping ends the fading and the reaction to further presses
+        engine.stop();
+        QVERIFY(!libopenrazer::TickScheduler::instance()->isActive());
+        daemon.resetCalls();
+        source.press(KeyW);
+        QCOMPARE(daemon.totalCalls(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestReactiveEngine)
+
+#include "tst_reactiveengine.moc"
@@ -0,0 +1,130 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QUuid>
+#include <QtTest>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// Round trips and memory it takes to set up the devices of the openrazer backend.
+class TestStartup : public QObject
+{
+    Q_OBJECT
+
+private:
+    static const int DeviceCount = 4;
+    FakeOpenRazer daemon;
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        for (int i = 0; i < DeviceCount; i++)
+            daemon.addDevice(QStringLiteral("FAKE%1").arg(i, 4, 10, QLatin1Char('0')));
+    }
+
+    void roundTrips()
+    {
+        // A version the introspection cache hasn't seen, so every device is introspected
+        daemon.setVersion(QUuid::createUuid().toString());
+        daemon.resetCalls();
+
+        libopenrazer::openrazer::Manager manager;
+        const QList<QSharedPointer<libopenrazer::Device>> devices = manager.getAllDevices();
+        QCOMPARE(devices.size(), DeviceCount);
+
+        // One Introspect per device. QDBusInterface introspected every interface of a device and
+        // of its LEDs on its own.
+        QCOMPARE(daemon.calls(QStringLiteral("Introspect")), DeviceCount);
+        qInfo("%d calls for %d devices", daemon.totalCalls(), DeviceCount);
+        QTest::setBenchmarkResult(daemon.totalCalls(), QTest::Events);
+    }
+
+    void warmCache()
+    {
+        // Same daemon version as roundTrips(), so every device is set up from the introspection cache
+        daemon.resetCalls();
+
+        libopenrazer::openrazer::Manager manager;
+        QCOMPARE(manager.getAllDevices().size(), DeviceCount);
+        for (int i = 0; i < DeviceCount; i++)
+            QVERIFY(manager.getDevice(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE%1").arg(i, 4, 10, QLatin1Char('0')))));
+
+        // Set up without waiting for an introspection, the daemon version is only asked once per daemon lifetime
+        QCOMPARE(daemon.calls(QStringLiteral("Introspect")), 0);
+        QCOMPARE(daemon.calls(QStringLiteral("version")), 1);
+
+        // The cached data is checked in the background and still matches
+        int removed = 0;
+        connect(&manager, &libopenrazer::Manager::deviceRemoved, this, [&removed]() { removed++; });
+        QTRY_COMPARE(daemon.calls(QStringLiteral("Introspect")), DeviceCount);
+        QTest::qWait(100);
+        QCOMPARE(removed, 0);
+    }
+
+    void staleCache()
+    {
+        // Same daemon version, but the device has gained an LED (e.g. through a firmware update)
+        daemon.setExtraInterfaces(QStringLiteral("  <interface name=\"razer.device.lighting.logo\">\n"
+                                                 "    <method name=\"setLogoStatic\"/>\n"
+                                                 "  </interface>\n"));
+        daemon.resetCalls();
+
+        libopenrazer::openrazer::Manager manager;
+        const QDBusObjectPath objectPath(QStringLiteral("/org/razer/device/FAKE0000"));
+        QList<QDBusObjectPath> removed;
+        int added = 0;
+        connect(&manager, &libopenrazer::Manager::deviceRemoved, this, [&removed](const QDBusObjectPath &objectPath) { removed.append(objectPath); });
+        connect(&manager, &libopenrazer::Manager::deviceAdded, this, [&added]() { added++; });
+        QSharedPointer<libopenrazer::Device> cached = manager.getDevice(objectPath);
+        QCOMPARE(cached->getLeds().size(), 1);
+
+        // The stale device is replaced once the background introspection has arrived
+        QTRY_COMPARE(added, 1);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(removed.first().path(), objectPath.path());
+        QSharedPointer<libopenrazer::Device> device = manager.getDevice(objectPath);
+        QVERIFY(device != cached);
+        QCOMPARE(device->getLeds().size(), 2);
+        QCOMPARE(daemon.calls(QStringLiteral("Introspect")), 1);
+
+        // The cache has been updated, a new Manager gets the new LED right away
+        daemon.resetCalls();
+        libopenrazer::openrazer::Manager second;
+        QCOMPARE(second.getDevice(objectPath)->getLeds().size(), 2);
+        QCOMPARE(daemon.calls(QStringLiteral("Introspect")), 0);
+        daemon.setExtraInterfaces(QString());
+    }
+
+    void memoryPerDevice()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        // The first device also sets up the connection, don't count that
+        delete new libopenrazer::openrazer::Device(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000")));
+
+        const size_t before = mallinfo2().uordblks;
+        QList<libopenrazer::Device *> devices;
+        for (int i = 0; i < DeviceCount; i++)
+            devices.append(new libopenrazer::openrazer::Device(QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE%1").arg(i, 4, 10, QLatin1Char('0')))));
+        const size_t after = mallinfo2().uordblks;
+        qDeleteAll(devices);
+
+        qInfo("%zu bytes per device", (after - before) / DeviceCount);
+        QTest::setBenchmarkResult(static_cast<qreal>(after - before) / DeviceCount, QTest::BytesAllocated);
+#else
+        QSKIP("Needs mallinfo2() of glibc");
+#endif
+    }
+};
+
+QTEST_GUILESS_MAIN(TestStartup)
+
+#include "tst_startup.moc"
@@ -0,0 +1,174 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "libopenrazer/systemmetrics.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+using libopenrazer::SystemMetrics;
+
+// Parses canned /proc files, written to a temporary directory between two samples.
+class TestSystemMetrics : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    // Rewrites the file in place, so the descriptor SystemMetrics keeps open reads the new content
+    void writeFile(const QString &name, const QByteArray &content)
+    {
+        QFile file(dir.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(content), static_cast<qint64>(content.size()));
+    }
+
+    static QByteArray diskLine(int major, int minor, const char *name, quint64 ioTicks)
+    {
+        // reads merged sectors ms writes merged sectors ms in-flight io-ms weighted-ms
+        return QStringLiteral("%1 %2 %3 100 0 800 50 100 0 800 50 0 %4 %4\n")
+                .arg(major, 4)
+                .arg(minor, 7)
+                .arg(QLatin1String(name))
+                .arg(ioTicks)
+                .toLatin1();
+    }
+
+    // A snap based system, with the loop devices listed before the real disks
+    void writeDiskStats(quint64 loopTicks, quint64 nvmeTicks, quint64 nvmePartitionTicks, quint64 sdaTicks, quint64 sdaPartitionTicks)
+    {
+        QByteArray content;
+        for (int i = 0; i < 40; i++)
+            content += diskLine(7, i, QStringLiteral("loop%1").arg(i).toLatin1().constData(), loopTicks);
+        for (int i = 0; i < 16; i++)
+            content += diskLine(1, i, QStringLiteral("ram%1").arg(i).toLatin1().constData(), loopTicks);
+        content += diskLine(259, 0, "nvme0n1", nvmeTicks);
+        content += diskLine(259, 1, "nvme0n1p1", nvmePartitionTicks);
+        content += diskLine(259, 2, "nvme0n1p2", 0);
+        content += diskLine(8, 0, "sda", sdaTicks);
+        content += diskLine(8, 1, "sda1", sdaPartitionTicks);
+        content += diskLine(252, 0, "zram0", loopTicks);
+        writeFile(QStringLiteral("diskstats"), content);
+    }
+
+    void writeNetDev(quint64 ethBytes, quint64 loBytes)
+    {
+        QByteArray content("Inter-|   Receive                                                |  Transmit\n"
+                           " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n");
+        content += QStringLiteral("    lo: %1 0 0 0 0 0 0 0 %1 0 0 0 0 0 0 0\n").arg(loBytes).toLatin1();
+        content += QStringLiteral("  eth0: %1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n").arg(ethBytes).toLatin1();
+        writeFile(QStringLiteral("net/dev"), content);
+    }
+
+    void writeStat(quint64 busy, quint64 idle)
+    {
+        writeFile(QStringLiteral("stat"), QStringLiteral("cpu  %1 0 0 %2 0 0 0 0 0 0\n"
+                                                         "cpu0 %1 0 0 %2 0 0 0 0 0 0\n"
+                                                         "intr 0\n")
+                                                  .arg(busy)
+                                                  .arg(idle)
+                                                  .toLatin1());
+    }
+
+    // Writes the files with no activity at all
+    void writeIdle()
+    {
+        writeStat(100, 100);
+        writeFile(QStringLiteral("meminfo"), "MemTotal:        1000 kB\nMemFree:          100 kB\nMemAvailable:     250 kB\n");
+        writeDiskStats(0, 0, 0, 0, 0);
+        writeNetDev(0, 0);
+    }
+
+    // Loads are relative to the time since the previous sample, which has to be at least a millisecond
+    static bool sampleLater(SystemMetrics *metrics)
+    {
+        QTest::qSleep(10);
+        return metrics->sample();
+    }
+
+private slots:
+    void initTestCase()
+    {
+#ifndef Q_OS_LINUX
+        QSKIP("Only available on Linux");
+#endif
+        QVERIFY(dir.isValid());
+        QVERIFY(QDir(dir.path()).mkdir(QStringLiteral("net")));
+    }
+
+    void init()
+    {
+        writeIdle();
+    }
+
+    void cpuAndMemory()
+    {
+        SystemMetrics metrics(QFile::encodeName(dir.path()).constData());
+        QVERIFY(metrics.sample());
+        QCOMPARE(metrics.coreCount(), 1);
+
+        // Half of the time since the last sample was busy
+        writeStat(300, 300);
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.coreLoad(0), static_cast<uchar>(127));
+        QCOMPARE(metrics.value(SystemMetrics::Cpu), static_cast<uchar>(127));
+        QCOMPARE(metrics.value(SystemMetrics::Memory), static_cast<uchar>(750 * 255 / 1000));
+    }
+
+    void diskBehindLoopDevices()
+    {
+        SystemMetrics metrics(QFile::encodeName(dir.path()).constData());
+        QVERIFY(metrics.sample());
+
+        // Far more busy time than has passed, the disk is fully busy
+        writeDiskStats(0, 100000000, 0, 0, 0);
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Disk), static_cast<uchar>(255));
+
+        writeDiskStats(0, 100000000, 0, 100000000, 0);
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Disk), static_cast<uchar>(255));
+    }
+
+    void diskIgnoresVirtualAndPartitions()
+    {
+        SystemMetrics metrics(QFile::encodeName(dir.path()).constData());
+        QVERIFY(metrics.sample());
+
+        writeDiskStats(100000000, 0, 0, 0, 0);
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Disk), static_cast<uchar>(0));
+
+        // Only the partitions have counters that changed
+        writeDiskStats(100000000, 0, 100000000, 0, 100000000);
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Disk), static_cast<uchar>(0));
+    }
+
+    void network()
+    {
+        SystemMetrics metrics(QFile::encodeName(dir.path()).constData());
+        QVERIFY(metrics.sample());
+
+        // Loopback traffic isn't network usage
+        writeNetDev(0, Q_UINT64_C(1000000000000));
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Network), static_cast<uchar>(0));
+
+        writeNetDev(Q_UINT64_C(1000000000000), Q_UINT64_C(1000000000000));
+        QVERIFY(sampleLater(&metrics));
+        QCOMPARE(metrics.value(SystemMetrics::Network), static_cast<uchar>(255));
+    }
+
+    void missingFiles()
+    {
+        SystemMetrics metrics(QFile::encodeName(dir.filePath(QStringLiteral("missing"))).constData());
+        QVERIFY(!metrics.sample());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestSystemMetrics)
+
+#include "tst_systemmetrics.moc"
@@ -0,0 +1,124 @@
+// Copyright (C) 2019  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fakeopenrazer.h"
+#include "libopenrazer.h"
+
+#include <QAtomicInt>
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+// Drives the same Manager, Device and Led from several threads at once, like the UI, a poller and
+// a render worker of an application would. Only finds data races in a build with
+// -Db_sanitize=thread, otherwise it just checks that nothing crashes or deadlocks.
+class TestThreads : public QObject
+{
+    Q_OBJECT
+
+private:
+    static const int ThreadCount = 4;
+    static const int Iterations = 200;
+    FakeOpenRazer daemon;
+
+    static QDBusObjectPath devicePath()
+    {
+        return QDBusObjectPath(QStringLiteral("/org/razer/device/FAKE0000"));
+    }
+
+    // Runs work on ThreadCount threads at the same time and returns the number of failed iterations.
+    // QTest macros aren't thread-safe, so work returns false instead.
+    template<typename Work>
+    static int runThreads(Work work)
+    {
+        QAtomicInt failures(0);
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int t = 0; t < ThreadCount; t++) {
+            threads.emplace_back(QThread::create([work, t, &failures]() {
+                for (int i = 0; i < Iterations; i++) {
+                    try {
+                        if (!work(t, i))
+                            failures.ref();
+                    } catch (const libopenrazer::DBusException &) {
+                        failures.ref();
+                    }
+                }
+            }));
+        }
+        for (const std::unique_ptr<QThread> &thread : threads)
+            thread->start();
+        for (const std::unique_ptr<QThread> &thread : threads)
+            thread->wait();
+        return failures.load();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        if (!daemon.start())
+            QSKIP("No session bus, run with dbus-run-session");
+        daemon.addDevice(QStringLiteral("FAKE0000"));
+        daemon.addDevice(QStringLiteral("FAKE0001"));
+    }
+
+    void sharedDevices()
+    {
+        libopenrazer::openrazer::Manager manager;
+        std::vector<libopenrazer::Device *> seen(ThreadCount * Iterations);
+        int failures = runThreads([&manager, &seen](int thread, int iteration) {
+            QSharedPointer<libopenrazer::Device> device = manager.getDevice(devicePath());
+            seen[thread * Iterations + iteration] = device.data();
+            if (iteration % 10 == 0)
+                manager.getAllDevices();
+            return !device.isNull();
+        });
+        QCOMPARE(failures, 0);
+
+        // Every thread has been handed the same device
+        for (libopenrazer::Device *device : seen)
+            QCOMPARE(device, seen.front());
+    }
+
+    void sharedDevice()
+    {
+        libopenrazer::openrazer::Manager manager;
+        QSharedPointer<libopenrazer::Device> device = manager.getDevice(devicePath());
+        QVERIFY(!device->getLeds().isEmpty());
+        libopenrazer::Led *led = device->getLeds().first();
+
+        int failures = runThreads([device, led](int thread, int iteration) {
+            switch (thread) {
+            case 0:
+                // UI: metadata and the current state
+                led->getCurrentEffect();
+                led->getCurrentColors();
+                return device->getDescriptor().serial == QLatin1String("FAKE0000");
+            case 1: {
+                // Poller: snapshots and statistics
+                device->snapshot();
+                libopenrazer::FrameStats copy = *device->frameStats();
+                return copy.frames().count() <= static_cast<quint64>(Iterations);
+            }
+            case 2:
+                // Effect writes, alternating so the state cache doesn't skip all of them
+                led->setStatic({ static_cast<uchar>(iteration % 2 ? 0xff : 0x00), 0x00, 0x00 });
+                led->setBrightness(static_cast<uchar>(iteration));
+                return true;
+            default:
+                // Render worker: custom frames
+                device->defineCustomFrame(0, 0, 1, { { 0xff, 0x00, 0x00 }, { 0x00, 0xff, 0x00 } });
+                device->displayCustomFrame();
+                return true;
+            }
+        });
+        QCOMPARE(failures, 0);
+        QCOMPARE(device->frameStats()->frames().count(), static_cast<quint64>(Iterations));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestThreads)
+
+#include "tst_threads.moc"